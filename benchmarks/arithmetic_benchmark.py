@@ -0,0 +1,30 @@
+# benchmarks/arithmetic_benchmark.py
+
+def combine(a, b):
+    return a * b + a - b * 2
+
+def warm_up():
+    for i in range(32):
+        combine(i, 2)
+        combine(1.5, 2.5)
+
+def main():
+    warm_up()
+
+    # Test 1: Small integers through the generic kernels
+    print("Starting small integer benchmark...")
+    total = 0
+    for i in range(2000000):
+        total = total + combine(i, 7)
+    print(f"total = {total}")
+
+    # Test 2: Integers beyond the small-integer range take the boxed path
+    print("Starting wide integer benchmark...")
+    wide = 0
+    base = 2000000000000000000
+    for j in range(200000):
+        wide = wide + combine(base, 1) - base - base
+    print(f"wide = {wide}")
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,32 @@
+# benchmarks/call_benchmark.py
+
+def fib(n):
+    if n < 2:
+        return n
+    return fib(n - 1) + fib(n - 2)
+
+def is_even(n):
+    if n == 0:
+        return True
+    return is_odd(n - 1)
+
+def is_odd(n):
+    if n == 0:
+        return False
+    return is_even(n - 1)
+
+def main():
+    # Test 1: Recursive fibonacci
+    print("Starting recursive fib benchmark...")
+    print(f"fib(27) = {fib(27)}")
+
+    # Test 2: Mutual recursion
+    print("Starting mutual recursion benchmark...")
+    even_count = 0
+    for i in range(4000):
+        if is_even(500):
+            even_count += 1
+    print(f"isEven(500) held {even_count} times")
+
+if __name__ == "__main__":
+    main()
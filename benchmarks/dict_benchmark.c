@@ -0,0 +1,77 @@
+// benchmarks/dict_benchmark.c
+// Insertion, lookup hits and misses, and iteration of runtime dicts with
+// integer keys, at 1e3, 1e5 and 1e7 entries. Smaller tables are rebuilt
+// until each measurement covers at least 1e7 operations.
+//
+// Build and run from the repository root:
+//   cc -O2 -std=gnu99 -Isrc/runtime benchmarks/dict_benchmark.c src/runtime/*.c -lpthread -o dict_benchmark
+//   ./dict_benchmark
+
+#include "runtime_dict.h"
+#include "runtime_value.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define MIN_OPERATIONS 10000000ULL
+
+static double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static void report(const char* name, uint64_t entries, uint64_t operations, double seconds) {
+    printf("%-10s %10llu entries  %8.2f ns/op\n", name, (unsigned long long)entries,
+           seconds * 1e9 / (double)operations);
+}
+
+// Keys are spread out so that they are not simply consecutive small integers
+static LmValue key_of(uint64_t i) {
+    return make_i64((int64_t)(i * 7919));
+}
+
+static void run(uint64_t entries) {
+    uint64_t rounds = (MIN_OPERATIONS + entries - 1) / entries;
+    uint64_t operations = rounds * entries;
+    LmDict** dicts = (LmDict**)malloc(rounds * sizeof(LmDict*));
+    uint64_t checksum = 0;
+
+    double start = now();
+    for (uint64_t r = 0; r < rounds; r++) {
+        dicts[r] = lm_dict_new(hash_boxed_value, cmp_boxed_value);
+        for (uint64_t i = 0; i < entries; i++) lm_dict_set(dicts[r], key_of(i), make_i64((int64_t)i));
+    }
+    report("insert", entries, operations, now() - start);
+
+    start = now();
+    for (uint64_t r = 0; r < rounds; r++) {
+        for (uint64_t i = 0; i < entries; i++) checksum += lm_dict_get(dicts[r], key_of(i));
+    }
+    report("hit", entries, operations, now() - start);
+
+    start = now();
+    for (uint64_t r = 0; r < rounds; r++) {
+        for (uint64_t i = entries; i < 2 * entries; i++) checksum += lm_dict_contains(dicts[r], key_of(i));
+    }
+    report("miss", entries, operations, now() - start);
+
+    start = now();
+    for (uint64_t r = 0; r < rounds; r++) {
+        LmDictIter it = lm_dict_iter_begin(dicts[r]);
+        LmValue value;
+        while (lm_dict_iter_next(dicts[r], &it, NULL, &value) == LM_ITER_ITEM) checksum += value;
+    }
+    report("iterate", entries, operations, now() - start);
+
+    for (uint64_t r = 0; r < rounds; r++) lm_dict_free(dicts[r]);
+    free(dicts);
+    printf("checksum %llu\n\n", (unsigned long long)checksum);
+}
+
+int main(void) {
+    run(1000);
+    run(100000);
+    run(10000000);
+    return 0;
+}
@@ -0,0 +1,29 @@
+# benchmarks/dynamic_benchmark.py
+
+def fib(n):
+    if n < 2:
+        return n
+    return fib(n - 1) + fib(n - 2)
+
+def accumulate(total, value):
+    return total + value
+
+def element(values, i):
+    return values[i]
+
+def main():
+    # Test 1: Recursive fibonacci on an untyped parameter
+    print("Starting untyped fib benchmark...")
+    print(f"fib(30) = {fib(30)}")
+
+    # Test 2: Summing list elements through an untyped accumulator
+    print("Starting untyped list sum benchmark...")
+    values = list(range(10))
+    total = 0
+    for _ in range(300000):
+        for i in range(10):
+            total = accumulate(total, element(values, i))
+    print(f"sum = {total}")
+
+if __name__ == "__main__":
+    main()
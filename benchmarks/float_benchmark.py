@@ -0,0 +1,27 @@
+# benchmarks/float_benchmark.py
+
+def main():
+    # Test 1: Leibniz series for pi
+    print("Starting Leibniz series benchmark...")
+    pi = 0.0
+    sign = 1.0
+    denominator = 1.0
+    for i in range(2000000):
+        pi = pi + sign * 4.0 / denominator
+        sign = 0.0 - sign
+        denominator = denominator + 2.0
+    print(f"pi ~ {pi}")
+
+    # Test 2: Midpoint rule for the integral of x*x over [0, 1]
+    print("Starting integration benchmark...")
+    steps = 1000000.0
+    width = 1.0 / steps
+    x = width / 2.0
+    area = 0.0
+    for j in range(1000000):
+        area = area + x * x * width
+        x = x + width
+    print(f"integral ~ {area}")
+
+if __name__ == "__main__":
+    main()
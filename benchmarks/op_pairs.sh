@@ -0,0 +1,49 @@
+#!/bin/bash
+# benchmarks/op_pairs.sh
+# Measure which pairs of VM opcodes execute back to back. Superinstructions
+# are chosen from this table.
+#
+# Usage: benchmarks/op_pairs.sh [-n TOP] [source_file ...]
+#
+# Each program contributes its share of executed pairs, so a long-running
+# benchmark does not drown out everything else. Without arguments the call,
+# dynamic and loop benchmarks (scaled down) and the test suite are measured.
+set -euo pipefail
+
+LIMITLY="./bin/limitly"
+TOP=30
+
+if [[ "${1:-}" == "-n" ]]; then
+  TOP="$2"
+  shift 2
+fi
+
+FILES=("$@")
+TMPDIR_PAIRS=$(mktemp -d)
+trap 'rm -rf "$TMPDIR_PAIRS"' EXIT
+
+if [[ ${#FILES[@]} -eq 0 ]]; then
+  # loop_benchmark runs 2e9 iterations; the opcode mix is the same at 2e6
+  sed 's/var count:int = 2000000000;/var count:int = 2000000;/' benchmarks/loop_benchmark.lm > "$TMPDIR_PAIRS/loop_benchmark.lm"
+  FILES=(benchmarks/call_benchmark.lm benchmarks/dynamic_benchmark.lm "$TMPDIR_PAIRS/loop_benchmark.lm")
+  while read -r test; do
+    FILES+=("$test")
+  done < <(grep -oE '^"tests/[^"]+\.lm"' tests/run_tests.sh | tr -d '"')
+fi
+
+for f in "${FILES[@]}"; do
+  "$LIMITLY" -op-pairs "$f" 2>&1 >/dev/null | grep -E $'^[0-9]+\t' || true
+  echo "--"
+done | awk -F'\t' -v top="$TOP" '
+  $0 == "--" {
+    for (p in counts) share[p] += counts[p] / total
+    if (total > 0) programs++
+    delete counts
+    total = 0
+    next
+  }
+  { counts[$2] += $1; total += $1 }
+  END {
+    if (programs == 0) exit 1
+    for (p in share) printf "%7.3f%%\t%s\n", 100 * share[p] / programs, p
+  }' | sort -t$'\t' -k1,1 -rn | head -n "$TOP"
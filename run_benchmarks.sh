@@ -18,5 +18,41 @@ echo "Running Python benchmark..."
 echo "----------------------------------------"
 python3 benchmarks/loop_benchmark.py
 
+echo ""
+echo "----------------------------------------"
+echo "Running Limit call benchmark..."
+echo "----------------------------------------"
+time ./bin/limitly benchmarks/call_benchmark.lm
+
+echo ""
+echo "----------------------------------------"
+echo "Running Python call benchmark..."
+echo "----------------------------------------"
+time python3 benchmarks/call_benchmark.py
+
+echo ""
+echo "----------------------------------------"
+echo "Running Limit dynamic benchmark..."
+echo "----------------------------------------"
+time ./bin/limitly benchmarks/dynamic_benchmark.lm
+
+echo ""
+echo "----------------------------------------"
+echo "Running Python dynamic benchmark..."
+echo "----------------------------------------"
+time python3 benchmarks/dynamic_benchmark.py
+
+echo ""
+echo "----------------------------------------"
+echo "Running Limit list loop benchmark..."
+echo "----------------------------------------"
+time ./bin/limitly benchmarks/list_loops_benchmark.lm
+
+echo ""
+echo "----------------------------------------"
+echo "Running Limit list kernel benchmark..."
+echo "----------------------------------------"
+time ./bin/limitly benchmarks/list_kernels_benchmark.lm
+
 echo ""
 echo "Benchmarks complete."
@@ -13,7 +13,8 @@ namespace Backend {
 
 // Modern Channel for Limitly concurrency
 struct Channel {
-    std::queue<RegisterValue> buffer;
+    ObjHeader header{TYPE_CHANNEL, 0};    // lets the GC tell channel values from runtime objects
+    std::deque<RegisterValue> buffer;     // sent values not yet received, scanned by the GC
     size_t capacity;
     bool closed = false;            // channel closed flag
     std::deque<Fiber*> waiting_senders;   // fibers waiting to send (blocking send)
@@ -27,7 +28,7 @@ struct Channel {
         if (closed) return false;
         if (buffer.size() >= capacity) return false;
         
-        buffer.push(value);
+        buffer.push_back(value);
 
         // Wake up one waiting receiver if exists (from blocking recv)
         if (!waiting_receivers.empty()) {
@@ -43,7 +44,7 @@ struct Channel {
         if (buffer.empty()) return false;
         
         out_value = buffer.front();
-        buffer.pop();
+        buffer.pop_front();
 
         // Wake up one waiting sender if exists (from blocking send)
         if (!waiting_senders.empty()) {
@@ -65,7 +66,7 @@ struct Channel {
         }
         
         if (!closed) {
-            buffer.push(value);
+            buffer.push_back(value);
 
             // Wake up one waiting receiver if exists
             if (!waiting_receivers.empty()) {
@@ -92,7 +93,7 @@ struct Channel {
         }
         
         RegisterValue val = buffer.front();
-        buffer.pop();
+        buffer.pop_front();
 
         // Wake up one waiting sender if exists
         if (!waiting_senders.empty()) {
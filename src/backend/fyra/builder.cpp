@@ -126,11 +126,16 @@ std::shared_ptr<ir::Module> LIRToFyraIRBuilder::build(const LIR::LIR_Function& l
                 if (name.empty() && inst.const_val) {
                     if (IS_PTR(inst.const_val)) {
                         ObjHeader* h = (ObjHeader*)UNBOX_PTR(inst.const_val);
-                        if (h->type_id == TYPE_BOX && ((LmBox*)h)->type == LM_BOX_STRING) {
-                            name = (char*)((LmBox*)h)->value.as_ptr;
+                        if (h->type_id == TYPE_STRING) {
+                            name.assign(((ObjString*)h)->data, ((ObjString*)h)->length);
                         }
                     }
                 }
+                if (name.rfind("list_", 0) == 0 && FyraBuiltinFunctions::is_builtin(name)) {
+                    // List kernels are runtime functions under their lm_ names
+                    name = FyraBuiltinFunctions::get_internal_name(name);
+                    used_builtins_.insert(name);
+                }
                 ir::Function* func = current_module_->getFunction(name);
                 if (!func) {
                     std::vector<ir::Type*> pts;
@@ -156,8 +161,8 @@ std::shared_ptr<ir::Module> LIRToFyraIRBuilder::build(const LIR::LIR_Function& l
                 if (name.empty() && inst.const_val) {
                     if (IS_PTR(inst.const_val)) {
                         ObjHeader* h = (ObjHeader*)UNBOX_PTR(inst.const_val);
-                        if (h->type_id == TYPE_BOX && ((LmBox*)h)->type == LM_BOX_STRING) {
-                            name = (char*)((LmBox*)h)->value.as_ptr;
+                        if (h->type_id == TYPE_STRING) {
+                            name.assign(((ObjString*)h)->data, ((ObjString*)h)->length);
                         }
                     }
                 }
@@ -209,9 +214,9 @@ std::shared_ptr<ir::Module> LIRToFyraIRBuilder::build(const LIR::LIR_Function& l
             }
             case LIR::LIR_Op::Unwrap: store_reg(inst.dst, load_reg(inst.a, inst.type_a), inst.result_type); break;
             case LIR::LIR_Op::ListCreate: {
-                used_builtins_.insert("lm_list_new");
-                ir::Function* fn = current_module_->getFunction("lm_list_new");
-                if (!fn) fn = builder_->createFunction("lm_list_new", context_->getIntegerType(64), {context_->getIntegerType(64)});
+                used_builtins_.insert("lm_list_new_typed");
+                ir::Function* fn = current_module_->getFunction("lm_list_new_typed");
+                if (!fn) fn = builder_->createFunction("lm_list_new_typed", context_->getIntegerType(64), {context_->getIntegerType(64)});
                 store_reg(inst.dst, builder_->createCall(fn, {context_->getConstantInt(context_->getIntegerType(64), (long long)inst.imm)}), inst.result_type);
                 break;
             }
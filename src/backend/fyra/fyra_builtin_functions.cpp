@@ -1,9 +1,11 @@
 // fyra_builtin_functions.cpp - Built-in functions implemented in Fyra IR
 
 #include "fyra_builtin_functions.hh"
+#include "../../runtime/runtime_string.h"
 #include "ir/Constant.h"
 #include "ir/Type.h"
 #include "ir/Syscall.h"
+#include <cstddef>
 
 namespace LM::Backend::Fyra {
 
@@ -12,9 +14,11 @@ bool FyraBuiltinFunctions::is_builtin(const std::string& name) {
         "print", "assert", "abs", "sqrt", "sin", "cos", "tan", "asin", "acos", "atan",
         "log", "log10", "exp", "ceil", "floor", "round", "len", "input", "time", "sleep", "typeof",
         "file_open", "file_read", "file_write", "file_close", "file_exists", "file_delete",
-        "lm_box_string", "lm_list_new", "lm_list_append", "lm_list_get", "lm_list_set", "lm_list_len",
+        "lm_string_new_cstr", "lm_list_new", "lm_list_new_typed", "lm_list_append", "lm_list_get", "lm_list_set", "lm_list_len",
         "lm_tuple_new", "lm_tuple_set", "lm_tuple_get",
-        "jit_dict_new", "lm_dict_set", "lm_dict_get"
+        "jit_dict_new", "lm_dict_set", "lm_dict_get",
+        "list_sum", "list_min", "list_max", "list_mean", "list_dot", "list_contains", "list_index_of",
+        "list_count", "list_add", "list_mul", "list_scale", "list_prefix_sum"
     };
     return builtins.count(name) > 0;
 }
@@ -23,6 +27,9 @@ std::string FyraBuiltinFunctions::get_internal_name(const std::string& name) {
     if (name == "print") return "lm_print"; 
     if (name == "assert") return "lm_assert";
     if (name == "len") return "lm_list_len"; // Or lm_print_str length if we want.
+    // The searches return raw bool/int64_t; their _value forms box the result
+    if (name == "list_contains" || name == "list_index_of" || name == "list_count") return "lm_" + name + "_value";
+    if (name.rfind("list_", 0) == 0) return "lm_" + name; // Vectorized list kernels
     return name;
 }
 
@@ -32,7 +39,6 @@ void FyraBuiltinFunctions::emit_used_builtins(ir::Module* module,
     if (used_builtins.count("lm_print_int")) emit_print_int(module, builder);
     if (used_builtins.count("lm_print_str")) emit_print_str(module, builder);
     if (used_builtins.count("lm_assert")) emit_assert(module, builder);
-    if (used_builtins.count("lm_box_string")) emit_box_string(module, builder);
     if (used_builtins.count("abs")) emit_abs(module, builder);
 
     // External Runtime Declarations
@@ -40,6 +46,7 @@ void FyraBuiltinFunctions::emit_used_builtins(ir::Module* module,
     decl_runtime_tuple(module, builder);
     decl_runtime_dict(module, builder);
     decl_runtime_math(module, builder);
+    decl_runtime_string(module, builder);
 }
 
 void FyraBuiltinFunctions::emit_print_int(ir::Module* module, ir::IRBuilder* builder) {
@@ -139,8 +146,10 @@ void FyraBuiltinFunctions::emit_print_str(ir::Module* module, ir::IRBuilder* bui
     ir::BasicBlock* ps_loop = builder->createBasicBlock("loop", print_str);
     ir::BasicBlock* ps_done = builder->createBasicBlock("done", print_str);
 
+    // Strings are runtime ObjStrings; the NUL-terminated characters follow the header
     builder->setInsertPoint(ps_entry);
-    ir::Value* s_val = print_str->getParameters().front().get();
+    ir::Value* s_val = builder->createAdd(print_str->getParameters().front().get(),
+                                          context->getConstantInt(context->getIntegerType(64), offsetof(ObjString, data)));
     ir::Instruction* len_slot = builder->createAlloc(context->getConstantInt(context->getIntegerType(64), 8), context->getIntegerType(64));
     builder->createStore(context->getConstantInt(context->getIntegerType(64), 0), len_slot);
     builder->createJmp(ps_loop);
@@ -214,15 +223,6 @@ void FyraBuiltinFunctions::emit_assert(ir::Module* module, ir::IRBuilder* builde
     builder->createRet(nullptr);
 }
 
-void FyraBuiltinFunctions::emit_box_string(ir::Module* module, ir::IRBuilder* builder) {
-    if (module->getFunction("lm_box_string")) return;
-    auto context = module->getContextShared();
-    ir::Function* box_string = builder->createFunction("lm_box_string", context->getIntegerType(64), {context->getIntegerType(64)});
-    ir::BasicBlock* s_entry = builder->createBasicBlock("entry", box_string);
-    builder->setInsertPoint(s_entry);
-    builder->createRet(box_string->getParameters().front().get());
-}
-
 void FyraBuiltinFunctions::emit_abs(ir::Module* module, ir::IRBuilder* builder) {
     if (module->getFunction("abs")) return;
     auto context = module->getContextShared();
@@ -247,6 +247,8 @@ void FyraBuiltinFunctions::decl_runtime_list(ir::Module* module, ir::IRBuilder*
     auto context = module->getContextShared();
     if (!module->getFunction("lm_list_new"))
         builder->createFunction("lm_list_new", context->getIntegerType(64), {});
+    if (!module->getFunction("lm_list_new_typed"))
+        builder->createFunction("lm_list_new_typed", context->getIntegerType(64), {context->getIntegerType(64)});
     if (!module->getFunction("lm_list_append"))
         builder->createFunction("lm_list_append", context->getVoidType(), {context->getIntegerType(64), context->getIntegerType(64)});
     if (!module->getFunction("lm_list_get"))
@@ -255,6 +257,17 @@ void FyraBuiltinFunctions::decl_runtime_list(ir::Module* module, ir::IRBuilder*
         builder->createFunction("lm_list_set", context->getVoidType(), {context->getIntegerType(64), context->getIntegerType(64), context->getIntegerType(64)});
     if (!module->getFunction("lm_list_len"))
         builder->createFunction("lm_list_len", context->getIntegerType(64), {context->getIntegerType(64)});
+
+    // Vectorized kernels (runtime_kernels.h)
+    for (const char* name : {"lm_list_sum", "lm_list_min", "lm_list_max", "lm_list_mean", "lm_list_prefix_sum"}) {
+        if (!module->getFunction(name))
+            builder->createFunction(name, context->getIntegerType(64), {context->getIntegerType(64)});
+    }
+    for (const char* name : {"lm_list_dot", "lm_list_contains_value", "lm_list_index_of_value", "lm_list_count_value",
+                             "lm_list_add", "lm_list_mul", "lm_list_scale"}) {
+        if (!module->getFunction(name))
+            builder->createFunction(name, context->getIntegerType(64), {context->getIntegerType(64), context->getIntegerType(64)});
+    }
 }
 
 void FyraBuiltinFunctions::decl_runtime_dict(ir::Module* module, ir::IRBuilder* builder) {
@@ -290,6 +303,9 @@ void FyraBuiltinFunctions::decl_runtime_math(ir::Module* module, ir::IRBuilder*
 
 void FyraBuiltinFunctions::decl_runtime_string(ir::Module* module, ir::IRBuilder* builder) {
     auto context = module->getContextShared();
+    // String literals are ObjStrings built by the runtime from their C text
+    if (!module->getFunction("lm_string_new_cstr"))
+        builder->createFunction("lm_string_new_cstr", context->getPointerType(context->getIntegerType(8)), {context->getPointerType(context->getIntegerType(8))});
     if (!module->getFunction("concat"))
         builder->createFunction("concat", context->getPointerType(context->getIntegerType(8)), {context->getPointerType(context->getIntegerType(8)), context->getPointerType(context->getIntegerType(8))});
     if (!module->getFunction("length"))
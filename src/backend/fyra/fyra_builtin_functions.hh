@@ -24,7 +24,6 @@ private:
     static void emit_print_int(ir::Module* module, ir::IRBuilder* builder);
     static void emit_print_str(ir::Module* module, ir::IRBuilder* builder);
     static void emit_assert(ir::Module* module, ir::IRBuilder* builder);
-    static void emit_box_string(ir::Module* module, ir::IRBuilder* builder);
     static void emit_abs(ir::Module* module, ir::IRBuilder* builder);
     
     // External Runtime Declarations
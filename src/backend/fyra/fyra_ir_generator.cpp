@@ -288,10 +288,10 @@ ir::Value* FyraIRGenerator::emit_literal_expr(
              }
              return context_->getConstantInt(context_->getIntegerType(64), val);
         } else {
-             used_builtins_.insert("lm_box_string");
-             ir::Function* box_string = current_module_->getFunction("lm_box_string");
+             // The runtime builds the ObjString from the literal's C text
+             ir::Function* box_string = current_module_->getFunction("lm_string_new_cstr");
              if (!box_string) {
-                 box_string = builder_->createFunction("lm_box_string", context_->getPointerType(context_->getIntegerType(8)), {context_->getPointerType(context_->getIntegerType(8))});
+                 box_string = builder_->createFunction("lm_string_new_cstr", context_->getPointerType(context_->getIntegerType(8)), {context_->getPointerType(context_->getIntegerType(8))});
              }
              ir::Value* str_const = context_->getConstantString(s);
              std::string name = "$str" + std::to_string(label_counter_++);
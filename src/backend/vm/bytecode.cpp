@@ -0,0 +1,259 @@
+#include "bytecode.hh"
+#include "../../runtime/runtime.h"
+#include <algorithm>
+#include <unordered_map>
+
+namespace LM {
+namespace Backend {
+namespace VM {
+namespace Register {
+
+const LIR::LIR_SourceLoc* ExecutableFunction::location_at(uint32_t pc) const {
+    auto it = std::upper_bound(pc_locations.begin(), pc_locations.end(), pc,
+        [](uint32_t value, const std::pair<uint32_t, uint32_t>& entry) { return value < entry.first; });
+    if (it == pc_locations.begin()) return nullptr;
+    return &locations[std::prev(it)->second];
+}
+
+// Calls the linker could not bind to a user function name a builtin
+static void resolve_builtin(CallSite& site, const std::string& name) {
+    if (name == "assert") {
+        site.builtin = CallBuiltin::Assert;
+    } else if (name == "intern") {
+        site.builtin = CallBuiltin::Intern;
+    } else if ((site.kernel = lm_list_kernel(name.c_str()))) {
+        site.builtin = CallBuiltin::ListKernel;
+    }
+}
+
+static void record_location(ExecutableFunction& fn, uint32_t pc, const LIR::LIR_SourceLoc& loc) {
+    if (loc.line == 0) return;
+
+    if (!fn.pc_locations.empty()) {
+        const auto& last = fn.locations[fn.pc_locations.back().second];
+        if (last.line == loc.line && last.column == loc.column && last.filename == loc.filename) return;
+    }
+
+    uint32_t index = static_cast<uint32_t>(fn.locations.size());
+    fn.locations.push_back(loc);
+    fn.pc_locations.emplace_back(pc, index);
+}
+
+static bool is_int_type(LIR::Type type) {
+    return type == LIR::Type::I64 || type == LIR::Type::I32;
+}
+
+// Specialized opcode for a generic arithmetic or comparison instruction whose
+// operand types are statically known, or the instruction's own opcode
+static LIR::LIR_Op specialize(LIR::LIR_Op op, LIR::Type type_a, LIR::Type type_b) {
+    using LIR::LIR_Op;
+
+    if (is_int_type(type_a) && is_int_type(type_b)) {
+        switch (op) {
+            case LIR_Op::Add: return LIR_Op::AddI64;
+            case LIR_Op::Sub: return LIR_Op::SubI64;
+            case LIR_Op::Mul: return LIR_Op::MulI64;
+            case LIR_Op::Div: return LIR_Op::DivI64;
+            case LIR_Op::CmpEQ: return LIR_Op::CmpEqI64;
+            case LIR_Op::CmpNEQ: return LIR_Op::CmpNeI64;
+            case LIR_Op::CmpLT: return LIR_Op::CmpLtI64;
+            case LIR_Op::CmpLE: return LIR_Op::CmpLeI64;
+            case LIR_Op::CmpGT: return LIR_Op::CmpGtI64;
+            case LIR_Op::CmpGE: return LIR_Op::CmpGeI64;
+            default: break;
+        }
+    } else if (type_a == LIR::Type::F64 && type_b == LIR::Type::F64) {
+        switch (op) {
+            case LIR_Op::Add: return LIR_Op::AddF64;
+            case LIR_Op::Sub: return LIR_Op::SubF64;
+            case LIR_Op::Mul: return LIR_Op::MulF64;
+            case LIR_Op::Div: return LIR_Op::DivF64;
+            default: break;
+        }
+    }
+    return op;
+}
+
+static bool is_heap_type(LmValue v, uint32_t type_id) {
+    return IS_PTR(v) && ((ObjHeader*)UNBOX_PTR(v))->type_id == type_id;
+}
+
+static bool is_float_value(LmValue v) {
+    return IS_FLOAT_IMM(v) || is_heap_type(v, TYPE_FLOAT);
+}
+
+void quicken(Instr& instr, LmValue a, LmValue b) {
+    LIR::LIR_Op generic = static_cast<LIR::LIR_Op>(instr.op);
+    LIR::LIR_Op target = generic;
+
+    switch (generic) {
+        case LIR::LIR_Op::ListIndex:
+            if (is_heap_type(a, TYPE_LIST) && IS_INT(b)) target = LIR::LIR_Op::ListIndexI64;
+            break;
+        case LIR::LIR_Op::FrameGetField:
+            if (is_heap_type(a, TYPE_FRAME)) target = LIR::LIR_Op::FrameGetFieldInline;
+            break;
+        default:
+            if (IS_INT(a) && IS_INT(b)) {
+                target = specialize(generic, LIR::Type::I64, LIR::Type::I64);
+            } else if (is_float_value(a) && is_float_value(b)) {
+                target = specialize(generic, LIR::Type::F64, LIR::Type::F64);
+            }
+            break;
+    }
+
+    if (target == generic) {
+        ++instr.aux;
+        return;
+    }
+    instr.op = static_cast<uint8_t>(target);
+    instr.flags |= INSTR_QUICKENED;
+}
+
+// Jump to the very next instruction, left behind by structured control flow
+static bool is_jump_to_next(const LIR::LIR_Inst& inst, uint32_t pc) {
+    return inst.op == LIR::LIR_Op::Jump && inst.imm == pc + 1;
+}
+
+// Fuse the opcode pairs that dominate benchmarks/op_pairs.sh into
+// superinstructions. Only the first instruction of a pair is rewritten: the
+// second stays in place so jumps that target it still land on a complete
+// instruction, and the fused handler skips over it.
+static void fuse_superinstructions(ExecutableFunction& fn) {
+    using LIR::LIR_Op;
+    auto op_of = [](const Instr& instr) { return static_cast<LIR_Op>(instr.op); };
+    auto set_op = [](Instr& instr, LIR_Op op) { instr.op = static_cast<uint8_t>(op); };
+
+    std::vector<Instr>& code = fn.code;
+    for (size_t pc = 0; pc + 1 < code.size(); ++pc) {
+        Instr& first = code[pc];
+        const Instr& second = code[pc + 1];
+        LIR_Op pair = op_of(first);
+
+        if (op_of(second) == LIR_Op::JumpIfFalse && second.a == first.dst) {
+            if (pair == LIR_Op::CmpLtI64) set_op(first, LIR_Op::CmpLtI64JumpIfFalse);
+            else if (pair == LIR_Op::CmpEqI64) set_op(first, LIR_Op::CmpEqI64JumpIfFalse);
+        } else if (pair == LIR_Op::LoadConst) {
+            if (op_of(second) == LIR_Op::AddI64) set_op(first, LIR_Op::LoadConstAddI64);
+            else if (op_of(second) == LIR_Op::SubI64) set_op(first, LIR_Op::LoadConstSubI64);
+        }
+        if (op_of(first) != pair) ++pc;
+    }
+
+    // Loop back-edges evaluate the loop test they jump to
+    for (Instr& instr : code) {
+        if (op_of(instr) == LIR_Op::Jump && instr.b < code.size() &&
+            op_of(code[instr.b]) == LIR_Op::CmpLtI64JumpIfFalse) {
+            set_op(instr, LIR_Op::JumpCmpLtI64);
+        }
+    }
+}
+
+ExecutableFunction lower_function(const std::string& name,
+                                  const std::vector<LIR::LIR_Inst>& instructions,
+                                  uint32_t register_count,
+                                  uint32_t param_count,
+                                  ConstantPool& pool,
+                                  bool superinstructions) {
+    ExecutableFunction fn;
+    fn.name = name;
+    fn.register_count = register_count;
+    fn.param_count = param_count;
+    fn.code.reserve(instructions.size());
+
+    // Drop jumps to the next instruction; new_pc maps every LIR pc (and the
+    // end of the function) to its executable pc
+    const uint32_t count = static_cast<uint32_t>(instructions.size());
+    std::vector<uint32_t> new_pc(count + 1);
+    uint32_t kept = 0;
+    for (uint32_t pc = 0; pc < count; ++pc) {
+        new_pc[pc] = kept;
+        if (!is_jump_to_next(instructions[pc], pc)) ++kept;
+    }
+    new_pc[count] = kept;
+
+    std::unordered_map<LmValue, uint32_t> constant_slots;
+
+    for (uint32_t pc = 0; pc < count; ++pc) {
+        const LIR::LIR_Inst& inst = instructions[pc];
+        if (is_jump_to_next(inst, pc)) continue;
+        Instr out{static_cast<uint8_t>(inst.op), 0, 0, inst.dst, inst.a, inst.b};
+
+        switch (inst.op) {
+            case LIR::LIR_Op::Add:
+            case LIR::LIR_Op::Sub:
+            case LIR::LIR_Op::Mul:
+            case LIR::LIR_Op::Div:
+            case LIR::LIR_Op::CmpEQ:
+            case LIR::LIR_Op::CmpNEQ:
+            case LIR::LIR_Op::CmpLT:
+            case LIR::LIR_Op::CmpLE:
+            case LIR::LIR_Op::CmpGT:
+            case LIR::LIR_Op::CmpGE:
+                out.op = static_cast<uint8_t>(specialize(inst.op, inst.type_a, inst.type_b));
+                break;
+            case LIR::LIR_Op::Mov:
+            case LIR::LIR_Op::ListIndex:
+            case LIR::LIR_Op::ListAppend:
+            case LIR::LIR_Op::FrameGetField:
+            case LIR::LIR_Op::Param:
+            case LIR::LIR_Op::Return:
+            case LIR::LIR_Op::Ret:
+            case LIR::LIR_Op::RegionEnter:
+            case LIR::LIR_Op::RegionExit:
+            case LIR::LIR_Op::IterBegin:
+            case LIR::LIR_Op::IterNext:
+            case LIR::LIR_Op::IterKey:
+            case LIR::LIR_Op::IterValue:
+                break;
+            case LIR::LIR_Op::LoadConst: {
+                LmValue value = pool.intern(inst.const_val);
+                auto [slot, added] = constant_slots.emplace(value, static_cast<uint32_t>(fn.constants.size()));
+                if (added) fn.constants.push_back(value);
+                out.b = slot->second;
+                break;
+            }
+            case LIR::LIR_Op::LoadGlobal:
+            case LIR::LIR_Op::StoreGlobal:
+                out.b = inst.func_index;
+                break;
+            case LIR::LIR_Op::Jump:
+            case LIR::LIR_Op::JumpIf:
+            case LIR::LIR_Op::JumpIfFalse:
+                out.b = new_pc[std::min<uint32_t>(inst.imm, count)];
+                break;
+            case LIR::LIR_Op::Call: {
+                CallSite site;
+                site.func_index = inst.func_index;
+                site.first_arg = static_cast<uint32_t>(fn.call_args.size());
+                site.arg_count = static_cast<uint32_t>(inst.call_args.size());
+                if (site.func_index == UINT32_MAX) resolve_builtin(site, inst.func_name);
+                fn.call_args.insert(fn.call_args.end(), inst.call_args.begin(), inst.call_args.end());
+                out.b = static_cast<uint32_t>(fn.calls.size());
+                fn.calls.push_back(site);
+                break;
+            }
+            case LIR::LIR_Op::NewFrame:
+                out.a = static_cast<uint32_t>(fn.frame_types.size());
+                fn.frame_types.push_back(lm_frame_type(inst.func_name.c_str(), static_cast<int>(inst.imm)));
+                out.b = static_cast<uint32_t>(fn.extended.size());
+                fn.extended.push_back(inst);
+                break;
+            default:
+                out.b = static_cast<uint32_t>(fn.extended.size());
+                fn.extended.push_back(inst);
+                break;
+        }
+
+        record_location(fn, static_cast<uint32_t>(fn.code.size()), inst.loc);
+        fn.code.push_back(out);
+    }
+
+    if (superinstructions) fuse_superinstructions(fn);
+    return fn;
+}
+
+} // namespace Register
+} // namespace VM
+} // namespace Backend
+} // namespace LM
@@ -0,0 +1,121 @@
+#ifndef REGISTER_BYTECODE_H
+#define REGISTER_BYTECODE_H
+
+#include "../../lir/lir.hh"
+#include "constant_pool.hh"
+#include "../../runtime/runtime_value_base.h"
+#include "../../runtime/runtime_kernels.h"
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+struct LmFrameType;
+
+namespace LM {
+namespace Backend {
+namespace VM {
+namespace Register {
+
+// One executable instruction. Only the operands the dispatch loop needs are
+// stored inline; everything else lives in the function's side tables.
+//
+//   LoadConst           b = index into constants (pooled, see ConstantPool)
+//   Jump                b = target pc
+//   JumpIf/JumpIfFalse  a = condition, b = target pc
+//   Call                b = index into calls
+//   FrameGetField       b = field offset
+//   LoadGlobal          b = global slot (StoreGlobal: a = value, b = slot)
+//   NewFrame            a = index into frame_types, b = index into extended
+//   Mov, arithmetic, comparisons, ListIndex, ListAppend, Param, Return/Ret
+//   and the Iter* ops use dst/a/b directly
+//   Arithmetic and comparisons with known operand types are rewritten to
+//   their type-specialized opcodes (AddI64, CmpLtI64, AddF64, ...)
+//   every other opcode  b = index into extended (the full LIR instruction)
+//   Superinstructions (CmpLtI64JumpIfFalse, LoadConstAddI64, ...) keep the
+//   operands of the first instruction of their pair and read the second
+//   from the instruction that follows; JumpCmpLtI64 keeps its jump target
+struct Instr {
+    uint8_t op;       // LIR::LIR_Op
+    uint8_t flags;    // INSTR_* bits
+    uint16_t aux;     // Quickening attempts and guard failures at this site
+    uint32_t dst;
+    uint32_t a;
+    uint32_t b;
+};
+static_assert(sizeof(Instr) == 16, "executable instructions must stay 16 bytes");
+
+// Generic Add/Sub/Mul/Div, comparisons, ListIndex and FrameGetField rewrite
+// themselves in place to a specialized opcode for the operands they first
+// see. A quickened instruction that meets other operands reverts to the
+// generic opcode; once a site has used up its budget it stays generic.
+constexpr uint8_t INSTR_QUICKENED = 0x1;  // op was installed at run time
+constexpr uint16_t QUICKEN_BUDGET = 8;
+
+// Rewrite a generic instruction for the operand values a and b (for
+// FrameGetField only a is used). Sites with no matching variant are charged
+// against their budget so they stop trying.
+void quicken(Instr& instr, LmValue a, LmValue b);
+
+// Revert a quickened instruction after a failed guard
+inline void deoptimize(Instr& instr, LIR::LIR_Op generic) {
+    if (!(instr.flags & INSTR_QUICKENED)) return;
+    instr.op = static_cast<uint8_t>(generic);
+    instr.flags &= static_cast<uint8_t>(~INSTR_QUICKENED);
+    ++instr.aux;
+}
+
+// Builtins a call site names instead of a user function, resolved by name
+// once when the function is lowered
+enum class CallBuiltin : uint8_t {
+    None,        // Not a builtin the VM provides; the call leaves dst alone
+    Assert,
+    Intern,
+    ListKernel,  // One of the list_* kernels, in CallSite::kernel
+};
+
+struct CallSite {
+    uint32_t func_index;  // Function table index, UINT32_MAX for builtins
+    uint32_t first_arg;   // Offset into call_args
+    uint32_t arg_count;
+    CallBuiltin builtin = CallBuiltin::None;
+    LmListKernel kernel = nullptr;
+};
+
+// A function lowered for execution. Built once at load time; afterwards only
+// quickening rewrites the op/flags/aux of individual instructions.
+struct ExecutableFunction {
+    std::string name;
+    std::vector<Instr> code;
+    std::vector<LmValue> constants;       // Distinct values this function loads
+    std::vector<CallSite> calls;
+    std::vector<LIR::Reg> call_args;
+    std::vector<LIR::LIR_Inst> extended;
+    std::vector<const LmFrameType*> frame_types;  // Descriptors for NewFrame, resolved once
+    uint32_t register_count = 0;
+    uint32_t param_count = 0;
+
+    // pc -> source location, one entry per run of instructions sharing a location
+    std::vector<std::pair<uint32_t, uint32_t>> pc_locations;
+    std::vector<LIR::LIR_SourceLoc> locations;
+
+    // Location of the instruction at pc, or nullptr when none was recorded
+    const LIR::LIR_SourceLoc* location_at(uint32_t pc) const;
+};
+
+// Lower a linked LIR function. Constants are interned in pool; jumps to the
+// next instruction are dropped; superinstructions are fused unless disabled
+// (opcode-pair profiling).
+ExecutableFunction lower_function(const std::string& name,
+                                  const std::vector<LIR::LIR_Inst>& instructions,
+                                  uint32_t register_count,
+                                  uint32_t param_count,
+                                  ConstantPool& pool,
+                                  bool superinstructions = true);
+
+} // namespace Register
+} // namespace VM
+} // namespace Backend
+} // namespace LM
+
+#endif // REGISTER_BYTECODE_H
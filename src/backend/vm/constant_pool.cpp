@@ -0,0 +1,53 @@
+#include "constant_pool.hh"
+#include "../../runtime/runtime.h"
+
+namespace LM {
+namespace Backend {
+namespace VM {
+namespace Register {
+
+template <typename T>
+static std::string payload_key(uint32_t type_id, const T& payload) {
+    std::string key(1, static_cast<char>(type_id));
+    key.append(reinterpret_cast<const char*>(&payload), sizeof(payload));
+    return key;
+}
+
+LmValue ConstantPool::intern(LmValue value) {
+    if (!IS_PTR(value) || value == 0) return value;
+
+    ObjHeader* header = (ObjHeader*)UNBOX_PTR(value);
+    if (header->type_id == TYPE_STRING) {
+        // Strings share the runtime intern table, so a literal and a string
+        // interned while the program runs are the same object
+        ObjString* string = lm_string_intern((ObjString*)header);
+        if (!(string->header.metadata & OBJ_IMMUTABLE)) {
+            string->header.metadata |= OBJ_IMMUTABLE;
+            objects_.push_back(BOX_PTR(string));
+        }
+        return BOX_PTR(string);
+    }
+
+    std::string key;
+    switch (header->type_id) {
+        case TYPE_FLOAT: key = payload_key(header->type_id, ((ObjFloat*)header)->value); break;
+        case TYPE_I64: key = payload_key(header->type_id, ((ObjI64*)header)->value); break;
+        case TYPE_U64: key = payload_key(header->type_id, ((ObjU64*)header)->value); break;
+        case TYPE_I128: key = payload_key(header->type_id, ((ObjI128*)header)->value); break;
+        case TYPE_U128: key = payload_key(header->type_id, ((ObjU128*)header)->value); break;
+        default:
+            return value;
+    }
+
+    auto [it, inserted] = index_.emplace(std::move(key), value);
+    if (inserted) {
+        header->metadata |= OBJ_IMMUTABLE;
+        objects_.push_back(value);
+    }
+    return it->second;
+}
+
+} // namespace Register
+} // namespace VM
+} // namespace Backend
+} // namespace LM
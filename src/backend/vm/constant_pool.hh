@@ -0,0 +1,38 @@
+#ifndef REGISTER_CONSTANT_POOL_H
+#define REGISTER_CONSTANT_POOL_H
+
+#include "../../runtime/runtime_value_base.h"
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace LM {
+namespace Backend {
+namespace VM {
+namespace Register {
+
+// Literal values shared by every function of a program. Lowering passes each
+// LoadConst value through intern(), so equal string literals and boxed
+// numbers (floats, 64-bit and 128-bit integers) resolve to one object, built
+// before anything runs. String literals are resolved through the runtime
+// intern table (lm_string_intern). Pooled objects are marked OBJ_IMMUTABLE
+// and live as long as the pool.
+class ConstantPool {
+public:
+    // Canonical value for a literal. Immediates and objects that are not
+    // literals (function handles, collections) come back unchanged.
+    LmValue intern(LmValue value);
+
+    const std::vector<LmValue>& objects() const { return objects_; }
+
+private:
+    std::unordered_map<std::string, LmValue> index_;  // Type id + payload bytes -> object
+    std::vector<LmValue> objects_;
+};
+
+} // namespace Register
+} // namespace VM
+} // namespace Backend
+} // namespace LM
+
+#endif // REGISTER_CONSTANT_POOL_H
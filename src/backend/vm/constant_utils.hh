@@ -5,23 +5,70 @@
 #include "backend/value.hh"
 #include "runtime/runtime.h"
 #include "runtime/runtime_value.h"
+#include <cstdlib>
+#include <string>
 
 namespace LM {
 namespace Backend {
 namespace VM {
 
-inline LM::Backend::Value compiler_value_to_backend_value(const std::shared_ptr<::Value>& cv) {
-    if (!cv) return VAL_NIL;
-    if (cv->type->tag == ::TypeTag::Int || cv->type->tag == ::TypeTag::Int64) {
-        return make_i64(std::stoll(cv->data));
+inline __int128 parse_i128(const std::string& s) {
+    __int128 result = 0;
+    bool neg = false;
+    size_t i = 0;
+    if (s.empty()) return 0;
+    if (s[0] == '-') { neg = true; i = 1; }
+    for (; i < s.length(); i++) {
+        if (s[i] >= '0' && s[i] <= '9')
+            result = result * 10 + (s[i] - '0');
     }
-    if (cv->type->tag == ::TypeTag::String) {
-        return BOX_PTR(lm_box_string(cv->data.c_str()));
+    return neg ? -result : result;
+}
+
+inline unsigned __int128 parse_u128(const std::string& s) {
+    unsigned __int128 result = 0;
+    for (size_t i = 0; i < s.length(); i++) {
+        if (s[i] >= '0' && s[i] <= '9')
+            result = result * 10 + (s[i] - '0');
     }
-    if (cv->type->tag == ::TypeTag::Bool) {
-        return (cv->data == "true") ? VAL_TRUE : VAL_FALSE;
+    return result;
+}
+
+// Materialize a literal once, at code generation time. Integers take the
+// smallest representation that holds them (SMI, boxed 64-bit, boxed 128-bit);
+// decimals are their scaled integer, which the generator formats with the
+// scale of the register's type (see Generator::emit_decimal_text).
+inline LM::Backend::Value compiler_value_to_backend_value(const std::shared_ptr<::Value>& cv) {
+    if (!cv) return VAL_NIL;
+    switch (cv->type->tag) {
+        case ::TypeTag::Int:
+        case ::TypeTag::Int8:
+        case ::TypeTag::Int16:
+        case ::TypeTag::Int32:
+        case ::TypeTag::Int64:
+        case ::TypeTag::Int128:
+        case ::TypeTag::Decimal2:
+        case ::TypeTag::Decimal4:
+        case ::TypeTag::Decimal6:
+            return make_i128(parse_i128(cv->data));
+        case ::TypeTag::UInt:
+        case ::TypeTag::UInt8:
+        case ::TypeTag::UInt16:
+        case ::TypeTag::UInt32:
+        case ::TypeTag::UInt64:
+            return make_u64(static_cast<uint64_t>(parse_u128(cv->data)));
+        case ::TypeTag::UInt128:
+            return make_u128(parse_u128(cv->data));
+        case ::TypeTag::Float32:
+        case ::TypeTag::Float64:
+            return make_float(std::strtod(cv->data.c_str(), nullptr));
+        case ::TypeTag::String:
+            return BOX_PTR(lm_string_new(cv->data.data(), cv->data.size()));
+        case ::TypeTag::Bool:
+            return (cv->data == "true") ? VAL_TRUE : VAL_FALSE;
+        default:
+            return VAL_NIL;
     }
-    return VAL_NIL;
 }
 
 } // namespace VM
@@ -6,46 +6,56 @@ namespace Backend {
 namespace VM {
 namespace Register {
 
+// 10^scale for the decimal scales the language has (d2, d4, d6)
+static inline LmValue decimal_factor(uint32_t scale) {
+    int64_t factor = 1;
+    for (uint32_t i = 0; i < scale; ++i) factor *= 10;
+    return make_i64(factor);
+}
+
 void RegisterVM::execute_arithmetic(const LIR::LIR_Inst* pc) {
     switch (pc->op) {
         case LIR::LIR_Op::Add:
-            registers[pc->dst] = lm_add(registers[pc->a], registers[pc->b]);
+            frame_[pc->dst] = lm_add_inline(frame_[pc->a], frame_[pc->b]);
             break;
         case LIR::LIR_Op::Sub:
-            registers[pc->dst] = lm_sub(registers[pc->a], registers[pc->b]);
+            frame_[pc->dst] = lm_sub_inline(frame_[pc->a], frame_[pc->b]);
             break;
         case LIR::LIR_Op::Mul:
-            registers[pc->dst] = lm_mul(registers[pc->a], registers[pc->b]);
+            frame_[pc->dst] = lm_mul_inline(frame_[pc->a], frame_[pc->b]);
             break;
         case LIR::LIR_Op::Div:
-            registers[pc->dst] = lm_div(registers[pc->a], registers[pc->b]);
+            frame_[pc->dst] = lm_div_inline(frame_[pc->a], frame_[pc->b]);
+            break;
+        case LIR::LIR_Op::Mod:
+            frame_[pc->dst] = lm_mod_inline(frame_[pc->a], frame_[pc->b]);
             break;
         case LIR::LIR_Op::Neg:
-            registers[pc->dst] = lm_sub(make_i64(0), registers[pc->a]);
+            frame_[pc->dst] = lm_sub_inline(make_i64(0), frame_[pc->a]);
             break;
         case LIR::LIR_Op::DecAdd:
-            registers[pc->dst] = lm_add(registers[pc->a], registers[pc->b]);
+            frame_[pc->dst] = lm_add_inline(frame_[pc->a], frame_[pc->b]);
             break;
         case LIR::LIR_Op::DecSub:
-            registers[pc->dst] = lm_sub(registers[pc->a], registers[pc->b]);
+            frame_[pc->dst] = lm_sub_inline(frame_[pc->a], frame_[pc->b]);
             break;
         case LIR::LIR_Op::DecMul:
-            // Simplified: decimal multiply needs rescaling, but let's use runtime
-            registers[pc->dst] = lm_mul(registers[pc->a], registers[pc->b]);
+            // Decimals are integers scaled by 10^imm; the product carries the scale twice
+            frame_[pc->dst] = lm_div_inline(lm_mul_inline(frame_[pc->a], frame_[pc->b]), decimal_factor(pc->imm));
             break;
         case LIR::LIR_Op::DecDiv:
-            registers[pc->dst] = lm_div(registers[pc->a], registers[pc->b]);
+            frame_[pc->dst] = lm_div_inline(lm_mul_inline(frame_[pc->a], decimal_factor(pc->imm)), frame_[pc->b]);
             break;
         case LIR::LIR_Op::DecMod:
-            // Placeholder
-            registers[pc->dst] = VAL_NIL;
+            // Both operands carry the same scale, and so does their remainder
+            frame_[pc->dst] = lm_mod_inline(frame_[pc->a], frame_[pc->b]);
             break;
         case LIR::LIR_Op::DecNeg:
-            registers[pc->dst] = lm_sub(make_i64(0), registers[pc->a]);
+            frame_[pc->dst] = lm_sub_inline(make_i64(0), frame_[pc->a]);
             break;
         case LIR::LIR_Op::DecRescale:
-            // Simplified rescale
-            registers[pc->dst] = registers[pc->a];
+            // Widen by the difference in scale, held in imm
+            frame_[pc->dst] = lm_mul_inline(frame_[pc->a], decimal_factor(pc->imm));
             break;
         default:
             break;
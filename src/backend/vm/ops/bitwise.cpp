@@ -9,13 +9,13 @@ namespace Register {
 void RegisterVM::execute_bitwise(const LIR::LIR_Inst* pc) {
     switch (pc->op) {
         case LIR::LIR_Op::And:
-            registers[pc->dst] = make_i64(to_int(registers[pc->a]) & to_int(registers[pc->b]));
+            frame_[pc->dst] = make_i64(to_int(frame_[pc->a]) & to_int(frame_[pc->b]));
             break;
         case LIR::LIR_Op::Or:
-            registers[pc->dst] = make_i64(to_int(registers[pc->a]) | to_int(registers[pc->b]));
+            frame_[pc->dst] = make_i64(to_int(frame_[pc->a]) | to_int(frame_[pc->b]));
             break;
         case LIR::LIR_Op::Xor:
-            registers[pc->dst] = make_i64(to_int(registers[pc->a]) ^ to_int(registers[pc->b]));
+            frame_[pc->dst] = make_i64(to_int(frame_[pc->a]) ^ to_int(frame_[pc->b]));
             break;
         default:
             break;
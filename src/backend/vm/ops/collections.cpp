@@ -1,6 +1,7 @@
 #include "../register.hh"
 #include "../../../runtime/runtime.h"
 #include "../../../runtime/runtime_list.h"
+#include "../../../runtime/runtime_string.h"
 #include "../../../runtime/runtime_dict.h"
 #include "../../../runtime/runtime_tuple.h"
 #include "../../../runtime/runtime_value.h"
@@ -10,32 +11,81 @@ namespace Backend {
 namespace VM {
 namespace Register {
 
+static inline LmDict* as_dict(LmValue v) {
+    return IS_PTR(v) && ((ObjHeader*)UNBOX_PTR(v))->type_id == TYPE_DICT ? (LmDict*)UNBOX_PTR(v) : nullptr;
+}
+
+static inline LmList* as_list(LmValue v) {
+    return IS_PTR(v) && ((ObjHeader*)UNBOX_PTR(v))->type_id == TYPE_LIST ? (LmList*)UNBOX_PTR(v) : nullptr;
+}
+
 void RegisterVM::execute_collections(const LIR::LIR_Inst* pc) {
     switch (pc->op) {
         case LIR::LIR_Op::ListCreate:
-            registers[pc->dst] = BOX_PTR(lm_list_new());
+            frame_[pc->dst] = BOX_PTR(lm_list_new_typed(static_cast<LmListKind>(pc->imm)));
             break;
-        case LIR::LIR_Op::ListAppend:
-            if (IS_PTR(registers[pc->a])) {
-                lm_list_append((LmList*)UNBOX_PTR(registers[pc->a]), registers[pc->b]);
+        case LIR::LIR_Op::ListLen:
+            // .len() lowers to ListLen on strings too, which carry their length
+            if (lm_is_string(frame_[pc->a])) {
+                frame_[pc->dst] = make_i64(AS_STRING(frame_[pc->a])->length);
+            } else if (IS_PTR(frame_[pc->a])) {
+                frame_[pc->dst] = make_i64(lm_list_len((LmList*)UNBOX_PTR(frame_[pc->a])));
             }
             break;
-        case LIR::LIR_Op::ListLen:
-            if (IS_PTR(registers[pc->a])) {
-                registers[pc->dst] = make_i64(lm_list_len((LmList*)UNBOX_PTR(registers[pc->a])));
+        case LIR::LIR_Op::DictCreate:
+            frame_[pc->dst] = BOX_PTR(lm_dict_new(hash_boxed_value, cmp_boxed_value));
+            break;
+        case LIR::LIR_Op::DictSet:
+            // Index assignment lowers to DictSet whatever the container is
+            if (LmDict* dict = as_dict(frame_[pc->dst])) {
+                lm_dict_set(dict, frame_[pc->a], frame_[pc->b]);
+            } else if (LmList* list = as_list(frame_[pc->dst]); list && is_integer(frame_[pc->a])) {
+                lm_list_set(list, static_cast<uint64_t>(as_i64(frame_[pc->a])), frame_[pc->b]);
             }
             break;
+        case LIR::LIR_Op::DictGet: {
+            LmDict* dict = as_dict(frame_[pc->a]);
+            frame_[pc->dst] = dict ? lm_dict_get(dict, frame_[pc->b]) : VAL_NIL;
+            break;
+        }
+        case LIR::LIR_Op::DictHas: {
+            LmDict* dict = as_dict(frame_[pc->a]);
+            frame_[pc->dst] = dict && lm_dict_contains(dict, frame_[pc->b]) ? VAL_TRUE : VAL_FALSE;
+            break;
+        }
+        case LIR::LIR_Op::DictLen: {
+            // Pattern matching tests the length of values that may not be dicts
+            LmDict* dict = as_dict(frame_[pc->a]);
+            frame_[pc->dst] = dict ? make_i64(dict->size) : VAL_NIL;
+            break;
+        }
         case LIR::LIR_Op::TupleCreate:
-            registers[pc->dst] = BOX_PTR(lm_tuple_new(pc->a));
+            frame_[pc->dst] = BOX_PTR(lm_tuple_new(pc->imm));
             break;
         case LIR::LIR_Op::TupleSet:
-            if (IS_PTR(registers[pc->dst])) {
-                lm_tuple_set((LmTuple*)UNBOX_PTR(registers[pc->dst]), pc->a, registers[pc->b]);
+            if (IS_PTR(frame_[pc->dst])) {
+                lm_tuple_set((LmTuple*)UNBOX_PTR(frame_[pc->dst]), to_int(frame_[pc->a]), frame_[pc->b]);
             }
             break;
         case LIR::LIR_Op::TupleGet:
-            if (IS_PTR(registers[pc->a])) {
-                registers[pc->dst] = lm_tuple_get((LmTuple*)UNBOX_PTR(registers[pc->a]), pc->b);
+            if (IS_PTR(frame_[pc->a])) {
+                ObjHeader* h = (ObjHeader*)UNBOX_PTR(frame_[pc->a]);
+                uint64_t index = to_int(frame_[pc->b]);
+                // Destructuring lowers list element access to TupleGet as well
+                frame_[pc->dst] = (h->type_id == TYPE_LIST)
+                    ? lm_list_get((LmList*)h, index)
+                    : lm_tuple_get((LmTuple*)h, index);
+            }
+            break;
+        case LIR::LIR_Op::TupleLen:
+            // Like TupleGet, also used on lists by destructuring patterns
+            if (IS_PTR(frame_[pc->a])) {
+                ObjHeader* h = (ObjHeader*)UNBOX_PTR(frame_[pc->a]);
+                frame_[pc->dst] = (h->type_id == TYPE_LIST) ? make_i64(lm_list_len((LmList*)h))
+                                : (h->type_id == TYPE_TUPLE) ? make_i64(lm_tuple_size((LmTuple*)h))
+                                : VAL_NIL;
+            } else {
+                frame_[pc->dst] = VAL_NIL;
             }
             break;
         default:
@@ -14,34 +14,34 @@ void RegisterVM::execute_concurrency(const LIR::LIR_Inst* pc) {
         case LIR::LIR_Op::ChannelAlloc: {
             auto channel = std::make_unique<LM::Backend::Channel>(pc->a);
             channels.push_back(std::move(channel));
-            registers[pc->dst] = BOX_PTR(channels.back().get());
+            frame_[pc->dst] = BOX_PTR(channels.back().get());
             break;
         }
         case LIR::LIR_Op::ChannelSend: {
-            if (IS_PTR(registers[pc->a])) {
-                LM::Backend::Channel* channel = (LM::Backend::Channel*)UNBOX_PTR(registers[pc->a]);
-                channel->send(registers[pc->b], get_current_fiber());
+            if (IS_PTR(frame_[pc->a])) {
+                LM::Backend::Channel* channel = (LM::Backend::Channel*)UNBOX_PTR(frame_[pc->a]);
+                channel->send(frame_[pc->b], get_current_fiber());
             }
             break;
         }
         case LIR::LIR_Op::ChannelRecv: {
-            if (IS_PTR(registers[pc->a])) {
-                LM::Backend::Channel* channel = (LM::Backend::Channel*)UNBOX_PTR(registers[pc->a]);
-                registers[pc->dst] = channel->recv(get_current_fiber());
+            if (IS_PTR(frame_[pc->a])) {
+                LM::Backend::Channel* channel = (LM::Backend::Channel*)UNBOX_PTR(frame_[pc->a]);
+                frame_[pc->dst] = channel->recv(get_current_fiber());
             }
             break;
         }
         case LIR::LIR_Op::ChannelClose: {
-            if (IS_PTR(registers[pc->a])) {
-                LM::Backend::Channel* channel = (LM::Backend::Channel*)UNBOX_PTR(registers[pc->a]);
+            if (IS_PTR(frame_[pc->a])) {
+                LM::Backend::Channel* channel = (LM::Backend::Channel*)UNBOX_PTR(frame_[pc->a]);
                 channel->close();
             }
             break;
         }
         case LIR::LIR_Op::ChannelHasData: {
-            if (IS_PTR(registers[pc->a])) {
-                LM::Backend::Channel* channel = (LM::Backend::Channel*)UNBOX_PTR(registers[pc->a]);
-                registers[pc->dst] = channel->has_data() ? VAL_TRUE : VAL_FALSE;
+            if (IS_PTR(frame_[pc->a])) {
+                LM::Backend::Channel* channel = (LM::Backend::Channel*)UNBOX_PTR(frame_[pc->a]);
+                frame_[pc->dst] = channel->has_data() ? VAL_TRUE : VAL_FALSE;
             }
             break;
         }
@@ -9,27 +9,29 @@ namespace Register {
 
 void RegisterVM::execute_frames(const LIR::LIR_Inst* pc) {
     switch (pc->op) {
-        case LIR::LIR_Op::NewFrame:
-            registers[pc->dst] = BOX_PTR(lm_frame_alloc(pc->type_name.c_str(), pc->a));
-            break;
-        case LIR::LIR_Op::FrameGetField:
-            if (IS_PTR(registers[pc->a])) {
-                registers[pc->dst] = lm_frame_get_field(UNBOX_PTR(registers[pc->a]), pc->b);
-            }
-            break;
         case LIR::LIR_Op::FrameSetField:
-            if (IS_PTR(registers[pc->dst])) {
-                lm_frame_set_field(UNBOX_PTR(registers[pc->dst]), pc->a, registers[pc->b]);
+            if (IS_PTR(frame_[pc->dst])) {
+                lm_frame_set_field(UNBOX_PTR(frame_[pc->dst]), pc->a, frame_[pc->b]);
             }
             break;
         case LIR::LIR_Op::FrameGetFieldAtomic:
-            if (IS_PTR(registers[pc->a])) {
-                registers[pc->dst] = lm_frame_get_field_atomic(UNBOX_PTR(registers[pc->a]), pc->b);
+            if (IS_PTR(frame_[pc->a])) {
+                frame_[pc->dst] = lm_frame_get_field_atomic(UNBOX_PTR(frame_[pc->a]), pc->b);
             }
             break;
         case LIR::LIR_Op::FrameSetFieldAtomic:
-            if (IS_PTR(registers[pc->dst])) {
-                lm_frame_set_field_atomic(UNBOX_PTR(registers[pc->dst]), pc->a, registers[pc->b]);
+            if (IS_PTR(frame_[pc->dst])) {
+                lm_frame_set_field_atomic(UNBOX_PTR(frame_[pc->dst]), pc->a, frame_[pc->b]);
+            }
+            break;
+        case LIR::LIR_Op::FrameFieldAtomicAdd:
+            if (IS_PTR(frame_[pc->dst])) {
+                lm_frame_field_atomic_add(UNBOX_PTR(frame_[pc->dst]), pc->a, frame_[pc->b]);
+            }
+            break;
+        case LIR::LIR_Op::FrameFieldAtomicSub:
+            if (IS_PTR(frame_[pc->dst])) {
+                lm_frame_field_atomic_sub(UNBOX_PTR(frame_[pc->dst]), pc->a, frame_[pc->b]);
             }
             break;
         default:
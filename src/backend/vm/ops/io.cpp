@@ -1,4 +1,6 @@
 #include "../register.hh"
+#include "../../../runtime/runtime_format.h"
+#include "../../../runtime/runtime_string.h"
 #include <iostream>
 
 namespace LM {
@@ -6,20 +8,29 @@ namespace Backend {
 namespace VM {
 namespace Register {
 
+// Strings and numbers are written from their own characters or a stack
+// buffer, without building a temporary string
 void RegisterVM::execute_io(const LIR::LIR_Inst* pc) {
     switch (pc->op) {
         case LIR::LIR_Op::PrintInt:
         case LIR::LIR_Op::PrintUint:
-            std::cout << to_int(registers[pc->a]) << std::endl;
-            break;
         case LIR::LIR_Op::PrintFloat:
-            std::cout << to_float(registers[pc->a]) << std::endl;
+        case LIR::LIR_Op::PrintString: {
+            const RegisterValue value = frame_[pc->a];
+            char scratch[LM_NUMBER_CHARS];
+            size_t length;
+            if (lm_is_string(value)) {
+                std::cout.write(AS_STRING(value)->data, AS_STRING(value)->length);
+            } else if (lm_format_scalar(value, scratch, &length)) {
+                std::cout.write(scratch, static_cast<std::streamsize>(length));
+            } else {
+                std::cout << to_string(value);
+            }
+            std::cout << std::endl;
             break;
+        }
         case LIR::LIR_Op::PrintBool:
-            std::cout << (to_bool(registers[pc->a]) ? "true" : "false") << std::endl;
-            break;
-        case LIR::LIR_Op::PrintString:
-            std::cout << to_string(registers[pc->a]) << std::endl;
+            std::cout << (to_bool(frame_[pc->a]) ? "true" : "false") << std::endl;
             break;
         default:
             break;
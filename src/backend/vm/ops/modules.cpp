@@ -8,10 +8,10 @@ namespace Register {
 void RegisterVM::execute_modules(const LIR::LIR_Inst* pc) {
     switch (pc->op) {
         case LIR::LIR_Op::LoadGlobal:
-            registers[pc->dst] = globals_[pc->func_name];
+            frame_[pc->dst] = globals_[pc->func_index];
             break;
         case LIR::LIR_Op::StoreGlobal:
-            globals_[pc->func_name] = registers[pc->a];
+            globals_[pc->func_index] = frame_[pc->a];
             break;
         default:
             break;
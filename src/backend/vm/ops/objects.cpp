@@ -12,58 +12,62 @@ void RegisterVM::execute_objects(const LIR::LIR_Inst* pc) {
         case LIR::LIR_Op::MakeEnum: {
             // In the unified model, Enum can be a specialized LmFrame or its own type.
             // For now, let's use a Frame with 2 fields: [tag, payload]
-            void* enum_obj = lm_frame_alloc("__lir_internal_enum__", 2);
-            lm_frame_set_field(enum_obj, 0, make_i64(pc->a));
-            lm_frame_set_field(enum_obj, 1, registers[pc->b]);
-            registers[pc->dst] = BOX_PTR(enum_obj);
+            static const LmFrameType* enum_type = lm_frame_type("__lir_internal_enum__", 2);
+            void* enum_obj = lm_frame_new(enum_type);
+            // The tag is in imm and the payload in a, where r0 means none
+            lm_frame_set_field(enum_obj, 0, make_i64(pc->imm));
+            lm_frame_set_field(enum_obj, 1, pc->a != 0 ? frame_[pc->a] : VAL_NIL);
+            frame_[pc->dst] = BOX_PTR(enum_obj);
             break;
         }
         case LIR::LIR_Op::ConstructError: {
             // Error union with [is_error=1, payload]
-            void* err_obj = lm_frame_alloc("__lir_internal_error__", 2);
+            static const LmFrameType* error_type = lm_frame_type("__lir_internal_error__", 2);
+            void* err_obj = lm_frame_new(error_type);
             lm_frame_set_field(err_obj, 0, make_i64(1));
-            lm_frame_set_field(err_obj, 1, registers[pc->a]);
-            registers[pc->dst] = BOX_PTR(err_obj);
+            lm_frame_set_field(err_obj, 1, frame_[pc->a]);
+            frame_[pc->dst] = BOX_PTR(err_obj);
             break;
         }
         case LIR::LIR_Op::ConstructOk: {
             // Error union with [is_error=0, payload]
-            void* ok_obj = lm_frame_alloc("__lir_internal_ok__", 2);
+            static const LmFrameType* ok_type = lm_frame_type("__lir_internal_ok__", 2);
+            void* ok_obj = lm_frame_new(ok_type);
             lm_frame_set_field(ok_obj, 0, make_i64(0));
-            lm_frame_set_field(ok_obj, 1, registers[pc->a]);
-            registers[pc->dst] = BOX_PTR(ok_obj);
+            lm_frame_set_field(ok_obj, 1, frame_[pc->a]);
+            frame_[pc->dst] = BOX_PTR(ok_obj);
             break;
         }
         case LIR::LIR_Op::IsError: {
-            if (IS_PTR(registers[pc->a])) {
-                void* obj = UNBOX_PTR(registers[pc->a]);
+            if (IS_PTR(frame_[pc->a])) {
+                void* obj = UNBOX_PTR(frame_[pc->a]);
                 LmValue is_err = lm_frame_get_field(obj, 0);
-                registers[pc->dst] = (as_i64(is_err) != 0) ? VAL_TRUE : VAL_FALSE;
+                frame_[pc->dst] = (as_i64(is_err) != 0) ? VAL_TRUE : VAL_FALSE;
             } else {
-                registers[pc->dst] = VAL_FALSE;
+                frame_[pc->dst] = VAL_FALSE;
             }
             break;
         }
         case LIR::LIR_Op::Unwrap: {
-            if (IS_PTR(registers[pc->a])) {
-                void* obj = UNBOX_PTR(registers[pc->a]);
-                registers[pc->dst] = lm_frame_get_field(obj, 1);
+            if (IS_PTR(frame_[pc->a])) {
+                void* obj = UNBOX_PTR(frame_[pc->a]);
+                frame_[pc->dst] = lm_frame_get_field(obj, 1);
             } else {
-                registers[pc->dst] = registers[pc->a];
+                frame_[pc->dst] = frame_[pc->a];
             }
             break;
         }
         case LIR::LIR_Op::GetTag: {
-            if (IS_PTR(registers[pc->a])) {
-                void* obj = UNBOX_PTR(registers[pc->a]);
-                registers[pc->dst] = lm_frame_get_field(obj, 0);
+            if (IS_PTR(frame_[pc->a])) {
+                void* obj = UNBOX_PTR(frame_[pc->a]);
+                frame_[pc->dst] = lm_frame_get_field(obj, 0);
             }
             break;
         }
         case LIR::LIR_Op::GetPayload: {
-            if (IS_PTR(registers[pc->a])) {
-                void* obj = UNBOX_PTR(registers[pc->a]);
-                registers[pc->dst] = lm_frame_get_field(obj, 1);
+            if (IS_PTR(frame_[pc->a])) {
+                void* obj = UNBOX_PTR(frame_[pc->a]);
+                frame_[pc->dst] = lm_frame_get_field(obj, 1);
             }
             break;
         }
@@ -3,89 +3,117 @@
 #include "../../../lir/builtin_functions.hh"
 #include "../../../runtime/runtime.h"
 #include "../../../runtime/runtime_value.h"
+#include "../../../runtime/runtime_tuple.h"
+#include "../../../runtime/runtime_kernels.h"
 
 namespace LM {
 namespace Backend {
 namespace VM {
 namespace Register {
 
-void RegisterVM::execute_calls(const LIR::LIR_Inst* pc) {
-    switch (pc->op) {
-        case LIR::LIR_Op::Call: {
-            auto& func_manager = LIR::LIRFunctionManager::getInstance();
-            if (func_manager.hasFunction(pc->func_name)) {
-                auto func = func_manager.getFunction(pc->func_name);
-                std::vector<RegisterValue> arg_vals;
-                for (auto arg_reg : pc->call_args) arg_vals.push_back(registers[arg_reg]);
-
-                auto saved_registers = registers;
-                const LIR::LIR_Function* saved_func = current_function_;
-
-                registers.assign(registers.size(), VAL_NIL);
-                for (size_t i = 0; i < arg_vals.size() && i < registers.size(); ++i) {
-                    registers[i] = arg_vals[i];
-                }
-
-                LIR::LIR_Function temp_wrapper(func->getName(), static_cast<uint32_t>(arg_vals.size()));
-                temp_wrapper.instructions = func->getInstructions();
-                current_function_ = &temp_wrapper;
-
-                execute_instructions(temp_wrapper, 0, temp_wrapper.instructions.size());
-
-                RegisterValue return_value = registers[0];
-
-                registers = saved_registers;
-                current_function_ = saved_func;
-                registers[pc->dst] = return_value;
-            } else if (pc->func_name == "assert") {
-                bool condition = to_bool(registers[pc->call_args[0]]);
-                if (!condition) {
-                    std::string msg = "Assertion failed";
-                    if (pc->call_args.size() > 1) msg = to_string(registers[pc->call_args[1]]);
-                    std::cerr << msg << std::endl;
-                }
+static inline LmList* as_list(LmValue v) {
+    return IS_PTR(v) && ((ObjHeader*)UNBOX_PTR(v))->type_id == TYPE_LIST ? (LmList*)UNBOX_PTR(v) : nullptr;
+}
+
+RegisterValue* RegisterVM::push_frame(size_t size, LIR::Reg return_reg) {
+    if (call_frames_.size() >= MAX_CALL_DEPTH) {
+        return nullptr;
+    }
+
+    call_frames_.push_back({frame_base_, frame_size_, return_reg});
+
+    size_t base = frame_base_ + frame_size_;
+    if (base + size > registers.size()) {
+        // Growing the stack may move it; every frame is addressed by its base index
+        registers.resize(std::max(registers.size() * 2, base + size), VAL_NIL);
+    }
+
+    frame_base_ = base;
+    frame_size_ = size;
+    frame_ = registers.data() + base;
+    return frame_;
+}
+
+void RegisterVM::pop_frame() {
+    const CallFrame& caller = call_frames_.back();
+    frame_base_ = caller.base;
+    frame_size_ = caller.size;
+    frame_ = registers.data() + frame_base_;
+    LIR::Reg dst = caller.return_reg;
+    call_frames_.pop_back();
+    frame_[dst] = return_value_;
+}
+
+const RegisterValue* RegisterVM::gather_arguments(const LIR::Reg* args, size_t arg_count) {
+    call_values_.resize(arg_count);
+    for (size_t i = 0; i < arg_count; ++i) call_values_[i] = frame_[args[i]];
+    return call_values_.data();
+}
+
+// The arguments are values rather than caller registers: push_frame may grow
+// and move the register stack before they are copied in
+void RegisterVM::invoke_function(ExecutableFunction& callee, const RegisterValue* args, size_t arg_count, LIR::Reg dst) {
+    size_t size = std::max<size_t>({callee.register_count, arg_count, 1});
+    if (!push_frame(size, dst)) {
+        std::cerr << "Call stack overflow in " << callee.name << std::endl;
+        halted_ = true;
+        return;
+    }
+
+    std::copy(args, args + arg_count, frame_);
+    std::fill(frame_ + arg_count, frame_ + size, VAL_NIL);
+
+    return_value_ = VAL_NIL;
+    execute_instructions(callee, 0, callee.code.size());
+    pop_frame();
+}
+
+void RegisterVM::call_builtin(const CallSite& site, const LIR::Reg* args, LIR::Reg dst) {
+    switch (site.builtin) {
+        case CallBuiltin::Assert:
+            if (site.arg_count > 0 && !to_bool(frame_[args[0]])) {
+                std::string msg = "Assertion failed";
+                if (site.arg_count > 1) msg += ": " + to_string(frame_[args[1]]);
+                std::cerr << msg << std::endl;
             }
             break;
+        case CallBuiltin::Intern:
+            if (site.arg_count > 0) frame_[dst] = lm_string_intern_value(frame_[args[0]]);
+            break;
+        case CallBuiltin::ListKernel: {
+            // Calls with anything but a list first give nil
+            LmList* list = site.arg_count > 0 ? as_list(frame_[args[0]]) : nullptr;
+            RegisterValue arg = site.arg_count > 1 ? frame_[args[1]] : VAL_NIL;
+            frame_[dst] = list ? site.kernel(list, arg) : VAL_NIL;
+            break;
         }
+        case CallBuiltin::None:
+            break;
+    }
+}
+
+void RegisterVM::execute_calls(const LIR::LIR_Inst* pc) {
+    switch (pc->op) {
         case LIR::LIR_Op::CallIndirect: {
-            // Register a contains the function object (which currently is just the function pointer/name in our simplified model)
-            RegisterValue func_obj = registers[pc->a];
-            std::string func_name = "";
-            
-            if (IS_PTR(func_obj)) {
-                ObjHeader* h = (ObjHeader*)UNBOX_PTR(func_obj);
-                if (h->type_id == TYPE_BOX && ((LmBox*)h)->type == LM_BOX_STRING) {
-                    func_name = (char*)((LmBox*)h)->value.as_ptr;
-                }
+            // Register a holds a function handle, or a closure tuple (handle, captures...)
+            // whose tuple is passed as the trailing environment argument
+            RegisterValue callee = frame_[pc->a];
+
+            // Arguments arrive through preceding Param instructions
+            std::vector<RegisterValue> args;
+            args.swap(argument_stack);
+
+            if (IS_PTR(callee) && ((ObjHeader*)UNBOX_PTR(callee))->type_id == TYPE_TUPLE) {
+                LmTuple* closure = (LmTuple*)UNBOX_PTR(callee);
+                args.push_back(callee);
+                callee = closure->size > 0 ? closure->elements[0] : VAL_NIL;
             }
-            
-            if (!func_name.empty()) {
-                auto& func_manager = LIR::LIRFunctionManager::getInstance();
-                if (func_manager.hasFunction(func_name)) {
-                    auto func = func_manager.getFunction(func_name);
-                    std::vector<RegisterValue> arg_vals;
-                    for (auto arg_reg : pc->call_args) arg_vals.push_back(registers[arg_reg]);
-
-                    auto saved_registers = registers;
-                    const LIR::LIR_Function* saved_func = current_function_;
-
-                    registers.assign(registers.size(), VAL_NIL);
-                    for (size_t i = 0; i < arg_vals.size() && i < registers.size(); ++i) {
-                        registers[i] = arg_vals[i];
-                    }
-
-                    LIR::LIR_Function temp_wrapper(func->getName(), static_cast<uint32_t>(arg_vals.size()));
-                    temp_wrapper.instructions = func->getInstructions();
-                    current_function_ = &temp_wrapper;
-
-                    execute_instructions(temp_wrapper, 0, temp_wrapper.instructions.size());
-
-                    RegisterValue return_value = registers[0];
-
-                    registers = saved_registers;
-                    current_function_ = saved_func;
-                    registers[pc->dst] = return_value;
-                }
+
+            if (IS_FUNC(callee) && UNBOX_FUNC(callee) < program_.size()) {
+                invoke_function(program_[UNBOX_FUNC(callee)], args.data(), args.size(), pc->dst);
+            } else {
+                std::cerr << "Attempted to call a non-function value" << std::endl;
+                frame_[pc->dst] = VAL_NIL;
             }
             break;
         }
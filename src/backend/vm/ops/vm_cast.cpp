@@ -9,13 +9,13 @@ namespace Register {
 void RegisterVM::execute_cast(const LIR::LIR_Inst* pc) {
     switch (pc->op) {
         case LIR::LIR_Op::Cast: {
-            LmValue val = registers[pc->a];
+            LmValue val = frame_[pc->a];
             if (pc->result_type == LIR::Type::I64) {
-                registers[pc->dst] = make_i64(as_i64(val));
+                frame_[pc->dst] = make_i64(as_i64(val));
             } else if (pc->result_type == LIR::Type::F64) {
-                registers[pc->dst] = make_float(as_float(val));
+                frame_[pc->dst] = make_float(as_float(val));
             } else if (pc->result_type == LIR::Type::Bool) {
-                registers[pc->dst] = to_bool(val) ? VAL_TRUE : VAL_FALSE;
+                frame_[pc->dst] = to_bool(val) ? VAL_TRUE : VAL_FALSE;
             }
             break;
         }
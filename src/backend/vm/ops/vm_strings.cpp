@@ -10,32 +10,27 @@ namespace Register {
 
 void RegisterVM::execute_strings(const LIR::LIR_Inst* pc) {
     switch (pc->op) {
-        case LIR::LIR_Op::ToString: {
-            LmString s = lm_value_to_string(registers[pc->a]);
-            registers[pc->dst] = BOX_PTR(lm_box_string(s.data));
-            lm_string_free(s);
+        case LIR::LIR_Op::ToString:
+            // A decimal source carries its scale in imm
+            frame_[pc->dst] = pc->imm ? lm_decimal_to_string_object(frame_[pc->a], static_cast<int>(pc->imm))
+                                      : lm_value_to_string_object(frame_[pc->a]);
             break;
-        }
-        case LIR::LIR_Op::STR_CONCAT: {
-            LmString s1 = lm_value_to_string(registers[pc->a]);
-            LmString s2 = lm_value_to_string(registers[pc->b]);
-            LmString res = lm_string_concat(s1, s2);
-            registers[pc->dst] = BOX_PTR(lm_box_string(res.data));
-            lm_string_free(s1);
-            lm_string_free(s2);
-            lm_string_free(res);
+        case LIR::LIR_Op::STR_CONCAT:
+            frame_[pc->dst] = lm_string_concat_values(frame_[pc->a], frame_[pc->b]);
             break;
-        }
-        case LIR::LIR_Op::STR_FORMAT: {
-            LmString fmt = lm_value_to_string(registers[pc->a]);
-            LmString arg = lm_value_to_string(registers[pc->b]);
-            LmString res = lm_string_format(fmt, arg);
-            registers[pc->dst] = BOX_PTR(lm_box_string(res.data));
-            lm_string_free(fmt);
-            lm_string_free(arg);
-            lm_string_free(res);
+        case LIR::LIR_Op::STR_FORMAT:
+            frame_[pc->dst] = lm_string_format_values(frame_[pc->a], frame_[pc->b]);
+            break;
+        case LIR::LIR_Op::STR_BUILD:
+        case LIR::LIR_Op::STR_APPEND:
+            string_parts_.clear();
+            for (LIR::Reg arg : pc->call_args) string_parts_.push_back(frame_[arg]);
+            if (pc->op == LIR::LIR_Op::STR_BUILD) {
+                frame_[pc->dst] = lm_string_build(string_parts_.data(), string_parts_.size());
+            } else if (!string_parts_.empty()) {
+                frame_[pc->dst] = lm_string_append(string_parts_[0], string_parts_.data() + 1, string_parts_.size() - 1);
+            }
             break;
-        }
         default:
             break;
     }
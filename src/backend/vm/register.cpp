@@ -6,6 +6,7 @@
 #include "../../runtime/runtime.h"
 #include "../../runtime/runtime_list.h"
 #include "../../runtime/runtime_dict.h"
+#include "../../runtime/runtime_iter.h"
 #include "../../runtime/runtime_tuple.h"
 #include "../../runtime/runtime_value.h"
 #include <iostream>
@@ -14,6 +15,9 @@
 #include <cstdint>
 #include <string>
 #include <charconv>
+#include <algorithm>
+#include <array>
+#include <iterator>
 
 namespace LM {
 namespace Backend {
@@ -31,7 +35,7 @@ std::string RegisterVM::to_string(const RegisterValue& value) const {
 }
 
 bool RegisterVM::isErrorValue(LIR::Reg reg) const {
-    auto& value = registers[reg];
+    auto& value = frame_[reg];
     if (is_integer(value)) {
         int64_t int_val = as_i64(value);
         return int_val <= -1000000;
@@ -41,24 +45,35 @@ bool RegisterVM::isErrorValue(LIR::Reg reg) const {
 
 RegisterVM::RegisterVM() 
     : type_system(std::make_unique<TypeSystem>()) {
-    registers.resize(1024, VAL_NIL);
+    registers.resize(INITIAL_REGISTER_STACK, VAL_NIL);
+    frame_ = registers.data();
+    frame_size_ = registers.size();
     scheduler = std::make_unique<Scheduler>();
     current_time = 0;
-    current_function_ = nullptr;
     
     shared_variables.emplace(std::piecewise_construct, 
         std::forward_as_tuple("shared_counter"), 
         std::forward_as_tuple(0));
+
+    lm_gc_enable(&RegisterVM::gc_scan_roots, &RegisterVM::gc_request, this);
+}
+
+RegisterVM::~RegisterVM() {
+    lm_gc_disable(this);
 }
 
 void RegisterVM::reset() {
-    std::fill(registers.begin(), registers.end(), VAL_NIL);
+    registers.assign(INITIAL_REGISTER_STACK, VAL_NIL);
+    call_frames_.clear();
+    frame_ = registers.data();
+    frame_base_ = 0;
+    frame_size_ = registers.size();
+    return_value_ = VAL_NIL;
     argument_stack.clear();
     task_contexts.clear();
     channels.clear();
     scheduler = std::make_unique<Scheduler>();
     current_time = 0;
-    current_function_ = nullptr;
     
     shared_variables.clear();
     shared_variables.emplace(std::piecewise_construct, 
@@ -69,169 +84,800 @@ void RegisterVM::reset() {
     default_atomic.store(0);
     work_queues.clear();
     work_queue_counter.store(0);
-    instruction_count = 0;
+    steps_taken_ = 0;
+    halted_ = false;
+    arm_safepoints();
 }
 
-static __int128 parse_i128(const std::string& s) {
-    __int128 result = 0;
-    bool neg = false;
-    size_t i = 0;
-    if (s.empty()) return 0;
-    if (s[0] == '-') { neg = true; i = 1; }
-    for (; i < s.length(); i++) {
-        if (s[i] >= '0' && s[i] <= '9')
-            result = result * 10 + (s[i] - '0');
+// Dispatch uses computed goto (labels as values) where the compiler supports it:
+// every handler ends with its own indirect jump to the next handler, so the
+// branch predictor sees one jump site per opcode. Define LM_VM_SWITCH_DISPATCH
+// to force the portable switch loop.
+#if (defined(__GNUC__) || defined(__clang__)) && !defined(LM_VM_SWITCH_DISPATCH)
+#define LM_VM_THREADED 1
+#endif
+
+void RegisterVM::set_function_table(std::shared_ptr<const LIR::FunctionTable> table) {
+    function_table_ = std::move(table);
+    globals_.assign(function_table_->global_count(), VAL_NIL);
+
+    // Lower every function to its executable image once, before anything runs
+    program_.clear();
+    program_.reserve(function_table_->size());
+    for (size_t i = 0; i < function_table_->size(); ++i) {
+        const auto& linked = (*function_table_)[static_cast<uint32_t>(i)];
+        program_.push_back(lower_function(linked.name(), linked.owner->getInstructions(),
+                                          linked.register_count, linked.param_count,
+                                          constant_pool_, superinstructions_));
     }
-    return neg ? -result : result;
 }
 
-static unsigned __int128 parse_u128(const std::string& s) {
-    unsigned __int128 result = 0;
-    for (size_t i = 0; i < s.length(); i++) {
-        if (s[i] >= '0' && s[i] <= '9')
-            result = result * 10 + (s[i] - '0');
+void RegisterVM::set_execution_limits(const ExecutionLimits& limits) {
+    limits_ = limits;
+    deadline_ = std::chrono::steady_clock::now() + std::chrono::milliseconds(limits.timeout_ms);
+    steps_taken_ = 0;
+    halted_ = false;
+    arm_safepoints();
+}
+
+void RegisterVM::arm_safepoints() {
+    // Without a timeout the clock is never read, so the slice only has to end
+    // at the step limit
+    uint64_t slice = limits_.timeout_ms ? TIMEOUT_CHECK_INTERVAL : UINT64_MAX;
+    if (limits_.max_steps) slice = std::min(slice, limits_.max_steps - steps_taken_ + 1);
+    step_slice_ = steps_left_ = slice;
+    if (lm_gc_pending()) interrupt_at_safepoint();
+}
+
+// Slow path of a safepoint, taken when the current slice is used up. Returns
+// false when execution has to stop; the VM stays halted so that every active
+// frame unwinds at its next safepoint or call return.
+bool RegisterVM::safepoint(const ExecutableFunction& function, const Instr* pc) {
+    if (lm_gc_pending()) lm_gc_collect();
+    if (!halted_) {
+        steps_taken_ += step_slice_;
+        if (limits_.max_steps && steps_taken_ > limits_.max_steps) {
+            std::cerr << "Step limit of " << limits_.max_steps << " exceeded"
+                      << location_suffix(function, pc) << std::endl;
+            halted_ = true;
+        } else if (limits_.timeout_ms && std::chrono::steady_clock::now() >= deadline_) {
+            std::cerr << "Timeout of " << limits_.timeout_ms << " ms exceeded"
+                      << location_suffix(function, pc) << std::endl;
+            halted_ = true;
+        } else {
+            arm_safepoints();
+            return true;
+        }
     }
-    return result;
+    steps_left_ = 1;
+    return false;
 }
 
-void RegisterVM::execute_instructions(const LIR::LIR_Function& function, size_t start_pc, size_t end_pc) {
-    const LIR::LIR_Inst* pc = function.instructions.data() + start_pc;
-    const LIR::LIR_Inst* end = function.instructions.data() + end_pc;
-    
-    while (pc < end) {
-        instruction_count++;
-        if (instruction_count > MAX_INSTRUCTIONS) { std::cerr << "Instruction limit exceeded" << std::endl; return; }
-        switch (pc->op) {
-            case LIR::LIR_Op::LoadConst: {
-                // Use the more robust constant loader logic
-                if (pc->const_val == VAL_NIL) {
-                    registers[pc->dst] = VAL_NIL;
-                } else {
-                    // Assuming const_val is already an LmValue/RegisterValue
-                    registers[pc->dst] = pc->const_val;
-                }
-                break;
+// End the current slice at the next safepoint. The slice is shortened to the
+// steps taken so far plus that one, so step accounting stays exact.
+void RegisterVM::interrupt_at_safepoint() {
+    step_slice_ -= steps_left_ - 1;
+    steps_left_ = 1;
+}
+
+// Called by the runtime when allocation crosses the collection threshold
+void RegisterVM::gc_request(void* vm) {
+    static_cast<RegisterVM*>(vm)->interrupt_at_safepoint();
+}
+
+void RegisterVM::gc_scan_roots(void* vm) {
+    static_cast<const RegisterVM*>(vm)->scan_gc_roots();
+}
+
+// At a safepoint every live value is in one of these; values held in C++
+// locals only exist inside a single handler, which never reaches a safepoint
+void RegisterVM::scan_gc_roots() const {
+    lm_gc_mark_values(registers.data(), std::min(registers.size(), frame_base_ + frame_size_));
+    lm_gc_mark_values(globals_.data(), globals_.size());
+    lm_gc_mark_values(constant_pool_.objects().data(), constant_pool_.objects().size());
+    lm_gc_mark_values(argument_stack.data(), argument_stack.size());
+    lm_gc_mark_value(return_value_);
+    for (const auto& channel : channels) {
+        for (RegisterValue value : channel->buffer) lm_gc_mark_value(value);
+    }
+    for (const auto& task : task_contexts) {
+        lm_gc_mark_value(task->channel_ptr);
+        for (const auto& [slot, value] : task->fields) lm_gc_mark_value(value);
+    }
+}
+
+// The escape analysis proved that region results are dead by the time the
+// enclosing RegionExit runs
+void RegisterVM::execute_allocation(const LIR::LIR_Inst* pc) {
+    if (pc->region) lm_region_allocate(true);
+    switch (pc->op) {
+        case LIR::LIR_Op::ListCreate:
+        case LIR::LIR_Op::TupleCreate:
+            execute_collections(pc);
+            break;
+        default:
+            execute_strings(pc);
+            break;
+    }
+    if (pc->region) lm_region_allocate(false);
+}
+
+void RegisterVM::print_gc_stats(std::ostream& out) const {
+    LmGcStats stats = lm_gc_stats();
+    out << "=== GC stats ===\n"
+        << "collections: " << stats.collections << "\n"
+        << "pause total: " << stats.total_pause_ns / 1000 << " us, max: "
+        << stats.max_pause_ns / 1000 << " us\n"
+        << "reclaimed: " << stats.bytes_freed << " bytes in " << stats.objects_freed << " objects\n"
+        << "heap: " << stats.heap_bytes << " bytes, peak " << stats.peak_heap_bytes << " bytes\n"
+        << "regions: " << stats.region_objects << " objects released\n";
+}
+
+void RegisterVM::enable_op_pair_profile() {
+#ifndef LM_VM_THREADED
+    // The switch loop has no spare dispatch table to route through a
+    // counter, and a check per instruction would tax every run
+    std::cerr << "Opcode-pair profiling needs computed-goto dispatch (built with LM_VM_SWITCH_DISPATCH)" << std::endl;
+    return;
+#endif
+    op_pairs_ = std::make_unique<std::array<uint64_t, 256 * 256>>();
+    op_pairs_->fill(0);
+    superinstructions_ = false;
+}
+
+void RegisterVM::print_op_pair_profile(std::ostream& out) const {
+    if (!op_pairs_) return;
+
+    std::vector<std::pair<uint64_t, size_t>> pairs;
+    uint64_t total = 0;
+    for (size_t i = 0; i < op_pairs_->size(); ++i) {
+        if ((*op_pairs_)[i] == 0) continue;
+        pairs.emplace_back((*op_pairs_)[i], i);
+        total += (*op_pairs_)[i];
+    }
+    std::sort(pairs.begin(), pairs.end(), [](const auto& x, const auto& y) { return x.first > y.first; });
+
+    out << "=== Opcode pairs (" << total << " executed) ===\n";
+    for (const auto& [count, index] : pairs) {
+        out << count << "\t" << LIR::lir_op_to_string(static_cast<LIR::LIR_Op>(index / 256))
+            << " -> " << LIR::lir_op_to_string(static_cast<LIR::LIR_Op>(index % 256)) << "\n";
+    }
+}
+
+std::string RegisterVM::location_suffix(const ExecutableFunction& function, const Instr* pc) const {
+    const LIR::LIR_SourceLoc* loc = function.location_at(static_cast<uint32_t>(pc - function.code.data()));
+    return loc ? " at " + loc->to_string() : "";
+}
+
+// Float operands the specialized F64 handlers can read directly: immediate
+// doubles and heap floats
+static inline bool is_float_operand(LmValue v) {
+    return IS_FLOAT_IMM(v) || (IS_PTR(v) && ((ObjHeader*)UNBOX_PTR(v))->type_id == TYPE_FLOAT);
+}
+
+static inline double float_operand_value(LmValue v) {
+    return IS_FLOAT_IMM(v) ? UNBOX_FLOAT(v) : ((ObjFloat*)UNBOX_PTR(v))->value;
+}
+
+// make_float without the call; only doubles outside the immediate range allocate
+static inline LmValue float_result(double d) {
+    LmValue v;
+    return try_box_float(d, &v) ? v : lm_alloc_float(d);
+}
+
+static inline bool is_list_object(LmValue v) {
+    return IS_PTR(v) && ((ObjHeader*)UNBOX_PTR(v))->type_id == TYPE_LIST;
+}
+
+static inline bool is_frame_object(LmValue v) {
+    return IS_PTR(v) && ((ObjHeader*)UNBOX_PTR(v))->type_id == TYPE_FRAME;
+}
+
+// Typed lists hand out SMIs, immediate floats and bools without a call
+static inline LmValue list_element(const LmList* list, uint64_t index) {
+    if (index >= list->size) return VAL_NIL;
+    switch (list->kind) {
+        case LM_LIST_VALUES:
+            return list->values[index];
+        case LM_LIST_I64:
+            if (fits_smi_i64(list->ints[index])) return BOX_INT(list->ints[index]);
+            return make_i64(list->ints[index]);
+        case LM_LIST_F64:
+            return float_result(list->floats[index]);
+        case LM_LIST_BOOL:
+            return list->bools[index] ? VAL_TRUE : VAL_FALSE;
+    }
+    return VAL_NIL;
+}
+
+// Appends in place when the element has the list's representation and there
+// is room, otherwise leaves growth and representation changes to the runtime
+static inline void list_append(LmList* list, LmValue element) {
+    if (list->size < list->capacity) {
+        if (list->kind == LM_LIST_I64 && IS_INT(element)) {
+            list->ints[list->size++] = UNBOX_INT(element);
+            return;
+        }
+        if (list->kind == LM_LIST_F64 && IS_FLOAT_IMM(element)) {
+            list->floats[list->size++] = UNBOX_FLOAT(element);
+            return;
+        }
+    }
+    lm_list_append(list, element);
+}
+
+// Element of a list or tuple, nil for anything else or an index out of range
+static LmValue index_value(LmValue container, LmValue index) {
+    if (!IS_PTR(container) || !is_integer(index)) return VAL_NIL;
+    ObjHeader* h = (ObjHeader*)UNBOX_PTR(container);
+    if (h->type_id == TYPE_LIST) return list_element((LmList*)h, static_cast<uint64_t>(as_i64(index)));
+    if (h->type_id == TYPE_TUPLE) return lm_tuple_get((LmTuple*)h, static_cast<uint64_t>(as_i64(index)));
+    return VAL_NIL;
+}
+
+#ifdef LM_VM_THREADED
+using DispatchTable = std::array<void*, 256>;
+
+struct DispatchEntry {
+    LIR::LIR_Op op;
+    void* target;
+};
+
+// Handler addresses by opcode; opcodes without an entry go to fallback
+static DispatchTable make_dispatch_table(void* fallback, const DispatchEntry* entries, size_t count) {
+    DispatchTable table;
+    table.fill(fallback);
+    for (size_t i = 0; i < count; ++i) table[static_cast<uint8_t>(entries[i].op)] = entries[i].target;
+    return table;
+}
+#endif
+
+void RegisterVM::execute_instructions(ExecutableFunction& function, size_t start_pc, size_t end_pc) {
+    Instr* const code = function.code.data();
+    const LmValue* const constants = function.constants.data();
+    const LIR::LIR_Inst* const extended = function.extended.data();
+    Instr* pc = code + start_pc;
+    Instr* const end = code + end_pc;
+    RegisterValue* fp = frame_;
+
+#ifdef LM_VM_THREADED
+    // The handler list is constant data; the tables are function-local
+    // statics the first call fills once, under the compiler's initialization
+    // guard, and they never change afterwards
+#define VM_LABEL(name) {LIR::LIR_Op::name, &&op_##name},
+    static const DispatchEntry handlers[] = {
+        VM_LABEL(Mov) VM_LABEL(LoadConst)
+        VM_LABEL(Add) VM_LABEL(Sub) VM_LABEL(Mul) VM_LABEL(Div)
+        VM_LABEL(Mod) VM_LABEL(Neg) VM_LABEL(DecAdd) VM_LABEL(DecSub) VM_LABEL(DecMul)
+        VM_LABEL(DecDiv) VM_LABEL(DecMod) VM_LABEL(DecNeg) VM_LABEL(DecRescale)
+        VM_LABEL(CmpEQ) VM_LABEL(CmpNEQ) VM_LABEL(CmpLT) VM_LABEL(CmpLE) VM_LABEL(CmpGT) VM_LABEL(CmpGE)
+        VM_LABEL(Jump) VM_LABEL(JumpIf) VM_LABEL(JumpIfFalse)
+        VM_LABEL(Call) VM_LABEL(CallVoid) VM_LABEL(CallIndirect) VM_LABEL(CallBuiltin)
+        VM_LABEL(Param) VM_LABEL(Return) VM_LABEL(Ret)
+        VM_LABEL(ListCreate) VM_LABEL(ListAppend) VM_LABEL(ListLen) VM_LABEL(ListIndex)
+        VM_LABEL(DictCreate) VM_LABEL(DictSet) VM_LABEL(DictGet) VM_LABEL(DictHas) VM_LABEL(DictLen)
+        VM_LABEL(TupleCreate) VM_LABEL(TupleSet) VM_LABEL(TupleGet) VM_LABEL(TupleLen)
+        VM_LABEL(IterBegin) VM_LABEL(IterNext) VM_LABEL(IterKey) VM_LABEL(IterValue)
+        VM_LABEL(NewFrame) VM_LABEL(ConstructError) VM_LABEL(ConstructOk) VM_LABEL(IsError) VM_LABEL(Unwrap)
+        VM_LABEL(FrameGetField) VM_LABEL(FrameSetField) VM_LABEL(FrameGetFieldAtomic) VM_LABEL(FrameSetFieldAtomic)
+        VM_LABEL(FrameFieldAtomicAdd) VM_LABEL(FrameFieldAtomicSub)
+        VM_LABEL(PrintInt) VM_LABEL(PrintUint) VM_LABEL(PrintFloat) VM_LABEL(PrintBool) VM_LABEL(PrintString)
+        VM_LABEL(And) VM_LABEL(Or) VM_LABEL(Xor)
+        VM_LABEL(ChannelAlloc) VM_LABEL(ChannelSend) VM_LABEL(ChannelOffer) VM_LABEL(ChannelRecv)
+        VM_LABEL(ChannelPoll) VM_LABEL(ChannelClose) VM_LABEL(ChannelHasData)
+        VM_LABEL(LoadGlobal) VM_LABEL(StoreGlobal)
+        VM_LABEL(MakeEnum) VM_LABEL(GetTag) VM_LABEL(GetPayload)
+        VM_LABEL(ToString) VM_LABEL(STR_CONCAT) VM_LABEL(STR_FORMAT) VM_LABEL(STR_BUILD) VM_LABEL(STR_APPEND)
+        VM_LABEL(Cast)
+        VM_LABEL(AddI64) VM_LABEL(SubI64) VM_LABEL(MulI64) VM_LABEL(DivI64)
+        VM_LABEL(CmpEqI64) VM_LABEL(CmpNeI64) VM_LABEL(CmpLtI64) VM_LABEL(CmpLeI64) VM_LABEL(CmpGtI64) VM_LABEL(CmpGeI64)
+        VM_LABEL(AddF64) VM_LABEL(SubF64) VM_LABEL(MulF64) VM_LABEL(DivF64)
+        VM_LABEL(ListIndexI64) VM_LABEL(FrameGetFieldInline)
+        VM_LABEL(RegionEnter) VM_LABEL(RegionExit)
+        VM_LABEL(CmpLtI64JumpIfFalse) VM_LABEL(CmpEqI64JumpIfFalse)
+        VM_LABEL(LoadConstAddI64) VM_LABEL(LoadConstSubI64) VM_LABEL(JumpCmpLtI64)
+    };
+#undef VM_LABEL
+    static const DispatchTable dispatch_table = make_dispatch_table(&&op_Unhandled, handlers, std::size(handlers));
+    static const DispatchTable profile_table = make_dispatch_table(&&op_Profile, nullptr, 0);
+    void* const* const table = op_pairs_ ? profile_table.data() : dispatch_table.data();
+
+#define VM_DISPATCH() goto *table[pc->op]
+#define VM_CASE(name) op_##name:
+#define VM_DEFAULT op_Unhandled:
+#else
+#define VM_DISPATCH() goto dispatch
+#define VM_CASE(name) case static_cast<uint8_t>(LIR::LIR_Op::name):
+#define VM_DEFAULT default:
+#endif
+
+// Advance to the next instruction, or to an absolute target for jumps
+#define VM_GOTO(target) do { \
+        pc = (target); \
+        if (pc >= end) return; \
+        VM_DISPATCH(); \
+    } while (0)
+#define VM_NEXT() VM_GOTO(pc + 1)
+// Budget, timeout and halt checks happen only at safepoints: function entry
+// and backward branches. Straight-line code never counts anything.
+#define VM_SAFEPOINT() do { \
+        if (--steps_left_ == 0 && !safepoint(function, pc)) return; \
+    } while (0)
+#define VM_BRANCH(target) do { \
+        Instr* branch_target = (target); \
+        if (branch_target <= pc) VM_SAFEPOINT(); \
+        VM_GOTO(branch_target); \
+    } while (0)
+// Out-of-line handlers may call back into the VM, which can move the register stack
+#define VM_RELOAD() (fp = frame_)
+// A callee that hit a limit leaves the VM halted; the caller unwinds too
+#define VM_AFTER_CALL() do { \
+        if (halted_) return; \
+        VM_RELOAD(); \
+    } while (0)
+// Cold opcodes run from the full LIR instruction kept in the side table
+#define VM_EXTENDED() (extended + pc->b)
+// Generic instructions try to rewrite themselves while the site has budget left
+#define VM_QUICKEN(x, y) do { if (pc->aux < QUICKEN_BUDGET) quicken(*pc, (x), (y)); } while (0)
+// A failed guard in a quickened instruction puts the generic opcode back
+#define VM_DEOPT(generic) deoptimize(*pc, LIR::LIR_Op::generic)
+#define VM_CMP(cmp) do { \
+        LmValue x = fp[pc->a], y = fp[pc->b]; \
+        VM_QUICKEN(x, y); \
+        fp[pc->dst] = numeric_compare(x, y) cmp 0 ? VAL_TRUE : VAL_FALSE; \
+    } while (0)
+// SMI comparison on the tagged words; ordering is preserved because both carry TAG_INT
+#define VM_CMP_I64(cmp, generic) do { \
+        LmValue x = fp[pc->a], y = fp[pc->b]; \
+        bool result; \
+        if (IS_INT(x) && IS_INT(y)) { \
+            result = static_cast<int64_t>(x) cmp static_cast<int64_t>(y); \
+        } else { \
+            VM_DEOPT(generic); \
+            result = numeric_compare(x, y) cmp 0; \
+        } \
+        fp[pc->dst] = result ? VAL_TRUE : VAL_FALSE; \
+    } while (0)
+// Float arithmetic on two floats, anything else takes the generic path
+#define VM_ARITH_F64(op, generic, generic_fn) do { \
+        LmValue x = fp[pc->a], y = fp[pc->b]; \
+        if (is_float_operand(x) && is_float_operand(y)) { \
+            fp[pc->dst] = float_result(float_operand_value(x) op float_operand_value(y)); \
+        } else { \
+            VM_DEOPT(generic); \
+            fp[pc->dst] = generic_fn(x, y); \
+        } \
+    } while (0)
+// Compare-and-branch on the pair starting at test (a comparison followed by
+// JumpIfFalse on its result); the comparison's register is still written
+#define VM_CMP_BRANCH_I64(cmp, test) do { \
+        Instr* t = (test); \
+        LmValue x = fp[t->a], y = fp[t->b]; \
+        bool result = IS_INT(x) && IS_INT(y) ? static_cast<int64_t>(x) cmp static_cast<int64_t>(y) \
+                                             : numeric_compare(x, y) cmp 0; \
+        fp[t->dst] = result ? VAL_TRUE : VAL_FALSE; \
+        if (!result) VM_BRANCH(code + t[1].b); \
+        VM_GOTO(t + 2); \
+    } while (0)
+// LoadConst followed by SMI arithmetic in pc[1], which may read the constant
+#define VM_LOAD_CONST_ARITH_I64(smi_fn, slow_fn) do { \
+        fp[pc->dst] = constants[pc->b]; \
+        const Instr* op = pc + 1; \
+        LmValue x = fp[op->a], y = fp[op->b]; \
+        if (!smi_fn(x, y, &fp[op->dst])) fp[op->dst] = slow_fn(x, y); \
+        VM_GOTO(pc + 2); \
+    } while (0)
+
+    VM_SAFEPOINT();
+    if (pc >= end) return;
+#ifdef LM_VM_THREADED
+    VM_DISPATCH();
+#else
+dispatch:
+    switch (pc->op) {
+#endif
+
+    VM_CASE(Mov)
+        fp[pc->dst] = fp[pc->a];
+        VM_NEXT();
+
+    VM_CASE(LoadConst)
+        fp[pc->dst] = constants[pc->b];
+        VM_NEXT();
+
+    VM_CASE(Add) {
+        LmValue x = fp[pc->a], y = fp[pc->b];
+        VM_QUICKEN(x, y);
+        fp[pc->dst] = lm_add_inline(x, y);
+        VM_NEXT();
+    }
+    VM_CASE(Sub) {
+        LmValue x = fp[pc->a], y = fp[pc->b];
+        VM_QUICKEN(x, y);
+        fp[pc->dst] = lm_sub_inline(x, y);
+        VM_NEXT();
+    }
+    VM_CASE(Mul) {
+        LmValue x = fp[pc->a], y = fp[pc->b];
+        VM_QUICKEN(x, y);
+        fp[pc->dst] = lm_mul_inline(x, y);
+        VM_NEXT();
+    }
+    VM_CASE(Div) {
+        LmValue x = fp[pc->a], y = fp[pc->b];
+        VM_QUICKEN(x, y);
+        fp[pc->dst] = lm_div_inline(x, y);
+        VM_NEXT();
+    }
+
+    VM_CASE(CmpEQ)
+        VM_CMP(==);
+        VM_NEXT();
+    VM_CASE(CmpNEQ)
+        VM_CMP(!=);
+        VM_NEXT();
+    VM_CASE(CmpLT)
+        VM_CMP(<);
+        VM_NEXT();
+    VM_CASE(CmpLE)
+        VM_CMP(<=);
+        VM_NEXT();
+    VM_CASE(CmpGT)
+        VM_CMP(>);
+        VM_NEXT();
+    VM_CASE(CmpGE)
+        VM_CMP(>=);
+        VM_NEXT();
+
+    // Specialized integer arithmetic takes the runtime's SMI fast paths and
+    // deoptimizes to the generic opcode when they fail
+    VM_CASE(AddI64) {
+        LmValue x = fp[pc->a], y = fp[pc->b];
+        if (!lm_smi_add(x, y, &fp[pc->dst])) {
+            VM_DEOPT(Add);
+            fp[pc->dst] = lm_add_slow(x, y);
+        }
+        VM_NEXT();
+    }
+    VM_CASE(SubI64) {
+        LmValue x = fp[pc->a], y = fp[pc->b];
+        if (!lm_smi_sub(x, y, &fp[pc->dst])) {
+            VM_DEOPT(Sub);
+            fp[pc->dst] = lm_sub_slow(x, y);
+        }
+        VM_NEXT();
+    }
+    VM_CASE(MulI64) {
+        LmValue x = fp[pc->a], y = fp[pc->b];
+        if (!lm_smi_mul(x, y, &fp[pc->dst])) {
+            VM_DEOPT(Mul);
+            fp[pc->dst] = lm_mul_slow(x, y);
+        }
+        VM_NEXT();
+    }
+    VM_CASE(DivI64) {
+        LmValue x = fp[pc->a], y = fp[pc->b];
+        if (!lm_smi_div(x, y, &fp[pc->dst])) {
+            VM_DEOPT(Div);
+            fp[pc->dst] = lm_div_slow(x, y);
+        }
+        VM_NEXT();
+    }
+
+    VM_CASE(CmpEqI64)
+        VM_CMP_I64(==, CmpEQ);
+        VM_NEXT();
+    VM_CASE(CmpNeI64)
+        VM_CMP_I64(!=, CmpNEQ);
+        VM_NEXT();
+    VM_CASE(CmpLtI64)
+        VM_CMP_I64(<, CmpLT);
+        VM_NEXT();
+    VM_CASE(CmpLeI64)
+        VM_CMP_I64(<=, CmpLE);
+        VM_NEXT();
+    VM_CASE(CmpGtI64)
+        VM_CMP_I64(>, CmpGT);
+        VM_NEXT();
+    VM_CASE(CmpGeI64)
+        VM_CMP_I64(>=, CmpGE);
+        VM_NEXT();
+
+    VM_CASE(AddF64)
+        VM_ARITH_F64(+, Add, lm_add);
+        VM_NEXT();
+    VM_CASE(SubF64)
+        VM_ARITH_F64(-, Sub, lm_sub);
+        VM_NEXT();
+    VM_CASE(MulF64)
+        VM_ARITH_F64(*, Mul, lm_mul);
+        VM_NEXT();
+    VM_CASE(DivF64) {
+        LmValue x = fp[pc->a], y = fp[pc->b];
+        if (is_float_operand(x) && is_float_operand(y) && float_operand_value(y) != 0.0) {
+            fp[pc->dst] = float_result(float_operand_value(x) / float_operand_value(y));
+        } else {
+            VM_DEOPT(Div);
+            fp[pc->dst] = lm_div(x, y);
+        }
+        VM_NEXT();
+    }
+
+    VM_CASE(ListIndex) {
+        LmValue x = fp[pc->a], y = fp[pc->b];
+        VM_QUICKEN(x, y);
+        fp[pc->dst] = index_value(x, y);
+        VM_NEXT();
+    }
+    VM_CASE(ListIndexI64) {
+        LmValue x = fp[pc->a], y = fp[pc->b];
+        if (is_list_object(x) && IS_INT(y)) {
+            fp[pc->dst] = list_element((LmList*)UNBOX_PTR(x), static_cast<uint64_t>(UNBOX_INT(y)));
+        } else {
+            VM_DEOPT(ListIndex);
+            fp[pc->dst] = index_value(x, y);
+        }
+        VM_NEXT();
+    }
+
+    VM_CASE(FrameGetField) {
+        LmValue x = fp[pc->a];
+        VM_QUICKEN(x, VAL_NIL);
+        if (IS_PTR(x)) fp[pc->dst] = lm_frame_get_field(UNBOX_PTR(x), static_cast<int>(pc->b));
+        VM_NEXT();
+    }
+    VM_CASE(FrameGetFieldInline) {
+        LmValue x = fp[pc->a];
+        if (is_frame_object(x) && pc->b < static_cast<uint32_t>(((LmFrame*)UNBOX_PTR(x))->field_count)) {
+            fp[pc->dst] = ((LmFrame*)UNBOX_PTR(x))->fields[pc->b];
+        } else {
+            VM_DEOPT(FrameGetField);
+            if (IS_PTR(x)) fp[pc->dst] = lm_frame_get_field(UNBOX_PTR(x), static_cast<int>(pc->b));
+        }
+        VM_NEXT();
+    }
+
+    // Superinstructions perform both halves of their pair, including the
+    // intermediate register write, then continue after the second one
+    VM_CASE(CmpLtI64JumpIfFalse)
+        VM_CMP_BRANCH_I64(<, pc);
+    VM_CASE(CmpEqI64JumpIfFalse)
+        VM_CMP_BRANCH_I64(==, pc);
+    VM_CASE(JumpCmpLtI64)
+        if (code + pc->b <= pc) VM_SAFEPOINT();
+        VM_CMP_BRANCH_I64(<, code + pc->b);
+    VM_CASE(LoadConstAddI64)
+        VM_LOAD_CONST_ARITH_I64(lm_smi_add, lm_add_slow);
+    VM_CASE(LoadConstSubI64)
+        VM_LOAD_CONST_ARITH_I64(lm_smi_sub, lm_sub_slow);
+
+    VM_CASE(Jump)
+        VM_BRANCH(code + pc->b);
+    VM_CASE(JumpIf)
+        if (to_bool(fp[pc->a])) VM_BRANCH(code + pc->b);
+        VM_NEXT();
+    VM_CASE(JumpIfFalse)
+        if (!to_bool(fp[pc->a])) VM_BRANCH(code + pc->b);
+        VM_NEXT();
+
+    VM_CASE(Call) {
+        const CallSite& site = function.calls[pc->b];
+        if (site.func_index != UINT32_MAX) {
+            if (call_frames_.size() >= MAX_CALL_DEPTH) {
+                std::cerr << "Call stack overflow in " << program_[site.func_index].name
+                          << location_suffix(function, pc) << std::endl;
+                halted_ = true;
+                return;
             }
-            case LIR::LIR_Op::Add:
-            case LIR::LIR_Op::Sub:
-            case LIR::LIR_Op::Mul:
-            case LIR::LIR_Op::Div:
-            case LIR::LIR_Op::Mod:
-            case LIR::LIR_Op::Neg:
-            case LIR::LIR_Op::DecAdd:
-            case LIR::LIR_Op::DecSub:
-            case LIR::LIR_Op::DecMul:
-            case LIR::LIR_Op::DecDiv:
-            case LIR::LIR_Op::DecMod:
-            case LIR::LIR_Op::DecNeg:
-            case LIR::LIR_Op::DecRescale:
-                execute_arithmetic(pc);
-                break;
-            case LIR::LIR_Op::CmpEQ:
-            case LIR::LIR_Op::CmpNEQ:
-            case LIR::LIR_Op::CmpLT:
-            case LIR::LIR_Op::CmpLE:
-            case LIR::LIR_Op::CmpGT:
-            case LIR::LIR_Op::CmpGE:
-                execute_comparison(pc);
-                break;
-            case LIR::LIR_Op::ListCreate:
-            case LIR::LIR_Op::ListAppend:
-            case LIR::LIR_Op::ListLen:
-            case LIR::LIR_Op::ListIndex:
-            case LIR::LIR_Op::DictCreate:
-            case LIR::LIR_Op::DictSet:
-            case LIR::LIR_Op::DictGet:
-            case LIR::LIR_Op::DictHas:
-            case LIR::LIR_Op::DictLen:
-            case LIR::LIR_Op::TupleCreate:
-            case LIR::LIR_Op::TupleSet:
-            case LIR::LIR_Op::TupleGet:
-            case LIR::LIR_Op::TupleLen:
-                execute_collections(pc);
-                break;
-            case LIR::LIR_Op::NewFrame:
-            case LIR::LIR_Op::ConstructError:
-            case LIR::LIR_Op::ConstructOk:
-            case LIR::LIR_Op::IsError:
-            case LIR::LIR_Op::Unwrap:
-            case LIR::LIR_Op::FrameGetField:
-            case LIR::LIR_Op::FrameSetField:
-            case LIR::LIR_Op::FrameGetFieldAtomic:
-            case LIR::LIR_Op::FrameSetFieldAtomic:
-                execute_frames(pc);
-                break;
-            case LIR::LIR_Op::Jump:
-            case LIR::LIR_Op::JumpIf:
-            case LIR::LIR_Op::JumpIfFalse:
-                execute_control_flow(pc, function);
-                break;
-            case LIR::LIR_Op::PrintInt:
-            case LIR::LIR_Op::PrintUint:
-            case LIR::LIR_Op::PrintFloat:
-            case LIR::LIR_Op::PrintBool:
-            case LIR::LIR_Op::PrintString:
-                execute_io(pc);
-                break;
-            case LIR::LIR_Op::And:
-            case LIR::LIR_Op::Or:
-            case LIR::LIR_Op::Xor:
-                execute_bitwise(pc);
-                break;
-            case LIR::LIR_Op::ChannelAlloc:
-            case LIR::LIR_Op::ChannelSend:
-            case LIR::LIR_Op::ChannelOffer:
-            case LIR::LIR_Op::ChannelRecv:
-            case LIR::LIR_Op::ChannelPoll:
-            case LIR::LIR_Op::ChannelClose:
-            case LIR::LIR_Op::ChannelHasData:
-                execute_concurrency(pc);
-                break;
-            case LIR::LIR_Op::LoadGlobal:
-            case LIR::LIR_Op::StoreGlobal:
-                execute_modules(pc);
-                break;
-            case LIR::LIR_Op::MakeEnum:
-            case LIR::LIR_Op::GetTag:
-            case LIR::LIR_Op::GetPayload:
-                execute_objects(pc);
-                break;
-            case LIR::LIR_Op::ToString:
-            case LIR::LIR_Op::STR_CONCAT:
-                execute_strings(pc);
-                break;
-            case LIR::LIR_Op::Call:
-            case LIR::LIR_Op::CallVoid:
-            case LIR::LIR_Op::CallIndirect:
-            case LIR::LIR_Op::CallBuiltin:
-                execute_calls(pc);
-                break;
-            case LIR::LIR_Op::Cast:
-                execute_cast(pc);
+            invoke_function(program_[site.func_index], gather_arguments(function.call_args.data() + site.first_arg, site.arg_count),
+                            site.arg_count, pc->dst);
+        } else {
+            call_builtin(site, function.call_args.data() + site.first_arg, pc->dst);
+        }
+        VM_AFTER_CALL();
+        VM_NEXT();
+    }
+
+    VM_CASE(CallVoid)
+    VM_CASE(CallIndirect)
+    VM_CASE(CallBuiltin)
+        execute_calls(VM_EXTENDED());
+        VM_AFTER_CALL();
+        VM_NEXT();
+
+    VM_CASE(Param)
+        argument_stack.push_back(fp[pc->a]);
+        VM_NEXT();
+
+    VM_CASE(Return)
+    VM_CASE(Ret)
+        return_value_ = fp[pc->a];
+        return;
+
+    VM_CASE(Mod)
+    VM_CASE(Neg)
+    VM_CASE(DecAdd)
+    VM_CASE(DecSub)
+    VM_CASE(DecMul)
+    VM_CASE(DecDiv)
+    VM_CASE(DecMod)
+    VM_CASE(DecNeg)
+    VM_CASE(DecRescale)
+        execute_arithmetic(VM_EXTENDED());
+        VM_NEXT();
+
+    // The frame's descriptor was resolved when the function was lowered
+    VM_CASE(NewFrame) {
+        const LIR::LIR_Inst* inst = VM_EXTENDED();
+        if (inst->region) lm_region_allocate(true);
+        fp[pc->dst] = BOX_PTR(lm_frame_new(function.frame_types[pc->a]));
+        if (inst->region) lm_region_allocate(false);
+        VM_NEXT();
+    }
+
+    VM_CASE(ListCreate)
+    VM_CASE(TupleCreate)
+    VM_CASE(ToString)
+    VM_CASE(STR_CONCAT)
+    VM_CASE(STR_FORMAT)
+    VM_CASE(STR_BUILD)
+    VM_CASE(STR_APPEND)
+        execute_allocation(VM_EXTENDED());
+        VM_NEXT();
+
+    VM_CASE(RegionEnter)
+        fp[pc->dst] = BOX_INT(lm_region_mark());
+        VM_NEXT();
+    VM_CASE(RegionExit)
+        if (IS_INT(fp[pc->a])) lm_region_release(static_cast<uint64_t>(UNBOX_INT(fp[pc->a])));
+        VM_NEXT();
+
+    VM_CASE(ListAppend)
+        if (is_list_object(fp[pc->a])) list_append((LmList*)UNBOX_PTR(fp[pc->a]), fp[pc->b]);
+        VM_NEXT();
+
+    VM_CASE(ListLen)
+    VM_CASE(DictCreate)
+    VM_CASE(DictSet)
+    VM_CASE(DictGet)
+    VM_CASE(DictHas)
+    VM_CASE(DictLen)
+    VM_CASE(TupleSet)
+    VM_CASE(TupleGet)
+    VM_CASE(TupleLen)
+        execute_collections(VM_EXTENDED());
+        VM_NEXT();
+
+    // Loops over collections keep their cursor in a register; see runtime_iter.h
+    VM_CASE(IterBegin)
+        fp[pc->dst] = lm_iter_begin(fp[pc->a]);
+        VM_NEXT();
+    VM_CASE(IterNext) {
+        LmValue cursor = fp[pc->a];
+        switch (lm_iter_next(fp[pc->b], &cursor)) {
+            case LM_ITER_ITEM:
+                fp[pc->dst] = cursor;
                 break;
-            case LIR::LIR_Op::Mov:
-                registers[pc->dst] = registers[pc->a];
+            case LM_ITER_END:
+                fp[pc->dst] = VAL_FALSE;
                 break;
-            case LIR::LIR_Op::Return:
-            case LIR::LIR_Op::Ret: {
-                if (pc->op == LIR::LIR_Op::Ret) registers[0] = registers[pc->a];
+            case LM_ITER_MODIFIED:
+                std::cerr << "Dict changed size during iteration" << location_suffix(function, pc) << std::endl;
+                halted_ = true;
                 return;
-            }
-            default:
-                break;
         }
-        pc++;
+        VM_NEXT();
     }
+    VM_CASE(IterKey)
+        fp[pc->dst] = lm_iter_key(fp[pc->a], fp[pc->b]);
+        VM_NEXT();
+    VM_CASE(IterValue)
+        fp[pc->dst] = lm_iter_value(fp[pc->a], fp[pc->b]);
+        VM_NEXT();
+
+    VM_CASE(ConstructError)
+    VM_CASE(ConstructOk)
+    VM_CASE(IsError)
+    VM_CASE(Unwrap)
+    VM_CASE(FrameSetField)
+    VM_CASE(FrameGetFieldAtomic)
+    VM_CASE(FrameSetFieldAtomic)
+    VM_CASE(FrameFieldAtomicAdd)
+    VM_CASE(FrameFieldAtomicSub)
+        execute_frames(VM_EXTENDED());
+        VM_NEXT();
+
+    VM_CASE(PrintInt)
+    VM_CASE(PrintUint)
+    VM_CASE(PrintFloat)
+    VM_CASE(PrintBool)
+    VM_CASE(PrintString)
+        execute_io(VM_EXTENDED());
+        VM_NEXT();
+
+    VM_CASE(And)
+    VM_CASE(Or)
+    VM_CASE(Xor)
+        execute_bitwise(VM_EXTENDED());
+        VM_NEXT();
+
+    VM_CASE(ChannelAlloc)
+    VM_CASE(ChannelSend)
+    VM_CASE(ChannelOffer)
+    VM_CASE(ChannelRecv)
+    VM_CASE(ChannelPoll)
+    VM_CASE(ChannelClose)
+    VM_CASE(ChannelHasData)
+        execute_concurrency(VM_EXTENDED());
+        VM_RELOAD();
+        VM_NEXT();
+
+    VM_CASE(LoadGlobal)
+        fp[pc->dst] = globals_[pc->b];
+        VM_NEXT();
+    VM_CASE(StoreGlobal)
+        globals_[pc->b] = fp[pc->a];
+        VM_NEXT();
+
+    VM_CASE(MakeEnum)
+    VM_CASE(GetTag)
+    VM_CASE(GetPayload)
+        execute_objects(VM_EXTENDED());
+        VM_NEXT();
+
+    VM_CASE(Cast)
+        execute_cast(VM_EXTENDED());
+        VM_NEXT();
+
+    VM_DEFAULT
+        VM_NEXT();
+
+#ifdef LM_VM_THREADED
+    // Every entry of profile_table lands here when op pairs are being counted
+op_Profile:
+    ++(*op_pairs_)[last_op_ * 256u + pc->op];
+    last_op_ = pc->op;
+    goto *dispatch_table[pc->op];
+#else
+    }
+#endif
+
+#undef VM_DISPATCH
+#undef VM_CASE
+#undef VM_DEFAULT
+#undef VM_GOTO
+#undef VM_NEXT
+#undef VM_SAFEPOINT
+#undef VM_BRANCH
+#undef VM_AFTER_CALL
+#undef VM_RELOAD
+#undef VM_EXTENDED
+#undef VM_QUICKEN
+#undef VM_DEOPT
+#undef VM_CMP
+#undef VM_CMP_I64
+#undef VM_CMP_BRANCH_I64
+#undef VM_LOAD_CONST_ARITH_I64
+#undef VM_ARITH_F64
 }
 
 void RegisterVM::execute_function(const LIR::LIR_Function& function) {
-    execute_instructions(function, 0, function.instructions.size());
+    // The entry function owns the bottom window of the register stack
+    frame_size_ = std::max<size_t>(function.register_count, 1);
+    if (frame_size_ > registers.size()) registers.resize(frame_size_, VAL_NIL);
+    frame_base_ = 0;
+    frame_ = registers.data();
+    ExecutableFunction entry = lower_function(function.name, function.instructions, frame_size_,
+                                              function.param_count, constant_pool_, superinstructions_);
+    execute_instructions(entry, 0, entry.code.size());
 }
 
 void RegisterVM::execute_lir_function(const LIR::LIRFunction& function) {
-    LIR::LIR_Function temp_wrapper(function.getName(), 0);
-    temp_wrapper.instructions = function.getInstructions();
-    execute_instructions(temp_wrapper, 0, temp_wrapper.instructions.size());
+    ExecutableFunction image = lower_function(function.getName(), function.getInstructions(),
+                                              function.getRegisterCount(),
+                                              static_cast<uint32_t>(function.getParameters().size()),
+                                              constant_pool_, superinstructions_);
+    execute_instructions(image, 0, image.code.size());
 }
 
 LM::Backend::Fiber* RegisterVM::get_current_fiber() {
@@ -3,6 +3,8 @@
 
 #include "../../lir/lir.hh"
 #include "../../lir/functions.hh"
+#include "../../lir/linker.hh"
+#include "bytecode.hh"
 #include "../types.hh"
 #include "../../memory/memory.hh"
 #include "../value.hh"
@@ -14,13 +16,18 @@
 #include "../register_value.hh"
 #include "../../runtime/runtime.h"
 #include "../../runtime/runtime_value.h"
+#include "../../runtime/runtime_gc.h"
 #include <vector>
 #include <string>
 #include <cstdint>
 #include <queue>
 #include <unordered_map>
+#include <algorithm>
 #include <memory>
 #include <atomic>
+#include <array>
+#include <chrono>
+#include <ostream>
 
 namespace LM {
 namespace Backend {
@@ -33,17 +40,18 @@ namespace Register {
     class RegisterVM {
 public:
     RegisterVM();
+    ~RegisterVM();
     
-    void execute_instructions(const LIR::LIR_Function& function, size_t start_pc, size_t end_pc);
+    void execute_instructions(ExecutableFunction& function, size_t start_pc, size_t end_pc);
     void execute_function(const LIR::LIR_Function& function);
     void execute_lir_function(const LIR::LIRFunction& function);
     
     inline const RegisterValue& get_register(LIR::Reg reg) const {
-        return registers[reg];
+        return frame_[reg];
     }
     
     inline void set_register(LIR::Reg reg, const RegisterValue& value) {
-        registers[reg] = value;
+        frame_[reg] = value;
     }
     
     void reset();
@@ -58,15 +66,35 @@ public:
     bool has_active_fibers() const;
     Fiber* get_current_fiber();
     
-    void set_current_function(const LIR::LIR_Function* func) { current_function_ = func; }
+    void set_function_table(std::shared_ptr<const LIR::FunctionTable> table);
+
+    // Budget for a run, checked only at safepoints: loop back-edges and
+    // function entries. Each safepoint reached is one step; 0 means no limit.
+    struct ExecutionLimits {
+        uint64_t max_steps = 0;
+        uint64_t timeout_ms = 0;   // Wall-clock time from set_execution_limits
+    };
+    void set_execution_limits(const ExecutionLimits& limits);
+    bool halted() const { return halted_; }  // Stopped by a limit or a fatal runtime error
+
+    // Count every pair of consecutively executed opcodes. Must be enabled
+    // before set_function_table; superinstructions are left out so the counts
+    // show which pairs are worth fusing.
+    void enable_op_pair_profile();
+    void print_op_pair_profile(std::ostream& out) const;
+
+    // Runtime objects are collected while the VM exists. Collections run at
+    // safepoints once allocation crosses the heap threshold; the roots are
+    // the live register windows, globals, constants, pending call arguments,
+    // channel buffers and task contexts.
+    void print_gc_stats(std::ostream& out) const;
 
 private:
     // Opcode execution modules
     void execute_arithmetic(const LIR::LIR_Inst* pc);
-    void execute_comparison(const LIR::LIR_Inst* pc);
+    void execute_allocation(const LIR::LIR_Inst* pc);
     void execute_collections(const LIR::LIR_Inst* pc);
     void execute_frames(const LIR::LIR_Inst* pc);
-    void execute_control_flow(const LIR::LIR_Inst*& pc, const LIR::LIR_Function& function);
     void execute_io(const LIR::LIR_Inst* pc);
     void execute_concurrency(const LIR::LIR_Inst* pc);
     void execute_bitwise(const LIR::LIR_Inst* pc);
@@ -74,9 +102,58 @@ private:
     void execute_objects(const LIR::LIR_Inst* pc);
     void execute_strings(const LIR::LIR_Inst* pc);
     void execute_calls(const LIR::LIR_Inst* pc);
+    void call_builtin(const CallSite& site, const LIR::Reg* args, LIR::Reg dst);
     void execute_cast(const LIR::LIR_Inst* pc);
 
-    std::vector<RegisterValue> registers;
+    // Call frames live on one contiguous register stack. Each activation owns
+    // a window of `size` registers starting at `base`; r0 of the callee is
+    // registers[base]. Arguments are copied into the callee window and the
+    // result is written back to `return_reg` in the caller window.
+    struct CallFrame {
+        size_t base;
+        size_t size;
+        LIR::Reg return_reg;
+    };
+
+    void invoke_function(ExecutableFunction& callee, const RegisterValue* args, size_t arg_count, LIR::Reg dst);
+    const RegisterValue* gather_arguments(const LIR::Reg* args, size_t arg_count);
+    std::string location_suffix(const ExecutableFunction& function, const Instr* pc) const;
+    bool safepoint(const ExecutableFunction& function, const Instr* pc);
+    void arm_safepoints();
+    void interrupt_at_safepoint();
+    void scan_gc_roots() const;
+    static void gc_scan_roots(void* vm);
+    static void gc_request(void* vm);
+    RegisterValue* push_frame(size_t size, LIR::Reg return_reg);
+    void pop_frame();
+
+    std::vector<RegisterValue> registers;        // Register stack shared by all frames
+    std::vector<CallFrame> call_frames_;
+    std::shared_ptr<const LIR::FunctionTable> function_table_;  // Set once the program is linked
+    std::vector<ExecutableFunction> program_;    // function_table_ lowered for execution, same indices
+    ConstantPool constant_pool_;                 // Literals of every lowered function
+    RegisterValue* frame_ = nullptr;             // r0 of the active frame
+    size_t frame_base_ = 0;
+    size_t frame_size_ = 0;
+    RegisterValue return_value_ = VAL_NIL;       // Set by Return/Ret, read by the caller
+    bool superinstructions_ = true;              // Fuse opcode pairs when lowering
+
+    // Safepoint accounting. steps_left_ counts down to the next slow-path
+    // check, which charges the whole slice to steps_taken_ and re-arms it.
+    ExecutionLimits limits_;
+    std::chrono::steady_clock::time_point deadline_;
+    uint64_t steps_left_ = UINT64_MAX;
+    uint64_t step_slice_ = UINT64_MAX;
+    uint64_t steps_taken_ = 0;
+    bool halted_ = false;                        // Execution stopped; every frame unwinds
+    static constexpr uint64_t TIMEOUT_CHECK_INTERVAL = 1 << 16;  // Safepoints between clock reads
+
+    // Executed opcode pairs, indexed [previous op * 256 + op]; null unless profiling
+    std::unique_ptr<std::array<uint64_t, 256 * 256>> op_pairs_;
+    uint8_t last_op_ = 0;
+
+    static constexpr size_t INITIAL_REGISTER_STACK = 1024;
+    static constexpr size_t MAX_CALL_DEPTH = 10000;
     
     struct ErrorInfo {
         std::string errorType;
@@ -90,8 +167,7 @@ private:
     
     std::unordered_map<int64_t, ErrorInfo> error_table;
     
-    const LIR::LIR_Function* current_function_ = nullptr;
-    std::unordered_map<std::string, RegisterValue> globals_;
+    std::vector<RegisterValue> globals_;         // Indexed by FunctionTable global slot
     std::unique_ptr<TypeSystem> type_system;
     
     std::vector<std::unique_ptr<TaskContext>> task_contexts;
@@ -102,24 +178,14 @@ private:
     std::unordered_map<std::string, std::atomic<int64_t>> shared_variables;
     std::unordered_map<uint32_t, std::unique_ptr<SharedCell>> shared_cells;
     
-    std::unordered_map<uint64_t, FrameInstancePtr> frame_instances;
-    uint64_t next_frame_id = 1;
-    
     std::atomic<int64_t> default_atomic{0};
     std::vector<std::queue<uint64_t>> work_queues;
     std::atomic<uint64_t> work_queue_counter{0};
     
     std::vector<RegisterValue> argument_stack;
+    std::vector<RegisterValue> call_values_;    // Arguments of the direct call being entered
+    std::vector<RegisterValue> string_parts_;   // Operands of the current STR_BUILD or STR_APPEND
 
-    static constexpr uint64_t MAX_INSTRUCTIONS = 1000000000;
-    uint64_t instruction_count = 0;
-    
-    inline LIR::Type get_register_type(LIR::Reg reg) const {
-        if (!current_function_) return LIR::Type::Void;
-        auto it = current_function_->register_types.find(reg);
-        return (it != current_function_->register_types.end()) ? it->second : LIR::Type::Void;
-    }
-    
     inline bool is_numeric(const RegisterValue& value) const {
         return is_integer(value) || is_float(value);
     }
@@ -140,23 +206,17 @@ private:
         if (IS_BOOL(value)) return UNBOX_BOOL(value);
         if (IS_NIL(value)) return false;
         if (is_integer(value)) return as_i128(value) != 0;
+        if (IS_FLOAT_IMM(value)) return UNBOX_FLOAT(value) != 0.0;
         if (IS_PTR(value)) {
             ObjHeader* h = (ObjHeader*)UNBOX_PTR(value);
             if (h->type_id == TYPE_FLOAT) return ((ObjFloat*)h)->value != 0.0;
-            if (h->type_id == TYPE_BOX && ((LmBox*)h)->type == LM_BOX_STRING) {
-                LmBox* box = (LmBox*)h;
-                return box->value.as_ptr && ((char*)box->value.as_ptr)[0] != '\0';
-            }
+            if (h->type_id == TYPE_STRING) return ((ObjString*)h)->length != 0;
             return true;
         }
         return false;
     }
     
     bool isErrorValue(LIR::Reg reg) const;
-    
-    FrameInstancePtr createFrameInstance(const std::string& frame_type);
-    void setFrameField(FrameInstancePtr frame, size_t index, const RegisterValue& value);
-    RegisterValue getFrameField(FrameInstancePtr frame, size_t index) const;
 };
 
 } // namespace Register
@@ -14,6 +14,7 @@ namespace Register {
 void* box_register_value(const RegisterValue& value) {
     if (IS_PTR(value)) return UNBOX_PTR(value);
     if (IS_INT(value)) return lm_box_int(as_i64(value));
+    if (IS_FLOAT_IMM(value)) return lm_box_float(UNBOX_FLOAT(value));
     if (IS_BOOL(value)) return lm_box_bool(UNBOX_BOOL(value));
     if (IS_NIL(value)) return lm_box_nullptr();
 
@@ -43,7 +44,6 @@ RegisterValue unbox_register_value(void* boxed_value) {
                 case LM_BOX_FLOAT: return make_float(box->value.as_float);
                 case LM_BOX_BOOL: return box->value.as_bool ? VAL_TRUE : VAL_FALSE;
                 case LM_BOX_NULLPTR: return VAL_NIL;
-                case LM_BOX_STRING: return BOX_PTR(box);
                 default: return VAL_NIL;
             }
         }
@@ -59,6 +59,9 @@ ValuePtr register_to_value_ptr(RegisterValue rv) {
         lm_string_free(s);
         auto intType = std::make_shared<::Type>(::TypeTag::Int128);
         return std::make_shared<::Value>(intType, str);
+    } else if (IS_FLOAT_IMM(rv)) {
+        auto floatType = std::make_shared<::Type>(::TypeTag::Float64);
+        return std::make_shared<::Value>(floatType, std::to_string(UNBOX_FLOAT(rv)));
     } else if (IS_BOOL(rv)) {
         auto boolType = std::make_shared<::Type>(::TypeTag::Bool);
         return std::make_shared<::Value>(boolType, UNBOX_BOOL(rv) ? "true" : "false");
@@ -67,9 +70,10 @@ ValuePtr register_to_value_ptr(RegisterValue rv) {
         if (h->type_id == TYPE_FLOAT) {
             auto floatType = std::make_shared<::Type>(::TypeTag::Float64);
             return std::make_shared<::Value>(floatType, std::to_string(((ObjFloat*)h)->value));
-        } else if (h->type_id == TYPE_BOX && ((LmBox*)h)->type == LM_BOX_STRING) {
+        } else if (h->type_id == TYPE_STRING) {
+            ObjString* string = (ObjString*)h;
             auto stringType = std::make_shared<::Type>(::TypeTag::String);
-            return std::make_shared<::Value>(stringType, (char*)((LmBox*)h)->value.as_ptr);
+            return std::make_shared<::Value>(stringType, std::string(string->data, string->length));
         } else if (h->type_id == TYPE_BOX && ((LmBox*)h)->type == LM_BOX_FLOAT) {
              auto floatType = std::make_shared<::Type>(::TypeTag::Float64);
              return std::make_shared<::Value>(floatType, std::to_string(((LmBox*)h)->value.as_float));
@@ -98,6 +98,7 @@ bool TypeChecker::check_program(std::shared_ptr<LM::Frontend::AST::Program> prog
             module->is_checked = true; // Mark before to prevent recursion
             TypeSystem ts;
             TypeChecker checker(ts);
+            TypeCheckerFactory::register_builtin_functions(checker);
             checker.set_source_context(module->source, module->path);
             if (!checker.check_program(module->ast)) {
                 add_error("Failed to type check module: " + path);
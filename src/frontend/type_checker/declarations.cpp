@@ -620,8 +620,10 @@ TypePtr TypeChecker::check_import_statement(std::shared_ptr<LM::Frontend::AST::I
                     // For variables, just use ANY_TYPE to avoid type-checking initialization expressions
                     declare_variable(qname, type_system.ANY_TYPE);
                 } else if (auto fr = std::dynamic_pointer_cast<LM::Frontend::AST::FrameDeclaration>(stmt)) {
-                    FrameInfo fi; fi.name = qname; fi.declaration = fr;
-                    frame_declarations[qname] = fi;
+                    // The import statement is visited again in the body pass; keep the
+                    // fields resolved for this frame in between instead of resetting them.
+                    FrameInfo& fi = frame_declarations[qname];
+                    fi.name = qname; fi.declaration = fr;
                     declare_variable(qname, type_system.createFrameType(qname));
                 } else if (auto tr = std::dynamic_pointer_cast<LM::Frontend::AST::TraitDeclaration>(stmt)) {
                     TraitInfo ti; ti.name = qname; ti.declaration = tr; ti.extends = tr->extends;
@@ -477,6 +477,9 @@ TypePtr TypeChecker::check_unary_expr(std::shared_ptr<LM::Frontend::AST::UnaryEx
         case TokenType::MINUS:
         case TokenType::PLUS:
             // Numeric negation/affirmation
+            if (right_base->tag == TypeTag::Any) {
+                return type_system.ANY_TYPE;
+            }
             if (!is_numeric_type(right_base)) {
                 add_type_error("numeric", right_base->toString(), expr->line);
             }
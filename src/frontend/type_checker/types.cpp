@@ -212,6 +212,14 @@ bool TypeChecker::is_type_compatible(TypePtr expected, TypePtr actual) {
         auto* eData = std::get_if<TraitType>(&expected->extra);
         if (aData && eData && get_base(aData->name) == get_base(eData->name)) return true;
     }
+    // Lists of Any, such as the results of the list_* builtins, are as
+    // dynamic as Any itself
+    if (actual->tag == TypeTag::List && expected->tag == TypeTag::List) {
+        const auto* aList = std::get_if<ListType>(&actual->extra);
+        const auto* eList = std::get_if<ListType>(&expected->extra);
+        if (aList && eList && aList->elementType && eList->elementType &&
+            (aList->elementType->tag == TypeTag::Any || eList->elementType->tag == TypeTag::Any)) return true;
+    }
     if (expected->tag == TypeTag::Refined) {
         if (const auto* refined = std::get_if<RefinedType>(&expected->extra)) return is_type_compatible(refined->baseType, actual);
     }
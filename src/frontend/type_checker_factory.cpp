@@ -88,6 +88,7 @@ void register_builtin_functions(TypeChecker& checker) {
     checker.register_builtin_function("length", {ts.STRING_TYPE}, ts.INT_TYPE);
     checker.register_builtin_function("substring", {ts.STRING_TYPE, ts.INT_TYPE, ts.INT_TYPE}, ts.STRING_TYPE);
     checker.register_builtin_function("str_format", {ts.STRING_TYPE, ts.ANY_TYPE}, ts.STRING_TYPE);
+    checker.register_builtin_function("intern", {ts.STRING_TYPE}, ts.STRING_TYPE);
     
     // Utility functions
     checker.register_builtin_function("typeof", {ts.ANY_TYPE}, ts.STRING_TYPE);
@@ -117,6 +118,21 @@ void register_builtin_functions(TypeChecker& checker) {
     checker.register_builtin_function("some", {function_type, ts.createTypedListType(ts.ANY_TYPE)}, ts.BOOL_TYPE);
     checker.register_builtin_function("every", {function_type, ts.createTypedListType(ts.ANY_TYPE)}, ts.BOOL_TYPE);
     
+    // Whole-list numeric kernels
+    auto any_list_type = ts.createTypedListType(ts.ANY_TYPE);
+    checker.register_builtin_function("list_sum", {any_list_type}, ts.ANY_TYPE);
+    checker.register_builtin_function("list_min", {any_list_type}, ts.ANY_TYPE);
+    checker.register_builtin_function("list_max", {any_list_type}, ts.ANY_TYPE);
+    checker.register_builtin_function("list_mean", {any_list_type}, ts.FLOAT64_TYPE);
+    checker.register_builtin_function("list_dot", {any_list_type, any_list_type}, ts.ANY_TYPE);
+    checker.register_builtin_function("list_contains", {any_list_type, ts.ANY_TYPE}, ts.BOOL_TYPE);
+    checker.register_builtin_function("list_index_of", {any_list_type, ts.ANY_TYPE}, ts.INT_TYPE);
+    checker.register_builtin_function("list_count", {any_list_type, ts.ANY_TYPE}, ts.INT_TYPE);
+    checker.register_builtin_function("list_add", {any_list_type, any_list_type}, any_list_type);
+    checker.register_builtin_function("list_mul", {any_list_type, any_list_type}, any_list_type);
+    checker.register_builtin_function("list_scale", {any_list_type, ts.ANY_TYPE}, any_list_type);
+    checker.register_builtin_function("list_prefix_sum", {any_list_type}, any_list_type);
+    
     // Function composition
     checker.register_builtin_function("compose", {function_type, function_type}, function_type);
     checker.register_builtin_function("curry", {function_type}, function_type);
@@ -8,6 +8,7 @@
 #include "frontend/module_manager.hh"
 #include "lir/generator.hh"
 #include "lir/functions.hh"
+#include "lir/linker.hh"
 #include "backend/vm/register.hh"
 #include "error/debugger.hh"
 
@@ -82,6 +83,7 @@ int Compiler::executeFile(const std::string& filename, const CompileOptions& opt
 
         LIR::Generator lir_generator;
         lir_generator.set_import_aliases(post_opt_type_check.import_aliases);
+        lir_generator.set_source_file(filename);
         lir_generator.set_registered_modules(post_opt_type_check.registered_modules);
 
         auto lir_function = lir_generator.generate_program(post_opt_type_check);
@@ -138,8 +140,15 @@ int Compiler::executeFile(const std::string& filename, const CompileOptions& opt
             return 1;
 #endif
         } else {
+            LIR::Linker linker(*lir_function);
             LM::Backend::VM::Register::RegisterVM register_vm;
+            if (options.profile_op_pairs) register_vm.enable_op_pair_profile();
+            register_vm.set_function_table(linker.link());
+            register_vm.set_execution_limits({options.max_steps, options.timeout_ms});
             register_vm.execute_function(*lir_function);
+            if (options.profile_op_pairs) register_vm.print_op_pair_profile(std::cerr);
+            if (options.gc_stats) register_vm.print_gc_stats(std::cerr);
+            if (register_vm.halted()) return 1;
         }
     } catch (const std::exception& e) {
         std::cerr << "Error: " << e.what() << "\n";
@@ -1,4 +1,5 @@
 #pragma once
+#include <cstdint>
 #include <string>
 #include <vector>
 #include <memory>
@@ -20,6 +21,10 @@ namespace LM {
         bool print_lir = false;
         bool print_fyra_ir = false;
         bool disable_opt = false;
+        bool profile_op_pairs = false;
+        bool gc_stats = false;       // Print register VM collector statistics after the run
+        uint64_t max_steps = 0;      // Register VM safepoints allowed, 0 = unlimited
+        uint64_t timeout_ms = 0;     // Register VM wall-clock limit, 0 = unlimited
     };
 
     class Compiler {
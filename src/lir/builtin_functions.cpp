@@ -1,6 +1,8 @@
 #include "builtin_functions.hh"
 #include "function_registry.hh"
 #include "lir.hh"
+#include "../runtime/runtime_kernels.h"
+#include "../runtime/runtime_value.h"
 #include <iostream>
 #include <memory>
 #include <string>
@@ -34,6 +36,49 @@ namespace {
         if (mode == "a+") return std::ios::in | std::ios::out | std::ios::app;
         throw std::runtime_error("file_open: unsupported mode '" + mode + "'");
     }
+
+    // The list kernels run on runtime values. These convert the numbers,
+    // bools and lists they take and return; anything else becomes nil.
+    LmValue to_runtime_value(const ValuePtr& value) {
+        switch (value->type->tag) {
+            case TypeTag::Bool:
+                return value->as<bool>() ? VAL_TRUE : VAL_FALSE;
+            case TypeTag::Int: case TypeTag::Int8: case TypeTag::Int16: case TypeTag::Int32: case TypeTag::Int64:
+            case TypeTag::UInt8: case TypeTag::UInt16: case TypeTag::UInt32:
+                return make_i64(value->as<int64_t>());
+            case TypeTag::Float32:
+            case TypeTag::Float64:
+                return make_float(value->as<double>());
+            case TypeTag::List: {
+                LmList* list = lm_list_new();
+                if (auto* elements = std::get_if<ListValue>(&value->complexData)) {
+                    for (const auto& element : elements->elements) lm_list_append(list, to_runtime_value(element));
+                }
+                return BOX_PTR(list);
+            }
+            default:
+                return VAL_NIL;
+        }
+    }
+
+    ValuePtr from_runtime_value(LmValue value) {
+        if (IS_BOOL(value)) {
+            return std::make_shared<Value>(std::make_shared<::Type>(TypeTag::Bool), value == VAL_TRUE);
+        }
+        if (is_integer(value)) {
+            return std::make_shared<Value>(std::make_shared<::Type>(TypeTag::Int64), as_i64(value));
+        }
+        if (is_float(value)) {
+            return std::make_shared<Value>(std::make_shared<::Type>(TypeTag::Float64), as_float(value));
+        }
+        if (IS_PTR(value) && ((ObjHeader*)UNBOX_PTR(value))->type_id == TYPE_LIST) {
+            LmList* list = (LmList*)UNBOX_PTR(value);
+            ListValue elements;
+            for (uint64_t i = 0; i < list->size; i++) elements.append(from_runtime_value(lm_list_get(list, i)));
+            return std::make_shared<Value>(std::make_shared<::Type>(TypeTag::List), elements);
+        }
+        return std::make_shared<Value>(std::make_shared<::Type>(TypeTag::Nil));
+    }
 }
 
 // LIRBuiltinFunction implementation
@@ -126,7 +171,8 @@ void LIRBuiltinFunctions::initialize() {
     }
     
     registerIOFunctions();      // print, input
-    registerUtilityFunctions(); // typeof, clock, sleep, time, assert, channel
+    registerUtilityFunctions(); // typeof, intern, clock, sleep, time, assert, channel
+    registerListFunctions();    // list_sum, list_dot, list_index_of, ...
     
     initialized_ = true;
 }
@@ -337,6 +383,16 @@ void LIRBuiltinFunctions::registerUtilityFunctions() {
         }
     ));
     
+    registerFunction(std::make_shared<LIRBuiltinFunction>(
+        "intern",
+        std::vector<TypeTag>{TypeTag::String},
+        TypeTag::String,
+        [](const std::vector<ValuePtr>& args) -> ValuePtr {
+            // Values compare by contents, canonical objects only exist in the runtime
+            return args[0];
+        }
+    ));
+
     registerFunction(std::make_shared<LIRBuiltinFunction>(
         "clock",
         std::vector<TypeTag>{},
@@ -399,6 +455,44 @@ void LIRBuiltinFunctions::registerUtilityFunctions() {
     ));
 }
 
+void LIRBuiltinFunctions::registerListFunctions() {
+    struct ListBuiltin {
+        const char* name;
+        std::vector<TypeTag> paramTypes;
+        TypeTag returnType;
+    };
+    const ListBuiltin builtins[] = {
+        {"list_sum", {TypeTag::List}, TypeTag::Any},
+        {"list_min", {TypeTag::List}, TypeTag::Any},
+        {"list_max", {TypeTag::List}, TypeTag::Any},
+        {"list_mean", {TypeTag::List}, TypeTag::Float64},
+        {"list_dot", {TypeTag::List, TypeTag::List}, TypeTag::Any},
+        {"list_contains", {TypeTag::List, TypeTag::Any}, TypeTag::Bool},
+        {"list_index_of", {TypeTag::List, TypeTag::Any}, TypeTag::Int64},
+        {"list_count", {TypeTag::List, TypeTag::Any}, TypeTag::Int64},
+        {"list_add", {TypeTag::List, TypeTag::List}, TypeTag::List},
+        {"list_mul", {TypeTag::List, TypeTag::List}, TypeTag::List},
+        {"list_scale", {TypeTag::List, TypeTag::Any}, TypeTag::List},
+        {"list_prefix_sum", {TypeTag::List}, TypeTag::List},
+    };
+
+    for (const auto& builtin : builtins) {
+        LmListKernel kernel = lm_list_kernel(builtin.name);
+        registerFunction(std::make_shared<LIRBuiltinFunction>(
+            builtin.name,
+            builtin.paramTypes,
+            builtin.returnType,
+            [kernel](const std::vector<ValuePtr>& args) -> ValuePtr {
+                LmValue list = args.empty() ? VAL_NIL : to_runtime_value(args[0]);
+                // Anything but a list as the first argument gives nil
+                if (!IS_PTR(list)) return from_runtime_value(VAL_NIL);
+                LmValue arg = args.size() > 1 ? to_runtime_value(args[1]) : VAL_NIL;
+                return from_runtime_value(kernel((LmList*)UNBOX_PTR(list), arg));
+            }
+        ));
+    }
+}
+
 void LIRBuiltinFunctions::registerFunction(std::shared_ptr<LIRBuiltinFunction> function) {
     if (!function) {
         throw std::runtime_error("Cannot register null LIR builtin function");
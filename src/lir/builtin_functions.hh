@@ -65,7 +65,8 @@ public:
 private:
     // Only VM Intrinsics are built-in
     void registerIOFunctions();      // print, input
-    void registerUtilityFunctions(); // typeof, clock, sleep, time, assert
+    void registerUtilityFunctions(); // typeof, intern, clock, sleep, time, assert
+    void registerListFunctions();    // list_sum, list_dot, list_index_of, ...
 };
 
 namespace BuiltinUtils {
@@ -0,0 +1,600 @@
+#include "escape_analysis.hh"
+#include "../runtime/runtime_value.h"
+#include <algorithm>
+#include <map>
+#include <unordered_set>
+
+namespace LM {
+namespace LIR {
+
+namespace {
+
+bool is_allocation(LIR_Op op) {
+    switch (op) {
+        case LIR_Op::ListCreate:
+        case LIR_Op::TupleCreate:
+        case LIR_Op::NewFrame:
+        case LIR_Op::ToString:
+        case LIR_Op::STR_CONCAT:
+        case LIR_Op::STR_FORMAT:
+        case LIR_Op::STR_BUILD:
+        case LIR_Op::STR_APPEND:
+            return true;
+        default:
+            return false;
+    }
+}
+
+bool is_jump(LIR_Op op) {
+    return op == LIR_Op::Jump || op == LIR_Op::JumpIf || op == LIR_Op::JumpIfFalse;
+}
+
+// How an instruction uses a register that may hold a candidate object
+enum class Role {
+    Read,    // Inspects or updates the object in place
+    Alias,   // Copies the reference into dst
+    Escape   // Anything else, including storing it somewhere
+};
+
+struct Operand {
+    Reg reg;
+    Role role;
+};
+
+// Registers read by an instruction. Operand fields default to r0, so opcodes
+// that are not listed conservatively read every field.
+std::vector<Operand> operands(const LIR_Inst& inst) {
+    switch (inst.op) {
+        case LIR_Op::LoadConst:
+        case LIR_Op::LoadGlobal:
+        case LIR_Op::Jump:
+        case LIR_Op::Label:
+        case LIR_Op::Nop:
+        case LIR_Op::ListCreate:
+        case LIR_Op::TupleCreate:
+        case LIR_Op::NewFrame:
+        case LIR_Op::RegionEnter:
+            return {};
+        case LIR_Op::Mov:
+        case LIR_Op::Copy:
+        case LIR_Op::ToString:  // Strings convert to themselves
+            return {{inst.a, Role::Alias}};
+        case LIR_Op::JumpIf:
+        case LIR_Op::JumpIfFalse:
+            return {{inst.a, Role::Read}, {inst.dst, Role::Read}};
+        case LIR_Op::PrintInt:
+        case LIR_Op::PrintUint:
+        case LIR_Op::PrintFloat:
+        case LIR_Op::PrintBool:
+        case LIR_Op::PrintString:
+        case LIR_Op::ListLen:
+        case LIR_Op::TupleLen:
+        case LIR_Op::FrameGetField:
+        case LIR_Op::FrameGetFieldAtomic:
+        case LIR_Op::RegionExit:
+        case LIR_Op::IterBegin:
+            return {{inst.a, Role::Read}};
+        case LIR_Op::CmpEQ:
+        case LIR_Op::CmpNEQ:
+        case LIR_Op::CmpLT:
+        case LIR_Op::CmpLE:
+        case LIR_Op::CmpGT:
+        case LIR_Op::CmpGE:
+        case LIR_Op::STR_CONCAT:
+        case LIR_Op::STR_FORMAT:
+        case LIR_Op::StringIndex:
+        case LIR_Op::ListIndex:
+        case LIR_Op::TupleGet:
+        case LIR_Op::IterNext:
+        case LIR_Op::IterKey:
+        case LIR_Op::IterValue:
+            return {{inst.a, Role::Read}, {inst.b, Role::Read}};
+        case LIR_Op::ListAppend:
+            return {{inst.dst, Role::Read}, {inst.a, Role::Read}, {inst.b, Role::Escape}};
+        case LIR_Op::TupleSet:
+            return {{inst.dst, Role::Read}, {inst.a, Role::Read}, {inst.b, Role::Escape}};
+        case LIR_Op::FrameSetField:
+        case LIR_Op::FrameSetFieldAtomic:
+            return {{inst.dst, Role::Read}, {inst.b, Role::Escape}};
+        case LIR_Op::STR_BUILD:
+        case LIR_Op::STR_APPEND: {
+            std::vector<Operand> result;
+            for (Reg part : inst.call_args) result.push_back({part, Role::Read});
+            return result;
+        }
+        default: {
+            std::vector<Operand> result = {{inst.dst, Role::Escape}, {inst.a, Role::Escape}, {inst.b, Role::Escape}};
+            for (Reg arg : inst.call_args) result.push_back({arg, Role::Escape});
+            return result;
+        }
+    }
+}
+
+// Whether the instruction always overwrites dst. Liveness only relies on
+// these to end a register's lifetime, so the list errs on the short side.
+bool defines(const LIR_Inst& inst, Reg reg) {
+    if (inst.dst != reg) return false;
+    switch (inst.op) {
+        case LIR_Op::Mov:
+        case LIR_Op::LoadConst:
+        case LIR_Op::LoadGlobal:
+        case LIR_Op::Add:
+        case LIR_Op::Sub:
+        case LIR_Op::Mul:
+        case LIR_Op::Div:
+        case LIR_Op::CmpEQ:
+        case LIR_Op::CmpNEQ:
+        case LIR_Op::CmpLT:
+        case LIR_Op::CmpLE:
+        case LIR_Op::CmpGT:
+        case LIR_Op::CmpGE:
+        case LIR_Op::ListCreate:
+        case LIR_Op::TupleCreate:
+        case LIR_Op::NewFrame:
+        case LIR_Op::ToString:
+        case LIR_Op::STR_CONCAT:
+        case LIR_Op::STR_FORMAT:
+        case LIR_Op::STR_BUILD:
+        case LIR_Op::STR_APPEND:
+        case LIR_Op::RegionEnter:
+        case LIR_Op::IterBegin:
+        case LIR_Op::IterKey:
+        case LIR_Op::IterValue:
+            return true;
+        default:
+            return false;
+    }
+}
+
+// The index a register holds when its only writer loads a non-negative
+// integer constant. r0 is also the default of unused operand fields, so it
+// never qualifies.
+bool constant_index(const std::vector<LIR_Inst>& code, Reg reg, uint64_t& index) {
+    if (reg == 0) return false;
+    const LIR_Inst* writer = nullptr;
+    for (const LIR_Inst& inst : code) {
+        if (inst.dst != reg) continue;
+        if (writer) return false;
+        writer = &inst;
+    }
+    if (!writer || writer->op != LIR_Op::LoadConst || !is_integer(writer->const_val)) return false;
+    int64_t value = as_i64(writer->const_val);
+    if (value < 0) return false;
+    index = static_cast<uint64_t>(value);
+    return true;
+}
+
+bool reads(const LIR_Inst& inst, Reg reg) {
+    for (const Operand& operand : operands(inst)) {
+        if (operand.reg == reg) return true;
+    }
+    return false;
+}
+
+} // namespace
+
+void EscapeAnalysis::build_cfg() {
+    const auto& code = func_.instructions;
+    const size_t count = code.size();
+    successors_.assign(count, {});
+    predecessors_.assign(count, {});
+
+    for (size_t pc = 0; pc < count; ++pc) {
+        const LIR_Inst& inst = code[pc];
+        if (is_jump(inst.op) && inst.imm < count) successors_[pc].push_back(inst.imm);
+        if (inst.op != LIR_Op::Jump && !inst.isReturn() && pc + 1 < count) successors_[pc].push_back(pc + 1);
+        for (size_t next : successors_[pc]) predecessors_[next].push_back(pc);
+    }
+}
+
+void EscapeAnalysis::find_loops() {
+    const size_t count = func_.instructions.size();
+    loops_.clear();
+
+    // The generator lays loops out header first, so back-edges jump backwards
+    for (size_t pc = 0; pc < count; ++pc) {
+        for (size_t target : successors_[pc]) {
+            if (target > pc) continue;
+            auto loop = std::find_if(loops_.begin(), loops_.end(),
+                                     [&](const Loop& l) { return l.header == target; });
+            if (loop == loops_.end()) {
+                loops_.push_back({target, {}, std::vector<bool>(count, false), 0, false, {}});
+                loop = loops_.end() - 1;
+            }
+            loop->latches.push_back(pc);
+        }
+    }
+
+    for (Loop& loop : loops_) {
+        loop.body[loop.header] = true;
+        std::vector<size_t> worklist;
+        for (size_t latch : loop.latches) {
+            if (!loop.body[latch]) {
+                loop.body[latch] = true;
+                worklist.push_back(latch);
+            }
+        }
+        while (!worklist.empty()) {
+            size_t pc = worklist.back();
+            worklist.pop_back();
+            for (size_t pred : predecessors_[pc]) {
+                if (loop.body[pred]) continue;
+                loop.body[pred] = true;
+                worklist.push_back(pred);
+            }
+        }
+        loop.size = static_cast<size_t>(std::count(loop.body.begin(), loop.body.end(), true));
+    }
+
+    // Only single-entry loops have a header that runs before every latch
+    loops_.erase(std::remove_if(loops_.begin(), loops_.end(), [&](const Loop& loop) {
+        for (size_t pc = 0; pc < count; ++pc) {
+            if (!loop.body[pc] || pc == loop.header) continue;
+            for (size_t pred : predecessors_[pc]) {
+                if (!loop.body[pred]) return true;
+            }
+        }
+        return false;
+    }), loops_.end());
+}
+
+EscapeAnalysis::Loop* EscapeAnalysis::innermost_loop(size_t pc) {
+    Loop* best = nullptr;
+    for (Loop& loop : loops_) {
+        if (loop.body[pc] && (!best || loop.size < best->size)) best = &loop;
+    }
+    return best;
+}
+
+std::vector<Reg> EscapeAnalysis::aliases_of(Reg reg) const {
+    std::vector<Reg> aliases = {reg};
+    std::unordered_set<Reg> seen = {reg};
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (const LIR_Inst& inst : func_.instructions) {
+            for (const Operand& operand : operands(inst)) {
+                if (operand.role == Role::Alias && seen.count(operand.reg) && seen.insert(inst.dst).second) {
+                    aliases.push_back(inst.dst);
+                    changed = true;
+                }
+            }
+        }
+    }
+    return aliases;
+}
+
+bool EscapeAnalysis::escapes(const std::vector<Reg>& aliases) const {
+    for (const LIR_Inst& inst : func_.instructions) {
+        for (const Operand& operand : operands(inst)) {
+            if (operand.role == Role::Escape &&
+                std::find(aliases.begin(), aliases.end(), operand.reg) != aliases.end()) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+std::vector<bool> EscapeAnalysis::live_in(Reg reg) const {
+    const auto& code = func_.instructions;
+    std::vector<bool> live(code.size(), false);
+    std::vector<size_t> worklist;
+    for (size_t pc = 0; pc < code.size(); ++pc) {
+        if (reads(code[pc], reg)) {
+            live[pc] = true;
+            worklist.push_back(pc);
+        }
+    }
+    while (!worklist.empty()) {
+        size_t pc = worklist.back();
+        worklist.pop_back();
+        for (size_t pred : predecessors_[pc]) {
+            if (live[pred] || defines(code[pred], reg)) continue;
+            live[pred] = true;
+            worklist.push_back(pred);
+        }
+    }
+    return live;
+}
+
+bool EscapeAnalysis::dies_in_iteration(const Loop& loop, const std::vector<Reg>& aliases) const {
+    for (Reg reg : aliases) {
+        std::vector<bool> live = live_in(reg);
+        if (live[loop.header]) return false;
+        for (size_t latch : loop.latches) {
+            if (live[latch]) return false;
+        }
+        for (size_t pc = 0; pc < live.size(); ++pc) {
+            if (!loop.body[pc]) continue;
+            for (size_t next : successors_[pc]) {
+                if (!loop.body[next] && live[next]) return false;
+            }
+        }
+    }
+    return true;
+}
+
+bool EscapeAnalysis::only_read(Reg reg) const {
+    // Nothing sees what the top-level code returns
+    const bool top_level = func_.name == "__top_level_wrapper__";
+    for (const LIR_Inst& inst : func_.instructions) {
+        if (top_level && inst.isReturn()) continue;
+        for (const Operand& operand : operands(inst)) {
+            if (operand.reg == reg && operand.role != Role::Read) return false;
+        }
+    }
+    return true;
+}
+
+// Only STR_APPEND makes appendable strings, and only into registers that
+// never pass their value on, so such a string has no other reference
+void EscapeAnalysis::promote_appends() {
+    for (LIR_Inst& inst : func_.instructions) {
+        if (inst.op == LIR_Op::STR_BUILD && !inst.call_args.empty() && inst.call_args[0] == inst.dst &&
+            only_read(inst.dst)) {
+            inst.op = LIR_Op::STR_APPEND;
+        }
+    }
+}
+
+// A small tuple that never escapes and whose elements are only reached by
+// constant indices lives in one register per element instead: creation
+// clears them, TupleSet and TupleGet become moves and TupleLen a constant.
+// Copies of the reference are left in place and only ever copy nil.
+void EscapeAnalysis::scalar_replace_tuples() {
+    auto& code = func_.instructions;
+    if (std::none_of(code.begin(), code.end(), [](const LIR_Inst& inst) { return inst.op == LIR_Op::TupleCreate; })) {
+        return;
+    }
+
+    build_cfg();
+    find_loops();
+    std::vector<Insertion> insertions;
+
+    for (size_t pc = 0; pc < code.size(); ++pc) {
+        const LIR_Inst& create = code[pc];
+        if (create.op != LIR_Op::TupleCreate || create.dst == 0 || create.imm == 0 ||
+            create.imm > MAX_SCALAR_TUPLE) {
+            continue;
+        }
+        const uint64_t arity = create.imm;
+        std::vector<Reg> aliases = aliases_of(create.dst);
+        auto is_alias = [&](Reg reg) { return std::find(aliases.begin(), aliases.end(), reg) != aliases.end(); };
+        auto element_index = [&](Reg reg, uint64_t& index) {
+            return !is_alias(reg) && constant_index(code, reg, index) && index < arity;
+        };
+
+        bool replaceable = true;
+        for (size_t i = 0; i < code.size() && replaceable; ++i) {
+            if (i == pc) continue;
+            const LIR_Inst& inst = code[i];
+            const bool copy = (inst.op == LIR_Op::Mov || inst.op == LIR_Op::Copy) && is_alias(inst.a);
+            uint64_t index;
+            if (is_alias(inst.dst) && !copy && inst.op != LIR_Op::TupleSet) {
+                replaceable = false;
+            } else if (inst.op == LIR_Op::TupleSet && is_alias(inst.dst)) {
+                replaceable = element_index(inst.a, index) && !is_alias(inst.b);
+            } else if (inst.op == LIR_Op::TupleGet && is_alias(inst.a)) {
+                replaceable = element_index(inst.b, index);
+            } else if (!copy && !(inst.op == LIR_Op::TupleLen && is_alias(inst.a))) {
+                replaceable = !std::any_of(aliases.begin(), aliases.end(), [&](Reg reg) { return reads(inst, reg); });
+            }
+        }
+        // Each iteration's tuple must be gone before the next one is made
+        for (const Loop& loop : loops_) {
+            if (replaceable && loop.body[pc] && !dies_in_iteration(loop, aliases)) replaceable = false;
+        }
+        if (!replaceable) continue;
+
+        const Reg first = func_.register_count;
+        func_.register_count += static_cast<uint32_t>(arity);
+        for (size_t i = 0; i < code.size(); ++i) {
+            LIR_Inst& inst = code[i];
+            uint64_t index = 0;
+            if (inst.op == LIR_Op::TupleSet && is_alias(inst.dst)) {
+                constant_index(code, inst.a, index);
+                auto type = func_.register_types.find(inst.b);
+                inst.op = LIR_Op::Mov;
+                inst.result_type = type != func_.register_types.end() ? type->second : Type::Ptr;
+                inst.dst = first + static_cast<Reg>(index);
+                inst.a = inst.b;
+                inst.b = 0;
+            } else if (inst.op == LIR_Op::TupleGet && is_alias(inst.a)) {
+                constant_index(code, inst.b, index);
+                inst.op = LIR_Op::Mov;
+                inst.a = first + static_cast<Reg>(index);
+                inst.b = 0;
+            } else if (inst.op == LIR_Op::TupleLen && is_alias(inst.a)) {
+                inst.op = LIR_Op::LoadConst;
+                inst.const_val = make_i64(static_cast<int64_t>(arity));
+                inst.a = 0;
+            }
+        }
+
+        // Every creation starts its elements at nil, as lm_tuple_new does
+        for (uint64_t k = 0; k + 1 < arity; ++k) {
+            LIR_Inst clear(LIR_Op::LoadConst, Type::Void, first + static_cast<Reg>(k), VAL_NIL);
+            clear.loc = create.loc;
+            insertions.push_back({pc, true, clear});
+        }
+        LIR_Inst clear(LIR_Op::LoadConst, Type::Void, first + static_cast<Reg>(arity - 1), VAL_NIL);
+        clear.loc = create.loc;
+        code[pc] = clear;
+    }
+
+    splice(std::move(insertions));
+}
+
+bool EscapeAnalysis::run() {
+    auto& code = func_.instructions;
+    promote_appends();
+    scalar_replace_tuples();
+    if (std::none_of(code.begin(), code.end(), [](const LIR_Inst& inst) { return is_allocation(inst.op); })) {
+        return false;
+    }
+
+    build_cfg();
+    find_loops();
+
+    // A header that is also another loop's latch would run that loop's
+    // RegionExit on entry; leave such shapes alone
+    std::unordered_set<size_t> latches;
+    for (const Loop& loop : loops_) latches.insert(loop.latches.begin(), loop.latches.end());
+    loops_.erase(std::remove_if(loops_.begin(), loops_.end(), [&](const Loop& loop) {
+        return latches.count(loop.header) > 0;
+    }), loops_.end());
+
+    // The top-level code only returns when the program ends
+    const bool may_use_function_region = func_.name != "__top_level_wrapper__";
+    bool function_region = false;
+    bool changed = false;
+
+    for (size_t pc = 0; pc < code.size(); ++pc) {
+        LIR_Inst& inst = code[pc];
+        if (!is_allocation(inst.op)) continue;
+
+        std::vector<Reg> aliases = aliases_of(inst.dst);
+        if (escapes(aliases)) continue;
+
+        // Allocations inside a loop belong to its innermost one: that loop's
+        // release frees everything allocated during the iteration and runs
+        // on every edge that leaves the loop. The object must be dead across
+        // the iterations of enclosing loops too.
+        if (Loop* loop = innermost_loop(pc)) {
+            bool dies = true;
+            for (const Loop& outer : loops_) {
+                if (outer.body[pc] && !dies_in_iteration(outer, aliases)) dies = false;
+            }
+            if (!dies) continue;
+            loop->has_region = true;
+            loop->released.insert(loop->released.end(), aliases.begin(), aliases.end());
+        } else if (may_use_function_region) {
+            function_region = true;
+        } else {
+            continue;
+        }
+        inst.region = true;
+        changed = true;
+    }
+
+    if (!changed) return false;
+    insert_region_ops(function_region);
+    return true;
+}
+
+void EscapeAnalysis::insert_region_ops(bool function_region) {
+    std::vector<Insertion> insertions;
+    auto& code = func_.instructions;
+
+    auto region_inst = [&](LIR_Op op, Reg mark, size_t before) {
+        LIR_Inst inst(op, Type::Void, op == LIR_Op::RegionEnter ? mark : 0, op == LIR_Op::RegionExit ? mark : 0);
+        if (before < code.size()) inst.loc = code[before].loc;
+        return inst;
+    };
+
+    if (function_region) {
+        Reg mark = func_.register_count++;
+        insertions.push_back({0, false, region_inst(LIR_Op::RegionEnter, mark, 0)});
+        for (size_t pc = 0; pc < code.size(); ++pc) {
+            if (code[pc].isReturn()) insertions.push_back({pc, true, region_inst(LIR_Op::RegionExit, mark, pc)});
+        }
+    }
+    const size_t count = code.size();
+    std::unordered_set<size_t> headers;
+    for (const Loop& loop : loops_) headers.insert(loop.header);
+
+    // Conditional exits get a block of their own at the end of the code
+    std::map<size_t, std::vector<LIR_Inst>> exit_blocks;
+
+    for (const Loop& loop : loops_) {
+        if (!loop.has_region) continue;
+        Reg mark = func_.register_count++;
+        insertions.push_back({loop.header, true, region_inst(LIR_Op::RegionEnter, mark, loop.header)});
+
+        // Dead registers still point at released objects and the collector
+        // scans every register, so they are cleared first
+        std::vector<Reg> released = loop.released;
+        std::sort(released.begin(), released.end());
+        released.erase(std::unique(released.begin(), released.end()), released.end());
+        auto release = [&](size_t at) {
+            std::vector<LIR_Inst> insts;
+            for (Reg reg : released) {
+                LIR_Inst clear(LIR_Op::LoadConst, Type::Void, reg, VAL_NIL);
+                clear.loc = code[at].loc;
+                insts.push_back(clear);
+            }
+            insts.push_back(region_inst(LIR_Op::RegionExit, mark, at));
+            return insts;
+        };
+        auto release_before = [&](size_t pc, bool takes_jumps) {
+            for (LIR_Inst& inst : release(pc)) insertions.push_back({pc, takes_jumps, inst});
+        };
+
+        for (size_t latch : loop.latches) release_before(latch, true);
+
+        // A break or return leaves the iteration's objects behind otherwise,
+        // and the top-level code has no region that would free them later
+        for (size_t pc = 0; pc < count; ++pc) {
+            if (!loop.body[pc]) continue;
+            const LIR_Inst& inst = code[pc];
+            const bool leaves = inst.isReturn() || (is_jump(inst.op) && inst.imm < count && !loop.body[inst.imm]);
+            if (leaves && (inst.op == LIR_Op::Jump || inst.isReturn()) && !headers.count(pc)) {
+                release_before(pc, true);
+            } else if (leaves) {
+                std::vector<LIR_Inst> insts = release(pc);
+                auto& block = exit_blocks[pc];
+                block.insert(block.end(), insts.begin(), insts.end());
+            }
+            if (inst.op != LIR_Op::Jump && !inst.isReturn() && pc + 1 < count && !loop.body[pc + 1]) {
+                release_before(pc + 1, false);
+            }
+        }
+    }
+
+    for (auto& [pc, block] : exit_blocks) {
+        LIR_Inst jump(LIR_Op::Jump, 0, 0, 0, code[pc].imm);
+        jump.loc = code[pc].loc;
+        code[pc].imm = static_cast<Imm>(code.size());
+        code.insert(code.end(), block.begin(), block.end());
+        code.push_back(jump);
+    }
+    splice(std::move(insertions));
+}
+
+void EscapeAnalysis::splice(std::vector<Insertion> insertions) {
+    if (insertions.empty()) return;
+    auto& code = func_.instructions;
+
+    // Entries that do not take jumps go first so that jump targets can point
+    // at the first one that does
+    std::stable_sort(insertions.begin(), insertions.end(), [](const Insertion& x, const Insertion& y) {
+        return x.before != y.before ? x.before < y.before : (!x.takes_jumps && y.takes_jumps);
+    });
+
+    std::vector<LIR_Inst> result;
+    result.reserve(code.size() + insertions.size());
+    std::vector<size_t> target(code.size() + 1);
+    size_t next = 0;
+    for (size_t pc = 0; pc < code.size(); ++pc) {
+        bool targeted = false;
+        for (; next < insertions.size() && insertions[next].before == pc; ++next) {
+            if (insertions[next].takes_jumps && !targeted) {
+                target[pc] = result.size();
+                targeted = true;
+            }
+            result.push_back(insertions[next].inst);
+        }
+        if (!targeted) target[pc] = result.size();
+        result.push_back(code[pc]);
+    }
+    target[code.size()] = result.size();
+
+    for (LIR_Inst& inst : result) {
+        if (is_jump(inst.op) && inst.imm < target.size()) inst.imm = static_cast<Imm>(target[inst.imm]);
+    }
+    code = std::move(result);
+}
+
+} // namespace LIR
+} // namespace LM
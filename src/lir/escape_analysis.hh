@@ -0,0 +1,67 @@
+#pragma once
+
+#include "lir.hh"
+#include <vector>
+
+namespace LM {
+namespace LIR {
+
+// Moves allocations whose result provably dies inside a scope into a region
+// that the runtime releases wholesale when the scope ends. The scopes are
+// natural loops, released at every back-edge and every edge that leaves
+// them, and non-top-level functions, released at every return. An object escapes when any register that can
+// hold it is stored into another object, a global or a channel, passed to
+// a call, returned, or still live when its loop iterates or exits.
+// Registers that held released objects are cleared before each release.
+// It also turns builds that extend a string held by a register nobody else
+// sees into in-place appends, and keeps tuples of up to MAX_SCALAR_TUPLE
+// elements that never escape in registers instead of allocating them.
+class EscapeAnalysis {
+public:
+    static constexpr uint64_t MAX_SCALAR_TUPLE = 4;
+
+    explicit EscapeAnalysis(LIR_Function& func) : func_(func) {}
+
+    /**
+     * @brief Mark non-escaping allocations and insert the RegionEnter/RegionExit ops that free them
+     * @return true if any allocation was moved into a region
+     */
+    bool run();
+
+private:
+    struct Loop {
+        size_t header;
+        std::vector<size_t> latches;  // Sources of the back-edges to header
+        std::vector<bool> body;
+        size_t size = 0;
+        bool has_region = false;
+        std::vector<Reg> released;  // Registers that may hold objects the loop releases
+    };
+
+    struct Insertion {
+        size_t before;
+        bool takes_jumps;  // Jumps to `before` run this instruction first
+        LIR_Inst inst;
+    };
+
+    LIR_Function& func_;
+    std::vector<std::vector<size_t>> successors_;
+    std::vector<std::vector<size_t>> predecessors_;
+    std::vector<Loop> loops_;
+
+    void build_cfg();
+    void find_loops();
+    Loop* innermost_loop(size_t pc);
+    std::vector<Reg> aliases_of(Reg reg) const;
+    bool escapes(const std::vector<Reg>& aliases) const;
+    bool only_read(Reg reg) const;
+    void promote_appends();
+    void scalar_replace_tuples();
+    std::vector<bool> live_in(Reg reg) const;
+    bool dies_in_iteration(const Loop& loop, const std::vector<Reg>& aliases) const;
+    void insert_region_ops(bool function_region);
+    void splice(std::vector<Insertion> insertions);  // Insert before the given pcs and retarget jumps
+};
+
+} // namespace LIR
+} // namespace LM
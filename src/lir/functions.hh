@@ -7,6 +7,7 @@
 #include <functional>
 #include <memory>
 #include <optional>
+#include <algorithm>
 #include "lir.hh"
 #include "../backend/value.hh"
 #include "../backend/types.hh"
@@ -50,6 +51,9 @@ private:
     
     // Store the LIR instructions for this function
     std::vector<LIR::LIR_Inst> instructions_;
+    
+    // Size of the register window the VM reserves for each activation
+    uint32_t register_count_ = 0;
 
 public:
     LIRFunction(const std::string& name, 
@@ -71,6 +75,12 @@ public:
     // LIR instruction access
     const std::vector<LIR::LIR_Inst>& getInstructions() const { return instructions_; }
     void setInstructions(const std::vector<LIR::LIR_Inst>& instructions) { instructions_ = instructions; }
+    
+    // Register window size (never smaller than the parameter count)
+    uint32_t getRegisterCount() const {
+        return std::max(register_count_, static_cast<uint32_t>(parameters_.size()));
+    }
+    void setRegisterCount(uint32_t count) { register_count_ = count; }
 };
 
 // Manager for LIR-specific functions
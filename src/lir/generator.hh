@@ -31,6 +31,11 @@ public:
     void set_import_aliases(const std::unordered_map<std::string, std::string>& aliases) {
         import_aliases_ = aliases;
     }
+
+    // Source file recorded in instruction locations
+    void set_source_file(const std::string& filename) {
+        source_file_ = filename;
+    }
     
     // Set registered modules from type checker
     void set_registered_modules(const std::unordered_map<std::string, LM::Frontend::ModuleInfo>& modules) {
@@ -132,6 +137,7 @@ private:
     TypePtr get_promoted_numeric_type(TypePtr left_type, TypePtr right_type);
     bool is_signed_integer_type(TypePtr type);
     bool is_decimal_type(TypePtr type);
+    bool is_string_type(TypePtr type);
     int get_decimal_scale(TypePtr type);
     TypePtr get_wider_integer_type(TypePtr left_type, TypePtr right_type);
     TypePtr get_unsigned_version(TypePtr type);
@@ -173,6 +179,10 @@ private:
     Reg emit_literal_expr(LM::Frontend::AST::LiteralExpr& expr, TypePtr expected_type = nullptr);
     Reg emit_variable_expr(LM::Frontend::AST::VariableExpr& expr);
     Reg emit_interpolated_string_expr(LM::Frontend::AST::InterpolatedStringExpr& expr);
+    Reg emit_string_build(LM::Frontend::AST::Expression& expr);
+    void collect_string_parts(LM::Frontend::AST::Expression& expr, std::vector<Reg>& parts);
+    Reg emit_decimal_text(Reg value);
+    LIR_Inst* fresh_string_build(LM::Frontend::AST::Expression& expr, Reg value);
     Reg emit_binary_expr(LM::Frontend::AST::BinaryExpr& expr);
     Reg emit_unary_expr(LM::Frontend::AST::UnaryExpr& expr);
     Reg emit_grouping_expr(LM::Frontend::AST::GroupingExpr& expr);
@@ -241,12 +251,7 @@ private:
     void emit_concurrent_worker_init(LM::Frontend::AST::WorkerStatement& worker, size_t worker_id, Reg scheduler_reg, Reg channel_reg);
     void emit_worker_stmt(LM::Frontend::AST::WorkerStatement& stmt);
     void emit_iter_stmt(LM::Frontend::AST::IterStatement& stmt);
-    void emit_dict_iter_stmt(LM::Frontend::AST::IterStatement& stmt, LM::Frontend::AST::DictExpr& dict_expr);
-    void emit_list_iter_stmt(LM::Frontend::AST::IterStatement& stmt, LM::Frontend::AST::ListExpr& list_expr);
-    void emit_tuple_iter_stmt(LM::Frontend::AST::IterStatement& stmt, LM::Frontend::AST::TupleExpr& tuple_expr);
-    void emit_dict_var_iter_stmt(LM::Frontend::AST::IterStatement& stmt, Reg dict_reg);
-    void emit_list_var_iter_stmt(LM::Frontend::AST::IterStatement& stmt, Reg list_reg);
-    void emit_tuple_var_iter_stmt(LM::Frontend::AST::IterStatement& stmt, Reg tuple_reg, int64_t tuple_len);
+    void emit_collection_iter_stmt(LM::Frontend::AST::IterStatement& stmt, Reg iterable_reg, bool is_dict);
     void emit_break_stmt(LM::Frontend::AST::BreakStatement& stmt);
     void emit_continue_stmt(LM::Frontend::AST::ContinueStatement& stmt);
     void emit_unsafe_stmt(LM::Frontend::AST::UnsafeStatement& stmt);
@@ -296,6 +301,8 @@ private:
     static size_t lambda_counter_;
     uint32_t next_register_ = 0;
     uint32_t next_label_ = 0;
+    std::string source_file_;
+    uint32_t current_line_ = 0;  // Line of the statement being lowered
     std::map<std::string, TypePtr> variable_types_;
     std::shared_ptr<TypeSystem> type_system_;
     std::string current_function_name_;
@@ -280,7 +280,7 @@ void Generator::emit_concurrent_stmt(LM::Frontend::AST::ConcurrentStatement& stm
                                     // Set task function name in field 4
                                     Reg task_name_reg = allocate_register();
                                     auto string_type = std::make_shared<::Type>(::TypeTag::String);
-                                    Backend::Value task_name_val = BOX_PTR(lm_box_string(task_name.c_str()));
+                                    Backend::Value task_name_val = BOX_PTR(lm_string_new(task_name.data(), task_name.size()));
                                     emit_instruction(LIR_Inst(LIR_Op::LoadConst, Type::Ptr, task_name_reg, task_name_val));
                                     emit_instruction(LIR_Inst(LIR_Op::TaskSetField, Type::Void, task_name_reg, context_id_reg, 0, 4));
                                     
@@ -347,7 +347,7 @@ void Generator::emit_concurrent_stmt(LM::Frontend::AST::ConcurrentStatement& stm
                         // Set worker function name in field 4
                         Reg worker_name_reg = allocate_register();
                         auto string_type = std::make_shared<::Type>(::TypeTag::String);
-                        Backend::Value worker_name_val = BOX_PTR(lm_box_string(worker_name.c_str()));
+                        Backend::Value worker_name_val = BOX_PTR(lm_string_new(worker_name.data(), worker_name.size()));
                         emit_instruction(LIR_Inst(LIR_Op::LoadConst, Type::Ptr, worker_name_reg, worker_name_val));
                         emit_instruction(LIR_Inst(LIR_Op::TaskSetField, Type::Void, worker_name_reg, context_id_reg, 0, 4));
                        // std::cout << "[DEBUG] Worker function name field set" << std::endl;
@@ -379,7 +379,7 @@ void Generator::emit_concurrent_stmt(LM::Frontend::AST::ConcurrentStatement& stm
                         
                         Reg worker_name_reg = allocate_register();
                         auto string_type = std::make_shared<::Type>(::TypeTag::String);
-                        Backend::Value worker_name_val = BOX_PTR(lm_box_string(worker_name.c_str()));
+                        Backend::Value worker_name_val = BOX_PTR(lm_string_new(worker_name.data(), worker_name.size()));
                         emit_instruction(LIR_Inst(LIR_Op::LoadConst, Type::Ptr, worker_name_reg, worker_name_val));
                         emit_instruction(LIR_Inst(LIR_Op::TaskSetField, Type::Void, worker_name_reg, context_id_reg, 0, 4));
                         
@@ -695,7 +695,7 @@ void Generator::emit_task_init_and_step(LM::Frontend::AST::TaskStatement& task,
             // Store the task function name in the task context for the scheduler to call
             Reg func_name_reg = allocate_register();
             auto string_type = std::make_shared<::Type>(::TypeTag::String);
-            Backend::Value func_name_val = BOX_PTR(lm_box_string(task.task_function_name.c_str()));
+            Backend::Value func_name_val = BOX_PTR(lm_string_new(task.task_function_name.data(), task.task_function_name.size()));
             emit_instruction(LIR_Inst(LIR_Op::LoadConst, Type::Ptr, func_name_reg, func_name_val));
             set_register_type(func_name_reg, string_type);
             
@@ -3,6 +3,7 @@
 #include "../../frontend/module_manager.hh"
 #include "../function_registry.hh"
 #include "../builtin_functions.hh"
+#include "../escape_analysis.hh"
 #include "../../frontend/ast.hh"
 #include "../../frontend/scanner.hh"
 #include <algorithm>
@@ -218,6 +219,7 @@ void Generator::generate_function(LM::Frontend::AST::FunctionDeclaration& fn) {
 
     auto lir_func = std::make_shared<LIRFunction>(fn.name, params, return_abi_type, nullptr);
     lir_func->setInstructions(result->instructions);
+    lir_func->setRegisterCount(result->register_count);
     
     // Optimize the generated LIR for this function
     if (false && Generator::is_optimization_enabled()) {
@@ -424,15 +426,32 @@ ValuePtr Generator::get_register_value(Reg reg) {
 
 void Generator::emit_instruction(const LIR_Inst& inst) {
     if (current_function_) {
+        LIR_Inst located = inst;
+        if (located.loc.line == 0 && current_line_ != 0) {
+            located.loc = LIR_SourceLoc(source_file_, current_line_);
+        }
+
+        // Record operand types so the VM can pick specialized arithmetic
+        switch (located.op) {
+            case LIR_Op::Add: case LIR_Op::Sub: case LIR_Op::Mul: case LIR_Op::Div:
+            case LIR_Op::CmpEQ: case LIR_Op::CmpNEQ: case LIR_Op::CmpLT:
+            case LIR_Op::CmpLE: case LIR_Op::CmpGT: case LIR_Op::CmpGE:
+                if (located.type_a == Type::Void) located.type_a = language_type_to_abi_type(get_register_type(located.a));
+                if (located.type_b == Type::Void) located.type_b = language_type_to_abi_type(get_register_type(located.b));
+                break;
+            default:
+                break;
+        }
+
         if (cfg_context_.building_cfg && cfg_context_.current_block) {
             if (cfg_context_.current_block->has_terminator()) {
                 // If the block is already terminated, create a new block for subsequent instructions
                 LIR_BasicBlock* new_block = create_basic_block("unreachable");
                 set_current_block(new_block);
             }
-            cfg_context_.current_block->add_instruction(inst);
+            cfg_context_.current_block->add_instruction(located);
         } else {
-            current_function_->instructions.push_back(inst);
+            current_function_->instructions.push_back(located);
         }
         
         current_function_->register_count = std::max(current_function_->register_count, next_register_);
@@ -603,6 +622,12 @@ void Generator::finish_cfg_build() {
     
     // Flatten CFG blocks into linear instruction stream for JIT consumption
     flatten_cfg_to_instructions();
+
+    // Allocations that die within a loop iteration or call go to a region
+    if (is_optimization_enabled()) {
+        EscapeAnalysis(*current_function_).run();
+        next_register_ = std::max(next_register_, current_function_->register_count);
+    }
     
     cfg_context_.current_block = nullptr;
     cfg_context_.entry_block = nullptr;
@@ -6,6 +6,7 @@
 #include "../builtin_functions.hh"
 #include "../../frontend/ast.hh"
 #include "../../frontend/scanner.hh"
+#include "../../runtime/runtime_list.h"
 #include <algorithm>
 #include <map>
 #include <limits>
@@ -220,6 +221,11 @@ bool Generator::is_decimal_type(TypePtr type) {
 }
 
 
+bool Generator::is_string_type(TypePtr type) {
+    return type && type->tag == ::TypeTag::String;
+}
+
+
 int Generator::get_decimal_scale(TypePtr type) {
     if (!type) return 0;
     switch (type->tag) {
@@ -395,7 +401,9 @@ Reg Generator::emit_literal_expr(LM::Frontend::AST::LiteralExpr& expr, TypePtr e
         bool isNumeric = false;
         bool isFloat = false;
         
-        if (!stringValue.empty()) {
+        // String literals whose text looks like a number ("0.1") stay strings
+        bool isStringLiteral = expr.inferred_type && expr.inferred_type->tag == ::TypeTag::String;
+        if (!stringValue.empty() && !isStringLiteral) {
             char first = stringValue[0];
             if (std::isdigit(first) || first == '+' || first == '-' || first == '.') {
                 // Check if the ENTIRE string is a valid number
@@ -585,13 +593,10 @@ Reg Generator::emit_variable_expr(LM::Frontend::AST::VariableExpr& expr) {
         }
     }
 
-    // Check if it's a global module variable accessed directly (e.g. within the module itself)
-    if (!current_module_.empty() && current_module_ != "root") {
+    // Check if it's a global module variable accessed directly (e.g. within the module itself);
+    // locals fall through to the regular scope lookup below so they pick up their types
+    if (!current_module_.empty() && current_module_ != "root" && resolve_variable(expr.name) == UINT32_MAX) {
         std::string qualified_name = current_module_ + "." + expr.name;
-        Reg reg = resolve_variable(expr.name);
-        if (reg != UINT32_MAX) return reg;
-
-        // If not local, try LoadGlobal
         Reg result = allocate_register();
         LIR_Inst load_inst(LIR_Op::LoadGlobal, Type::Ptr, result, 0, 0);
         load_inst.func_name = qualified_name;
@@ -642,10 +647,11 @@ Reg Generator::emit_variable_expr(LM::Frontend::AST::VariableExpr& expr) {
             
             Reg func_reg = allocate_register();
             auto func_type = std::make_shared<::Type>(::TypeTag::Function);
-            // In our LIR/VM, functions are referred to by name strings
-            auto string_type = std::make_shared<::Type>(::TypeTag::String);
-            Backend::Value name_val = BOX_PTR(lm_box_string(expr.name.c_str()));
-            emit_instruction(LIR_Inst(LIR_Op::LoadConst, Type::Ptr, func_reg, name_val));
+            // The name constant is replaced by a function handle when the program is linked
+            Backend::Value name_val = BOX_PTR(lm_string_new(expr.name.data(), expr.name.size()));
+            LIR_Inst load_func(LIR_Op::LoadConst, Type::Ptr, func_reg, name_val);
+            load_func.func_name = expr.name;
+            emit_instruction(load_func);
             set_register_language_type(func_reg, func_type);
             set_register_abi_type(func_reg, Type::Ptr);
             return func_reg;
@@ -686,8 +692,9 @@ Reg Generator::emit_variable_expr(LM::Frontend::AST::VariableExpr& expr) {
         set_register_type(reg, expr.inferred_type);
         set_register_language_type(reg, expr.inferred_type);
         set_register_abi_type(reg, language_type_to_abi_type(expr.inferred_type));
-    } else {
-        // Set a default type if no inference is available
+    } else if (!get_register_type(reg)) {
+        // Set a default type if no inference is available, keeping the type
+        // the variable was declared with
         auto any_type = std::make_shared<::Type>(::TypeTag::Any);
         set_register_type(reg, any_type);
     }
@@ -701,7 +708,7 @@ Reg Generator::emit_interpolated_string_expr(LM::Frontend::AST::InterpolatedStri
 
     if (expr.parts.empty()) {
         Reg result = allocate_register();
-        Backend::Value result_val = BOX_PTR(lm_box_string(""));
+        Backend::Value result_val = BOX_PTR(lm_string_new_cstr(""));
         emit_instruction(LIR_Inst(LIR_Op::LoadConst, Type::Ptr, result, result_val));
         set_register_language_type(result, string_type);
         return result;
@@ -723,64 +730,109 @@ Reg Generator::emit_interpolated_string_expr(LM::Frontend::AST::InterpolatedStri
     // Constant folding: if all parts are string literals, fold them
     if (all_parts_are_string_literals) {
         Reg result = allocate_register();
-        Backend::Value result_val = BOX_PTR(lm_box_string(folded_result.c_str()));
+        Backend::Value result_val = BOX_PTR(lm_string_new(folded_result.data(), folded_result.size()));
         emit_instruction(LIR_Inst(LIR_Op::LoadConst, Type::Ptr, result, result_val));
         set_register_language_type(result, string_type);
         return result;
     }
 
-    // For complex interpolations, use STR_FORMAT
-    // Build format string and collect argument registers
-    std::string format_string = "";
-    std::vector<Reg> arg_regs;
-    
-    for (const auto& part : expr.parts) {
-        if (std::holds_alternative<std::string>(part)) {
-            format_string += std::get<std::string>(part);
-        } else if (std::holds_alternative<std::shared_ptr<LM::Frontend::AST::Expression>>(part)) {
-            format_string += "%s" ; // Use standard format marker
-            auto expr_part = std::get<std::shared_ptr<LM::Frontend::AST::Expression>>(part);
-            Reg expr_reg = emit_expr(*expr_part);
-            arg_regs.push_back(expr_reg);
-        }
-    }
-    
-    // Emit STR_FORMAT instruction
+    return emit_string_build(expr);
+}
+
+
+// Strings built from several pieces, concatenations and interpolations
+// alike, are joined by a single STR_BUILD over all of their parts
+Reg Generator::emit_string_build(LM::Frontend::AST::Expression& expr) {
+    std::vector<Reg> parts;
+    collect_string_parts(expr, parts);
     Reg result = allocate_register();
-    Reg format_reg = allocate_register();
-    Backend::Value format_val = BOX_PTR(lm_box_string(format_string.c_str()));
-    emit_instruction(LIR_Inst(LIR_Op::LoadConst, Type::Ptr, format_reg, format_val));
-    
-    // Handle multiple arguments by chaining STR_FORMAT calls
-    Reg current_result = format_reg;
-    for (size_t i = 0; i < arg_regs.size(); i++) {
-        if (i == 0) {
-            // First argument: format with first arg
-            emit_instruction(LIR_Inst(LIR_Op::STR_FORMAT, result, format_reg, arg_regs[i]));
-            current_result = result;
-        } else {
-            // Subsequent arguments: format previous result with next arg
-            Reg temp_result = allocate_register();
-            emit_instruction(LIR_Inst(LIR_Op::STR_FORMAT, temp_result, current_result, arg_regs[i]));
-            current_result = temp_result;
-            if (i == arg_regs.size() - 1) {
-                // Final result is in temp_result, move to result register
-                emit_instruction(LIR_Inst(LIR_Op::Mov, result, temp_result, 0));
+    emit_instruction(LIR_Inst(LIR_Op::STR_BUILD, result, "", parts));
+    set_register_language_type(result, std::make_shared<::Type>(::TypeTag::String));
+    return result;
+}
+
+
+// The STR_BUILD just emitted for expr, whose result is a temporary that
+// nothing else refers to yet
+LIR_Inst* Generator::fresh_string_build(LM::Frontend::AST::Expression& expr, Reg value) {
+    if (!dynamic_cast<LM::Frontend::AST::BinaryExpr*>(&expr) &&
+        !dynamic_cast<LM::Frontend::AST::InterpolatedStringExpr*>(&expr)) {
+        return nullptr;
+    }
+    auto& code = cfg_context_.building_cfg && cfg_context_.current_block ? cfg_context_.current_block->instructions
+                                                                         : current_function_->instructions;
+    if (code.empty() || code.back().op != LIR_Op::STR_BUILD || code.back().dst != value) return nullptr;
+    return &code.back();
+}
+
+
+void Generator::collect_string_parts(LM::Frontend::AST::Expression& expr, std::vector<Reg>& parts) {
+    if (auto binary = dynamic_cast<LM::Frontend::AST::BinaryExpr*>(&expr)) {
+        if (binary->op == LM::Frontend::TokenType::PLUS && is_string_type(binary->inferred_type)) {
+            collect_string_parts(*binary->left, parts);
+            collect_string_parts(*binary->right, parts);
+            return;
+        }
+    } else if (auto grouping = dynamic_cast<LM::Frontend::AST::GroupingExpr*>(&expr)) {
+        collect_string_parts(*grouping->expression, parts);
+        return;
+    } else if (auto interpolated = dynamic_cast<LM::Frontend::AST::InterpolatedStringExpr*>(&expr)) {
+        for (const auto& part : interpolated->parts) {
+            if (std::holds_alternative<std::string>(part)) {
+                const std::string& text = std::get<std::string>(part);
+                if (text.empty()) continue;
+                Reg text_reg = allocate_register();
+                Backend::Value text_val = BOX_PTR(lm_string_new(text.data(), text.size()));
+                emit_instruction(LIR_Inst(LIR_Op::LoadConst, Type::Ptr, text_reg, text_val));
+                set_register_language_type(text_reg, std::make_shared<::Type>(::TypeTag::String));
+                parts.push_back(text_reg);
+            } else {
+                collect_string_parts(*std::get<std::shared_ptr<LM::Frontend::AST::Expression>>(part), parts);
             }
         }
+        return;
     }
-    
-    set_register_language_type(result, string_type);
-    return result;
+    parts.push_back(emit_decimal_text(emit_expr(expr)));
+}
+
+
+// Decimals are held as scaled integers, so they are turned into text with
+// their scale before anything formats them
+Reg Generator::emit_decimal_text(Reg value) {
+    TypePtr type = get_register_language_type(value);
+    if (!is_decimal_type(type)) type = get_register_type(value);
+    if (!is_decimal_type(type)) return value;
+    Reg text = allocate_register();
+    emit_instruction(LIR_Inst(LIR_Op::ToString, Type::Ptr, text, value, 0, get_decimal_scale(type)));
+    set_register_language_type(text, std::make_shared<::Type>(::TypeTag::String));
+    return text;
 }
 
 
 Reg Generator::emit_binary_expr(LM::Frontend::AST::BinaryExpr& expr) {
+    if ((expr.op == LM::Frontend::TokenType::AND || expr.op == LM::Frontend::TokenType::OR) &&
+        !cfg_context_.building_cfg) {
+        // Linear mode (frame methods): patch the short-circuit jump past the right operand
+        Reg result = allocate_register();
+        set_register_language_type(result, std::make_shared<::Type>(::TypeTag::Bool));
+        set_register_type(result, std::make_shared<::Type>(::TypeTag::Bool));
+        Reg left = emit_expr(*expr.left);
+        emit_instruction(LIR_Inst(LIR_Op::Mov, Type::Bool, result, left, 0));
+        size_t skip_pc = current_function_->instructions.size();
+        LIR_Op skip_op = expr.op == LM::Frontend::TokenType::AND ? LIR_Op::JumpIfFalse : LIR_Op::JumpIf;
+        emit_instruction(LIR_Inst(skip_op, Type::Void, 0, left, 0, 0));
+        Reg right = emit_expr(*expr.right);
+        emit_instruction(LIR_Inst(LIR_Op::Mov, Type::Bool, result, right, 0));
+        current_function_->instructions[skip_pc].imm = (Imm)current_function_->instructions.size();
+        return result;
+    }
+
     if (expr.op == LM::Frontend::TokenType::AND || expr.op == LM::Frontend::TokenType::OR) {
         LIR_BasicBlock* right_block = create_basic_block("logic_right");
         LIR_BasicBlock* end_block = create_basic_block("logic_end");
         Reg result = allocate_register();
         set_register_language_type(result, std::make_shared<::Type>(::TypeTag::Bool));
+        set_register_type(result, std::make_shared<::Type>(::TypeTag::Bool));
         Reg left = emit_expr(*expr.left);
         if (expr.op == LM::Frontend::TokenType::AND) {
             emit_instruction(LIR_Inst(LIR_Op::Mov, Type::Bool, result, left, 0));
@@ -802,12 +854,16 @@ Reg Generator::emit_binary_expr(LM::Frontend::AST::BinaryExpr& expr) {
         return result;
     }
 
+    if (expr.op == LM::Frontend::TokenType::PLUS && is_string_type(expr.inferred_type)) {
+        return emit_string_build(expr);
+    }
+
+    // Emit left and right operands once; PLUS needs their types to pick concat vs add
+    Reg left = emit_expr(*expr.left);
+    Reg right = emit_expr(*expr.right);
+
     // Handle PLUS operator - check for string concatenation first
     if (expr.op == LM::Frontend::TokenType::PLUS) {
-        // Emit left and right operands FIRST to get their types
-        Reg left = emit_expr(*expr.left);
-        Reg right = emit_expr(*expr.right);
-        
         TypePtr left_type = get_register_type(left);
         TypePtr right_type = get_register_type(right);
         
@@ -816,34 +872,16 @@ Reg Generator::emit_binary_expr(LM::Frontend::AST::BinaryExpr& expr) {
         bool right_is_string = (right_type && right_type->tag == ::TypeTag::String);
         
         if (left_is_string || right_is_string) {
-            // Convert non-string operand to string using ToString
-            if (!left_is_string) {
-                Reg str_left = allocate_register();
-                emit_instruction(LIR_Inst(LIR_Op::ToString, Type::Ptr, str_left, left, 0));
-                auto string_type = std::make_shared<::Type>(::TypeTag::String);
-                set_register_language_type(str_left, string_type);
-                left = str_left;
-            }
-            if (!right_is_string) {
-                Reg str_right = allocate_register();
-                emit_instruction(LIR_Inst(LIR_Op::ToString, Type::Ptr, str_right, right, 0));
-                auto string_type = std::make_shared<::Type>(::TypeTag::String);
-                set_register_language_type(str_right, string_type);
-                right = str_right;
-            }
-            
-            // Perform string concatenation
+            // The build formats the non-string operand itself
             Reg dst = allocate_register();
             auto string_type = std::make_shared<::Type>(::TypeTag::String);
             set_register_language_type(dst, string_type);
-            emit_instruction(LIR_Inst(LIR_Op::STR_CONCAT, Type::Ptr, dst, left, right));
+            emit_instruction(LIR_Inst(LIR_Op::STR_BUILD, dst, "", std::vector<Reg>{emit_decimal_text(left), emit_decimal_text(right)}));
             return dst;
         }
     }
     
     // Handle as arithmetic operation
-    Reg left = emit_expr(*expr.left);
-    Reg right = emit_expr(*expr.right);
     Reg dst = allocate_register();
     
     // Map operator to LIR operation
@@ -949,7 +987,7 @@ Reg Generator::emit_binary_expr(LM::Frontend::AST::BinaryExpr& expr) {
                 Reg rescaled_left = allocate_register();
                 Type target_abi = Type::I64;
                 TypePtr target_type = (max_scale == 4) ? type_system_->getType("d4") : (max_scale == 6 ? type_system_->getType("d6") : type_system_->getType("d2"));
-                emit_instruction(LIR_Inst(LIR_Op::DecRescale, target_abi, rescaled_left, left, 0));
+                emit_instruction(LIR_Inst(LIR_Op::DecRescale, target_abi, rescaled_left, left, 0, max_scale - left_scale));
                 set_register_language_type(rescaled_left, target_type);
                 set_register_type(rescaled_left, target_type);
                 left = rescaled_left;
@@ -959,16 +997,17 @@ Reg Generator::emit_binary_expr(LM::Frontend::AST::BinaryExpr& expr) {
                 Reg rescaled_right = allocate_register();
                 Type target_abi = Type::I64;
                 TypePtr target_type = (max_scale == 4) ? type_system_->getType("d4") : (max_scale == 6 ? type_system_->getType("d6") : type_system_->getType("d2"));
-                emit_instruction(LIR_Inst(LIR_Op::DecRescale, target_abi, rescaled_right, right, 0));
+                emit_instruction(LIR_Inst(LIR_Op::DecRescale, target_abi, rescaled_right, right, 0, max_scale - right_scale));
                 set_register_language_type(rescaled_right, target_type);
                 set_register_type(rescaled_right, target_type);
                 right = rescaled_right;
                 right_type = target_type;
             }
 
+            // Products and quotients are rescaled by 10^max_scale, carried in imm
             result_type = left_type; // Both now have max_scale
             set_register_type(dst, result_type);
-            emit_instruction(LIR_Inst(op, Type::I64, dst, left, right));
+            emit_instruction(LIR_Inst(op, Type::I64, dst, left, right, max_scale));
             return dst;
         }
 
@@ -2015,10 +2054,16 @@ Reg Generator::emit_assign_expr(LM::Frontend::AST::AssignExpr& expr) {
             if (expr.op == LM::Frontend::TokenType::PLUS_EQUAL) {
                 // Get the type of the left operand (current variable value)
                 TypePtr dst_type = get_register_type(dst);
-                if (dst_type && dst_type->tag == TypeTag::String) {
-                    // String += something -> use string concatenation
+                if (is_string_type(dst_type) || is_string_type(expr.inferred_type)) {
+                    // String += something -> build into the variable, taking
+                    // over the parts of a build that produced the value
                     auto string_type = std::make_shared<::Type>(::TypeTag::String);
-                    emit_instruction(LIR_Inst(LIR_Op::STR_CONCAT, Type::Ptr, dst, dst, value));
+                    if (LIR_Inst* build = fresh_string_build(*expr.value, value)) {
+                        build->dst = dst;
+                        build->call_args.insert(build->call_args.begin(), dst);
+                    } else {
+                        emit_instruction(LIR_Inst(LIR_Op::STR_BUILD, dst, "", std::vector<Reg>{dst, value}));
+                    }
                     set_register_type(dst, string_type);
                     return dst;
                 }
@@ -2045,6 +2090,15 @@ Reg Generator::emit_assign_expr(LM::Frontend::AST::AssignExpr& expr) {
                     return 0;
             }
         } else {
+            // s = s + ... builds straight into s, which lets the escape
+            // analysis turn it into an in-place append
+            LIR_Inst* build = fresh_string_build(*expr.value, value);
+            if (build && !build->call_args.empty() && build->call_args[0] == dst) {
+                build->dst = dst;
+                set_register_type(dst, get_register_type(value));
+                return dst;
+            }
+
             // Simple assignment - just move the value
             // Set type BEFORE emitting so it's available during emit_instruction
             set_register_type(dst, get_register_type(value));
@@ -2184,13 +2238,39 @@ Reg Generator::emit_call_closure_expr(LM::Frontend::AST::CallClosureExpr& expr)
 }
 
 
+// Lists with a known int, float or bool element type start out unboxed
+static LmListKind list_kind_for(const TypePtr& list_type) {
+    auto* list = list_type ? std::get_if<ListType>(&list_type->extra) : nullptr;
+    if (!list || !list->elementType) return LM_LIST_VALUES;
+    switch (list->elementType->tag) {
+        case ::TypeTag::Int:
+        case ::TypeTag::Int8:
+        case ::TypeTag::Int16:
+        case ::TypeTag::Int32:
+        case ::TypeTag::Int64:
+        case ::TypeTag::UInt8:
+        case ::TypeTag::UInt16:
+        case ::TypeTag::UInt32:
+            return LM_LIST_I64;
+        case ::TypeTag::Float32:
+        case ::TypeTag::Float64:
+            return LM_LIST_F64;
+        case ::TypeTag::Bool:
+            return LM_LIST_BOOL;
+        default:
+            return LM_LIST_VALUES;
+    }
+}
+
+
 Reg Generator::emit_list_expr(LM::Frontend::AST::ListExpr& expr) {
-    // Create a new list using ListCreate operation
+    // Create a new list using ListCreate operation; imm selects the element
+    // representation
     Reg list_reg = allocate_register();
     Type abi_type = language_type_to_abi_type(expr.inferred_type);
     
     // Emit ListCreate instruction
-    emit_instruction(LIR_Inst(LIR_Op::ListCreate, abi_type, list_reg, 0, 0));
+    emit_instruction(LIR_Inst(LIR_Op::ListCreate, abi_type, list_reg, 0, 0, list_kind_for(expr.inferred_type)));
     set_register_type(list_reg, expr.inferred_type);
     
     // Append elements to the list
@@ -2231,8 +2311,10 @@ Reg Generator::emit_index_expr(LM::Frontend::AST::IndexExpr& expr) {
         result_type = std::make_shared<::Type>(::TypeTag::Any);
     }
     
-    // Check the object type to use the appropriate operation
+    // Check the object type to use the appropriate operation. Expressions
+    // in loop bodies may lack an inferred type; the register still has one.
     TypePtr object_type = get_register_language_type(object_reg);
+    if (!object_type) object_type = get_register_type(object_reg);
     if (object_type && object_type->tag == ::TypeTag::Tuple) {
         // Use TupleGet for tuples
         Reg result_reg = allocate_register();
@@ -2523,10 +2605,11 @@ Reg Generator::emit_lambda_expr(LM::Frontend::AST::LambdaExpr& expr) {
 
     // Create the lambda/closure object
     Reg func_reg = allocate_register();
-    auto string_type = std::make_shared<::Type>(::TypeTag::String);
-    Backend::Value name_val = BOX_PTR(lm_box_string(lambda_name.c_str()));
+    Backend::Value name_val = BOX_PTR(lm_string_new(lambda_name.data(), lambda_name.size()));
     Reg name_reg = allocate_register();
-    emit_instruction(LIR_Inst(LIR_Op::LoadConst, Type::Ptr, name_reg, name_val));
+    LIR_Inst load_func(LIR_Op::LoadConst, Type::Ptr, name_reg, name_val);
+    load_func.func_name = lambda_name;
+    emit_instruction(load_func);
 
     if (expr.capturedVars.empty()) {
         // Simple function pointer
@@ -91,6 +91,7 @@ void Generator::lower_trait_method(const std::string& trait_name, LM::Frontend::
     
     auto lir_func = func_manager.createFunction(full_method_name, params, Type::I64, nullptr);
     lir_func->setInstructions(result->instructions);
+    lir_func->setRegisterCount(result->register_count);
 }
 
 
@@ -209,6 +210,7 @@ void Generator::lower_frame_method(const std::string& frame_name, LM::Frontend::
     
     // Copy the instructions from our LIR_Function
     lir_func->setInstructions(result->instructions);
+    lir_func->setRegisterCount(result->register_count);
 
     // Update function table
     auto& func_info = function_table_[full_method_name];
@@ -311,6 +313,7 @@ void Generator::lower_frame_init_method(const std::string& frame_name, LM::Front
     
     // Copy the instructions from our LIR_Function
     lir_func->setInstructions(result->instructions);
+    lir_func->setRegisterCount(result->register_count);
 
     // Update function table
     auto& func_info = function_table_[full_method_name];
@@ -409,6 +412,7 @@ void Generator::lower_frame_deinit_method(const std::string& frame_name, LM::Fro
     
     // Copy the instructions from our LIR_Function
     lir_func->setInstructions(result->instructions);
+    lir_func->setRegisterCount(result->register_count);
 
     // Update function table
     auto& func_info = function_table_[full_method_name];
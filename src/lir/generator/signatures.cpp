@@ -71,20 +71,25 @@ void Generator::lower_function_bodies(const LM::Frontend::TypeCheckResult& type_
         std::string prev_mod = current_module_;
         current_module_ = path;
 
-        // 1. Lower module symbols
+        // 1. Register every module function first so calls between them
+        // resolve to the qualified name regardless of declaration order
+        for (const auto& stmt : module->ast->statements) {
+            if (auto func_stmt = std::dynamic_pointer_cast<LM::Frontend::AST::FunctionDeclaration>(stmt)) {
+                FunctionInfo info;
+                info.name = path + "." + func_stmt->name;
+                info.param_count = func_stmt->params.size();
+                info.optional_param_count = func_stmt->optionalParams.size();
+                info.has_closure = false;
+                info.visibility = func_stmt->visibility;
+                info.lir_function = nullptr;
+                function_table_[info.name] = std::move(info);
+            }
+        }
+
+        // 2. Lower module symbols
         for (const auto& stmt : module->ast->statements) {
             if (auto func_stmt = std::dynamic_pointer_cast<LM::Frontend::AST::FunctionDeclaration>(stmt)) {
                 std::string original_name = func_stmt->name;
-                {
-                    FunctionInfo info;
-                    info.name = path + "." + original_name;
-                    info.param_count = func_stmt->params.size();
-                    info.optional_param_count = func_stmt->optionalParams.size();
-                    info.has_closure = false;
-                    info.visibility = func_stmt->visibility;
-                    info.lir_function = nullptr;
-                    function_table_[info.name] = std::move(info);
-                }
                 func_stmt->name = path + "." + original_name;
                 generate_function(*func_stmt);
                 func_stmt->name = original_name;
@@ -101,7 +106,7 @@ void Generator::lower_function_bodies(const LM::Frontend::TypeCheckResult& type_
             }
         }
 
-        // 2. Generate .__init__ function for this module
+        // 3. Generate .__init__ function for this module
         std::string init_func_name = path + ".__init__";
         current_function_ = std::make_unique<LIR_Function>(init_func_name, 0);
         next_register_ = 0;
@@ -133,6 +138,7 @@ void Generator::lower_function_bodies(const LM::Frontend::TypeCheckResult& type_
         std::vector<LIRParameter> params;
         auto lir_func = LIRFunctionManager::getInstance().createFunction(init_func_name, params, Type::Void, nullptr);
         lir_func->setInstructions(result->instructions);
+        lir_func->setRegisterCount(result->register_count);
 
         current_module_ = prev_mod;
     }
@@ -140,7 +140,7 @@ void bind_all_vars(Generator* gen, std::shared_ptr<LM::Frontend::AST::Expression
     } else if (auto dict_p = std::dynamic_pointer_cast<LM::Frontend::AST::DictPatternExpr>(pattern)) {
         for (const auto& field : dict_p->fields) {
             Reg key_reg = gen->allocate_register();
-            gen->emit_instruction(LIR_Inst(LIR_Op::LoadConst, Type::Ptr, key_reg, BOX_PTR(lm_box_string(field.key.c_str()))));
+            gen->emit_instruction(LIR_Inst(LIR_Op::LoadConst, Type::Ptr, key_reg, BOX_PTR(lm_string_new(field.key.data(), field.key.size()))));
             Reg elem = gen->allocate_register();
             gen->emit_instruction(LIR_Inst(LIR_Op::DictGet, Type::Ptr, elem, val_reg, key_reg));
             bind_all_vars(gen, field.pattern, elem);
@@ -202,6 +202,14 @@ void bind_all_vars(Generator* gen, std::shared_ptr<LM::Frontend::AST::Expression
 void Generator::emit_stmt(LM::Frontend::AST::Statement& stmt) {
    // std::cout << "[DEBUG] emit_stmt called with type: " << typeid(stmt).name() << std::endl;
     
+    // Instructions take this statement's line; the enclosing line is restored on exit
+    struct LineScope {
+        uint32_t& line;
+        uint32_t saved;
+        ~LineScope() { line = saved; }
+    } line_scope{current_line_, current_line_};
+    if (stmt.line > 0) current_line_ = static_cast<uint32_t>(stmt.line);
+
     if (auto expr_stmt = dynamic_cast<LM::Frontend::AST::ExprStatement*>(&stmt)) {
        // std::cout << "[DEBUG] Emitting ExprStatement" << std::endl;
         emit_expr_stmt(*expr_stmt);
@@ -275,7 +283,7 @@ void Generator::emit_print_stmt(LM::Frontend::AST::PrintStatement& stmt) {
         // Empty print statement - just print a newline
         Reg newline_reg = allocate_register();
         auto string_type = std::make_shared<::Type>(::TypeTag::String);
-        Backend::Value newline_val = BOX_PTR(lm_box_string("\n"));
+        Backend::Value newline_val = BOX_PTR(lm_string_new_cstr("\n"));
         emit_instruction(LIR_Inst(LIR_Op::LoadConst, Type::Ptr, newline_reg, newline_val));
         emit_instruction(LIR_Inst(LIR_Op::PrintString, Type::Void, 0, newline_reg, 0));
         return;
@@ -288,54 +296,25 @@ void Generator::emit_print_stmt(LM::Frontend::AST::PrintStatement& stmt) {
         return;
     }
     
-    // Multiple arguments - concatenate them into a single string
-    Reg result_reg = emit_expr(*stmt.arguments[0]);
-    
-    // Convert first argument to string if it's not already
-    TypePtr first_type = get_register_language_type(result_reg);
-    if (!first_type || first_type->tag != ::TypeTag::String) {
-        Reg str_reg = allocate_register();
-        emit_instruction(LIR_Inst(LIR_Op::ToString, Type::Ptr, str_reg, result_reg, 0));
-        auto string_type = std::make_shared<::Type>(::TypeTag::String);
-        set_register_language_type(str_reg, string_type);
-        result_reg = str_reg;
-    }
-    
-    // Concatenate remaining arguments
+    // Multiple arguments - join them into a single string, with a space
+    // before the third and later ones, and before the second when the first
+    // is a string
+    std::vector<Reg> parts = {emit_decimal_text(emit_expr(*stmt.arguments[0]))};
+    TypePtr first_type = get_register_language_type(parts[0]);
     for (size_t i = 1; i < stmt.arguments.size(); ++i) {
-        Reg arg_reg = emit_expr(*stmt.arguments[i]);
-        
-        // Convert argument to string if it's not already
-        TypePtr arg_type = get_register_language_type(arg_reg);
-        if (!arg_type || arg_type->tag != ::TypeTag::String) {
-            Reg str_arg = allocate_register();
-            emit_instruction(LIR_Inst(LIR_Op::ToString, Type::Ptr, str_arg, arg_reg, 0));
-            auto string_type = std::make_shared<::Type>(::TypeTag::String);
-            set_register_language_type(str_arg, string_type);
-            arg_reg = str_arg;
-        }
-        
-        // Add a space between arguments
+        Reg arg_reg = emit_decimal_text(emit_expr(*stmt.arguments[i]));
         if (i > 1 || (first_type && first_type->tag == ::TypeTag::String)) {
             Reg space_reg = allocate_register();
-            auto string_type = std::make_shared<::Type>(::TypeTag::String);
-            Backend::Value space_val = BOX_PTR(lm_box_string(" "));
+            Backend::Value space_val = BOX_PTR(lm_string_new_cstr(" "));
             emit_instruction(LIR_Inst(LIR_Op::LoadConst, Type::Ptr, space_reg, space_val));
-            set_register_language_type(space_reg, string_type);
-            
-            Reg temp_reg = allocate_register();
-            emit_instruction(LIR_Inst(LIR_Op::STR_CONCAT, Type::Ptr, temp_reg, result_reg, space_reg));
-            set_register_language_type(temp_reg, string_type);
-            result_reg = temp_reg;
+            set_register_language_type(space_reg, std::make_shared<::Type>(::TypeTag::String));
+            parts.push_back(space_reg);
         }
-        
-        // Concatenate the argument
-        Reg concat_reg = allocate_register();
-        auto string_type = std::make_shared<::Type>(::TypeTag::String);
-        emit_instruction(LIR_Inst(LIR_Op::STR_CONCAT, Type::Ptr, concat_reg, result_reg, arg_reg));
-        set_register_language_type(concat_reg, string_type);
-        result_reg = concat_reg;
+        parts.push_back(arg_reg);
     }
+    Reg result_reg = allocate_register();
+    emit_instruction(LIR_Inst(LIR_Op::STR_BUILD, result_reg, "", parts));
+    set_register_language_type(result_reg, std::make_shared<::Type>(::TypeTag::String));
     
     // Print the final concatenated string
     emit_instruction(LIR_Inst(LIR_Op::PrintString, Type::Void, 0, result_reg, 0));
@@ -344,6 +323,7 @@ void Generator::emit_print_stmt(LM::Frontend::AST::PrintStatement& stmt) {
 
 void Generator::emit_print_value(Reg value) {
     // Helper function to print a single value based on its type
+    value = emit_decimal_text(value);
     TypePtr reg_type = get_register_language_type(value);
     if (reg_type) {
         switch (reg_type->tag) {
@@ -401,8 +381,10 @@ void Generator::emit_print_value(Reg value) {
 void Generator::emit_var_stmt(LM::Frontend::AST::VarDeclaration& stmt) {
    // std::cout << "[DEBUG] emit_var_stmt called for variable: " << stmt.name << std::endl;
 
-    // Check if this is a module-level variable (global)
-    if (!current_module_.empty() && current_module_ != "root") {
+    // Check if this is a module-level variable (global); locals inside the
+    // module's functions stay in registers like any other function's
+    if (!current_module_.empty() && current_module_ != "root" && current_function_ &&
+        current_function_->name == current_module_ + ".__init__" && scope_stack_.size() == 1) {
         std::string qualified_name = current_module_ + "." + stmt.name;
         Reg val_reg = 0;
         if (stmt.initializer) {
@@ -1112,14 +1094,8 @@ void Generator::emit_iter_stmt(LM::Frontend::AST::IterStatement& stmt) {
         exit_loop();
         exit_scope();
         
-    } else if (list_expr) {
-        emit_list_iter_stmt(stmt, *list_expr);
-        
-    } else if (dict_expr) {
-        emit_dict_iter_stmt(stmt, *dict_expr);
-        
-    } else if (tuple_expr) {
-        emit_tuple_iter_stmt(stmt, *tuple_expr);
+    } else if (list_expr || dict_expr || tuple_expr) {
+        emit_collection_iter_stmt(stmt, emit_expr(*stmt.iterable), dict_expr != nullptr);
         
     } else if (var_expr) {
         // Handle variable-based iteration (could be list, dict, tuple, or channel)
@@ -1140,21 +1116,9 @@ void Generator::emit_iter_stmt(LM::Frontend::AST::IterStatement& stmt) {
         }
 
         // Check if it's a list, dict, tuple, or channel
-        if (iterable_type->tag == TypeTag::List) {
-            emit_list_var_iter_stmt(stmt, iterable_reg);
-            
-        } else if (iterable_type->tag == TypeTag::Dict) {
-            emit_dict_var_iter_stmt(stmt, iterable_reg);
-            
-        } else if (iterable_type->tag == TypeTag::Tuple) {
-            // Get tuple size from type system
-            auto* tuple_type_ptr = std::get_if<TupleType>(&iterable_type->extra);
-            if (tuple_type_ptr) {
-                int64_t tuple_len = static_cast<int64_t>(tuple_type_ptr->elementTypes.size());
-                emit_tuple_var_iter_stmt(stmt, iterable_reg, tuple_len);
-            } else {
-                emit_tuple_var_iter_stmt(stmt, iterable_reg, 0);
-            }
+        if (iterable_type->tag == TypeTag::List || iterable_type->tag == TypeTag::Dict ||
+            iterable_type->tag == TypeTag::Tuple) {
+            emit_collection_iter_stmt(stmt, iterable_reg, iterable_type->tag == TypeTag::Dict);
             
         } else {
             // Handle channel iteration - requires exactly one loop variable
@@ -1229,472 +1193,77 @@ void Generator::emit_iter_stmt(LM::Frontend::AST::IterStatement& stmt) {
 }
 
 
-void Generator::emit_dict_iter_stmt(LM::Frontend::AST::IterStatement& stmt, LM::Frontend::AST::DictExpr& dict_expr) {
-    // Handle dict iteration (simplified - iterate over keys)
-    if (stmt.loopVars.size() != 1) {
-        report_error("dict iteration currently supports only one loop variable");
-        return;
-    }
-    const std::string& loop_var_name = stmt.loopVars[0];
-
-    LIR_BasicBlock* header_block = create_basic_block("dict_iter_header");
-    LIR_BasicBlock* body_block = create_basic_block("dict_iter_body");
-    LIR_BasicBlock* exit_block = create_basic_block("dict_iter_exit");
-
-    enter_scope();
-    enter_loop();
-    set_loop_labels(header_block->id, exit_block->id, 0);
-
-    // Create the dict
-    Reg dict_reg = emit_dict_expr(dict_expr);
-    
-    // Bind loop variable
-    Reg loop_var_reg = allocate_register();
-    bind_variable(loop_var_name, loop_var_reg);
-
-    // Initialize index to 0
-    Reg index_reg = allocate_register();
-    auto int_type = std::make_shared<::Type>(::TypeTag::Int64);
-    Backend::Value zero_val = make_i64(0);
-    emit_instruction(LIR_Inst(LIR_Op::LoadConst, Type::I64, index_reg, zero_val));
-    set_register_type(index_reg, int_type);
-
-    // Jump to header
-    emit_instruction(LIR_Inst(LIR_Op::Jump, 0, 0, 0, header_block->id));
-    add_block_edge(get_current_block(), header_block);
-
-    set_current_block(header_block);
-    
-    // Get dict size using entry count from AST
-    Reg size_reg = allocate_register();
-    auto size_type = std::make_shared<::Type>(::TypeTag::Int64);
-    Backend::Value size_val = make_i64(dict_expr.entries.size());
-    emit_instruction(LIR_Inst(LIR_Op::LoadConst, Type::I64, size_reg, size_val));
-    set_register_type(size_reg, size_type);
-    
-    // Compare index with size
-    Reg cmp_reg = allocate_register();
-    emit_instruction(LIR_Inst(LIR_Op::CmpLT, cmp_reg, index_reg, size_reg));
-    set_register_type(cmp_reg, std::make_shared<::Type>(::TypeTag::Bool));
-    
-    // Jump to exit if index >= size
-    emit_instruction(LIR_Inst(LIR_Op::JumpIfFalse, 0, cmp_reg, 0, exit_block->id));
-    add_block_edge(header_block, body_block);
-    add_block_edge(header_block, exit_block);
-
-    set_current_block(body_block);
-    
-    // For a more realistic implementation, we need to extract keys from the dict at runtime
-    // For now, we'll use a simplified approach that creates keys based on the index
-    // In a full implementation, this would involve proper dict key extraction methods
-    
-    // Extract key from dict at current index
-    Reg key_reg = allocate_register();
-    auto key_type = std::make_shared<::Type>(::TypeTag::String);
-    LIR_Inst call_inst(LIR_Op::DictItems, Type::Ptr, key_reg, 0, 0);
-    call_inst.call_args = {dict_reg, index_reg};
-    emit_instruction(call_inst);
-    set_register_type(key_reg, key_type);
-    
-    // Move key to loop variable
-    emit_instruction(LIR_Inst(LIR_Op::Mov, loop_var_reg, key_reg, 0));
-    set_register_type(loop_var_reg, key_type);
-    
-    // Execute loop body
-    if (stmt.body) {
-        emit_stmt(*stmt.body);
-    }
-    
-    // Increment index
-    Reg one_reg = allocate_register();
-    Backend::Value one_val = make_i64(1);
-    emit_instruction(LIR_Inst(LIR_Op::LoadConst, Type::I64, one_reg, one_val));
-    set_register_type(one_reg, int_type);
-    
-    Reg new_index_reg = allocate_register();
-    emit_instruction(LIR_Inst(LIR_Op::Add, new_index_reg, index_reg, one_reg));
-    emit_instruction(LIR_Inst(LIR_Op::Mov, index_reg, new_index_reg, 0));
-    
-    // Jump back to header
-    emit_instruction(LIR_Inst(LIR_Op::Jump, 0, 0, 0, header_block->id));
-    add_block_edge(body_block, header_block);
-
-    set_current_block(exit_block);
-    exit_loop();
-    exit_scope();
-}
-
-
-void Generator::emit_list_iter_stmt(LM::Frontend::AST::IterStatement& stmt, LM::Frontend::AST::ListExpr& list_expr) {
-    // Handle list iteration
-    if (stmt.loopVars.size() != 1) {
-        report_error("list iteration currently supports only one loop variable");
+// Lists, tuples and dicts are iterated in place through a cursor register,
+// without copying the collection first:
+//
+//   cursor = iter_begin iterable
+// header:
+//   cursor = iter_next cursor, iterable      ; false after the last item
+//   jmp_if_false cursor, exit
+//   var = iter_key iterable, cursor          ; value = iter_value for dicts
+//                                            ; (a single dict variable is the key)
+//   <body>
+//   jmp header
+void Generator::emit_collection_iter_stmt(LM::Frontend::AST::IterStatement& stmt, Reg iterable_reg, bool is_dict) {
+    TypePtr iterable_type = get_register_type(iterable_reg);
+    if (stmt.loopVars.empty() || stmt.loopVars.size() > (is_dict ? 2u : 1u)) {
+        report_error(is_dict ? "dict iteration supports one or two loop variables"
+                             : "list and tuple iteration support only one loop variable");
         return;
     }
-    const std::string& loop_var_name = stmt.loopVars[0];
-
-    LIR_BasicBlock* header_block = create_basic_block("list_iter_header");
-    LIR_BasicBlock* body_block = create_basic_block("list_iter_body");
-    LIR_BasicBlock* exit_block = create_basic_block("list_iter_exit");
-
-    enter_scope();
-    enter_loop();
-    set_loop_labels(header_block->id, exit_block->id, 0);
-
-    // Create the list
-    Reg list_reg = emit_list_expr(list_expr);
-    
-    // Bind loop variable
-    Reg loop_var_reg = allocate_register();
-    bind_variable(loop_var_name, loop_var_reg);
-
-    // Initialize index to 0
-    Reg index_reg = allocate_register();
-    auto int_type = std::make_shared<::Type>(::TypeTag::Int64);
-    Backend::Value zero_val = make_i64(0);
-    emit_instruction(LIR_Inst(LIR_Op::LoadConst, Type::I64, index_reg, zero_val));
-    set_register_type(index_reg, int_type);
-
-    // Jump to header
-    emit_instruction(LIR_Inst(LIR_Op::Jump, 0, 0, 0, header_block->id));
-    add_block_edge(get_current_block(), header_block);
-
-    set_current_block(header_block);
-    
-    // Get list length using element count from AST
-    Reg len_reg = allocate_register();
-    auto len_type = std::make_shared<::Type>(::TypeTag::Int64);
-    Backend::Value len_val = make_i64(list_expr.elements.size());
-    emit_instruction(LIR_Inst(LIR_Op::LoadConst, Type::I64, len_reg, len_val));
-    set_register_type(len_reg, len_type);
-    
-    // Compare index with length
-    Reg cmp_reg = allocate_register();
-    emit_instruction(LIR_Inst(LIR_Op::CmpLT, cmp_reg, index_reg, len_reg));
-    set_register_type(cmp_reg, std::make_shared<::Type>(::TypeTag::Bool));
-    
-    // Jump to exit if index >= length
-    emit_instruction(LIR_Inst(LIR_Op::JumpIfFalse, 0, cmp_reg, 0, exit_block->id));
-    add_block_edge(header_block, body_block);
-    add_block_edge(header_block, exit_block);
-
-    set_current_block(body_block);
-    
-    // Get element at current index
-    Reg elem_reg = allocate_register();
-    emit_instruction(LIR_Inst(LIR_Op::ListIndex, Type::Ptr, elem_reg, list_reg, index_reg));
-    set_register_type(elem_reg, std::make_shared<::Type>(::TypeTag::Any));
-    
-    // Move element to loop variable
-    emit_instruction(LIR_Inst(LIR_Op::Mov, loop_var_reg, elem_reg, 0));
-    set_register_type(loop_var_reg, std::make_shared<::Type>(::TypeTag::Any));
-    
-    // Execute loop body
-    if (stmt.body) {
-        emit_stmt(*stmt.body);
-    }
-    
-    // Increment index
-    Reg one_reg = allocate_register();
-    Backend::Value one_val = make_i64(1);
-    emit_instruction(LIR_Inst(LIR_Op::LoadConst, Type::I64, one_reg, one_val));
-    set_register_type(one_reg, int_type);
-    
-    Reg new_index_reg = allocate_register();
-    emit_instruction(LIR_Inst(LIR_Op::Add, new_index_reg, index_reg, one_reg));
-    emit_instruction(LIR_Inst(LIR_Op::Mov, index_reg, new_index_reg, 0));
-    
-    // Jump back to header
-    emit_instruction(LIR_Inst(LIR_Op::Jump, 0, 0, 0, header_block->id));
-    add_block_edge(body_block, header_block);
-
-    set_current_block(exit_block);
-    exit_loop();
-    exit_scope();
-}
-
 
-void Generator::emit_tuple_iter_stmt(LM::Frontend::AST::IterStatement& stmt, LM::Frontend::AST::TupleExpr& tuple_expr) {
-    // Handle tuple iteration (similar to list)
-    if (stmt.loopVars.size() != 1) {
-        report_error("tuple iteration currently supports only one loop variable");
-        return;
+    auto any_type = std::make_shared<::Type>(::TypeTag::Any);
+    TypePtr key_type = any_type;
+    TypePtr value_type = any_type;
+    if (iterable_type) {
+        if (auto* list_type = std::get_if<ListType>(&iterable_type->extra)) {
+            if (list_type->elementType) key_type = list_type->elementType;
+        } else if (auto* dict_type = std::get_if<DictType>(&iterable_type->extra)) {
+            if (dict_type->keyType) key_type = dict_type->keyType;
+            if (dict_type->valueType) value_type = dict_type->valueType;
+        }
     }
-    const std::string& loop_var_name = stmt.loopVars[0];
 
-    LIR_BasicBlock* header_block = create_basic_block("tuple_iter_header");
-    LIR_BasicBlock* body_block = create_basic_block("tuple_iter_body");
-    LIR_BasicBlock* exit_block = create_basic_block("tuple_iter_exit");
+    LIR_BasicBlock* header_block = create_basic_block("iter_header");
+    LIR_BasicBlock* body_block = create_basic_block("iter_body");
+    LIR_BasicBlock* exit_block = create_basic_block("iter_exit");
 
     enter_scope();
     enter_loop();
-    set_loop_labels(header_block->id, exit_block->id, 0);
-
-    // Create the tuple
-    Reg tuple_reg = emit_tuple_expr(tuple_expr);
-    
-    // Bind loop variable
-    Reg loop_var_reg = allocate_register();
-    bind_variable(loop_var_name, loop_var_reg);
+    set_loop_labels(header_block->id, exit_block->id, header_block->id);
 
-    // Initialize index to 0
-    Reg index_reg = allocate_register();
-    auto int_type = std::make_shared<::Type>(::TypeTag::Int64);
-    Backend::Value zero_val = make_i64(0);
-    emit_instruction(LIR_Inst(LIR_Op::LoadConst, Type::I64, index_reg, zero_val));
-    set_register_type(index_reg, int_type);
+    Reg cursor_reg = allocate_register();
+    emit_instruction(LIR_Inst(LIR_Op::IterBegin, Type::I64, cursor_reg, iterable_reg));
+    set_register_type(cursor_reg, any_type);
 
-    // Jump to header
     emit_instruction(LIR_Inst(LIR_Op::Jump, 0, 0, 0, header_block->id));
     add_block_edge(get_current_block(), header_block);
 
     set_current_block(header_block);
-    
-    // Get tuple size from type system instead of parameter
-    Reg len_reg = allocate_register();
-    auto len_type = std::make_shared<::Type>(::TypeTag::Int64);
-    
-    // Extract tuple size from register type
-    int64_t tuple_len = tuple_expr.elements.size(); // Default fallback
-    
-    Backend::Value len_val = make_i64(tuple_len);
-    emit_instruction(LIR_Inst(LIR_Op::LoadConst, Type::I64, len_reg, len_val));
-    set_register_type(len_reg, len_type);
-    
-    // Compare index with length
-    Reg cmp_reg = allocate_register();
-    emit_instruction(LIR_Inst(LIR_Op::CmpLT, cmp_reg, index_reg, len_reg));
-    set_register_type(cmp_reg, std::make_shared<::Type>(::TypeTag::Bool));
-    
-    // Jump to exit if index >= length
-    emit_instruction(LIR_Inst(LIR_Op::JumpIfFalse, 0, cmp_reg, 0, exit_block->id));
+    emit_instruction(LIR_Inst(LIR_Op::IterNext, Type::I64, cursor_reg, cursor_reg, iterable_reg));
+    emit_instruction(LIR_Inst(LIR_Op::JumpIfFalse, 0, cursor_reg, 0, exit_block->id));
     add_block_edge(header_block, body_block);
     add_block_edge(header_block, exit_block);
 
     set_current_block(body_block);
-    
-    // Get element at current index (tuples use list_index internally)
-    Reg elem_reg = allocate_register();
-    emit_instruction(LIR_Inst(LIR_Op::TupleGet, Type::Ptr, elem_reg, tuple_reg, index_reg));
-    set_register_type(elem_reg, std::make_shared<::Type>(::TypeTag::Any));
-    
-    // Move element to loop variable
-    emit_instruction(LIR_Inst(LIR_Op::Mov, loop_var_reg, elem_reg, 0));
-    set_register_type(loop_var_reg, std::make_shared<::Type>(::TypeTag::Any));
-    
-    // Execute loop body
-    if (stmt.body) {
-        emit_stmt(*stmt.body);
-    }
-    
-    // Increment index
-    Reg one_reg = allocate_register();
-    Backend::Value one_val = make_i64(1);
-    emit_instruction(LIR_Inst(LIR_Op::LoadConst, Type::I64, one_reg, one_val));
-    set_register_type(one_reg, int_type);
-    
-    Reg new_index_reg = allocate_register();
-    emit_instruction(LIR_Inst(LIR_Op::Add, new_index_reg, index_reg, one_reg));
-    emit_instruction(LIR_Inst(LIR_Op::Mov, index_reg, new_index_reg, 0));
-    
-    // Jump back to header
-    emit_instruction(LIR_Inst(LIR_Op::Jump, 0, 0, 0, header_block->id));
-    add_block_edge(body_block, header_block);
-
-    set_current_block(exit_block);
-    exit_loop();
-    exit_scope();
-}
-
-
-void Generator::emit_dict_var_iter_stmt(LM::Frontend::AST::IterStatement& stmt, Reg dict_reg) {
-    // Convert dict to list of tuples using DictItems operation
-    // The runtime does the heavy lifting (walking the hash table)
-    LIR::Reg items_reg = allocate_register();
-    emit_instruction(LIR_Inst(LIR_Op::DictItems, Type::Ptr, items_reg, dict_reg));
-    
-    // Iterate the list normally using existing list iteration
-    emit_list_var_iter_stmt(stmt, items_reg);
-}
-
+    Reg key_reg = allocate_register();
+    bind_variable(stmt.loopVars[0], key_reg);
+    emit_instruction(LIR_Inst(LIR_Op::IterKey, Type::Ptr, key_reg, iterable_reg, cursor_reg));
+    set_register_type(key_reg, key_type);
 
-void Generator::emit_list_var_iter_stmt(LM::Frontend::AST::IterStatement& stmt, Reg list_reg) {
-    // Handle list iteration for variables
-    if (stmt.loopVars.size() != 1) {
-        report_error("list iteration currently supports only one loop variable");
-        return;
+    if (stmt.loopVars.size() == 2) {
+        Reg value_reg = allocate_register();
+        bind_variable(stmt.loopVars[1], value_reg);
+        emit_instruction(LIR_Inst(LIR_Op::IterValue, Type::Ptr, value_reg, iterable_reg, cursor_reg));
+        set_register_type(value_reg, value_type);
     }
-    const std::string& loop_var_name = stmt.loopVars[0];
-
-    // Check if this is actually a tuple
-    TypePtr iterable_type = get_register_type(list_reg);
-    bool is_tuple = iterable_type && iterable_type->tag == TypeTag::Tuple;
-
-    LIR_BasicBlock* header_block = create_basic_block("list_var_iter_header");
-    LIR_BasicBlock* body_block = create_basic_block("list_var_iter_body");
-    LIR_BasicBlock* exit_block = create_basic_block("list_var_iter_exit");
-
-    enter_scope();
-    enter_loop();
-    set_loop_labels(header_block->id, exit_block->id, 0);
-
-    // Bind loop variable
-    Reg loop_var_reg = allocate_register();
-    bind_variable(loop_var_name, loop_var_reg);
-
-    // Initialize index to 0
-    Reg index_reg = allocate_register();
-    auto int_type = std::make_shared<::Type>(::TypeTag::Int64);
-    Backend::Value zero_val = make_i64(0);
-    emit_instruction(LIR_Inst(LIR_Op::LoadConst, Type::I64, index_reg, zero_val));
-    set_register_type(index_reg, int_type);
-
-    // Jump to header
-    emit_instruction(LIR_Inst(LIR_Op::Jump, 0, 0, 0, header_block->id));
-    add_block_edge(get_current_block(), header_block);
-
-    set_current_block(header_block);
-    
-    // Get the actual list length using ListLen operation
-    Reg len_reg = allocate_register();
-    auto len_type = std::make_shared<::Type>(::TypeTag::Int64);
-    emit_instruction(LIR_Inst(LIR_Op::ListLen, Type::I64, len_reg, list_reg));
-    set_register_type(len_reg, len_type);
-    
-    // Compare index with length
-    Reg cmp_reg = allocate_register();
-    emit_instruction(LIR_Inst(LIR_Op::CmpLT, cmp_reg, index_reg, len_reg));
-    set_register_type(cmp_reg, std::make_shared<::Type>(::TypeTag::Bool));
-    
-    // Jump to exit if index >= length
-    emit_instruction(LIR_Inst(LIR_Op::JumpIfFalse, 0, cmp_reg, 0, exit_block->id));
-    add_block_edge(header_block, body_block);
-    add_block_edge(header_block, exit_block);
 
-    set_current_block(body_block);
-    
-    // Get element at current index
-    Reg elem_reg = allocate_register();
-    if (is_tuple) {
-        emit_instruction(LIR_Inst(LIR_Op::TupleGet, Type::Ptr, elem_reg, list_reg, index_reg));
-    } else {
-        emit_instruction(LIR_Inst(LIR_Op::ListIndex, Type::Ptr, elem_reg, list_reg, index_reg));
-    }
-    set_register_type(elem_reg, std::make_shared<::Type>(::TypeTag::Any));
-    
-    // Move element to loop variable
-    emit_instruction(LIR_Inst(LIR_Op::Mov, loop_var_reg, elem_reg, 0));
-    set_register_type(loop_var_reg, std::make_shared<::Type>(::TypeTag::Any));
-    
-    // Execute loop body
     if (stmt.body) {
         emit_stmt(*stmt.body);
     }
-    
-    // Increment index
-    Reg one_reg = allocate_register();
-    Backend::Value one_val = make_i64(1);
-    emit_instruction(LIR_Inst(LIR_Op::LoadConst, Type::I64, one_reg, one_val));
-    set_register_type(one_reg, int_type);
-    
-    Reg new_index_reg = allocate_register();
-    emit_instruction(LIR_Inst(LIR_Op::Add, new_index_reg, index_reg, one_reg));
-    emit_instruction(LIR_Inst(LIR_Op::Mov, index_reg, new_index_reg, 0));
-    
-    // Jump back to header
-    emit_instruction(LIR_Inst(LIR_Op::Jump, 0, 0, 0, header_block->id));
-    add_block_edge(body_block, header_block);
-
-    set_current_block(exit_block);
-    exit_loop();
-    exit_scope();
-}
-
-
-void Generator::emit_tuple_var_iter_stmt(LM::Frontend::AST::IterStatement& stmt, Reg tuple_reg, int64_t tuple_len) {
-    // Handle tuple iteration for variables (similar to list)
-    if (stmt.loopVars.size() != 1) {
-        report_error("tuple iteration currently supports only one loop variable");
-        return;
-    }
-    const std::string& loop_var_name = stmt.loopVars[0];
-
-    LIR_BasicBlock* header_block = create_basic_block("tuple_var_iter_header");
-    LIR_BasicBlock* body_block = create_basic_block("tuple_var_iter_body");
-    LIR_BasicBlock* exit_block = create_basic_block("tuple_var_iter_exit");
-
-    enter_scope();
-    enter_loop();
-    set_loop_labels(header_block->id, exit_block->id, 0);
-
-    // Bind loop variable
-    Reg loop_var_reg = allocate_register();
-    bind_variable(loop_var_name, loop_var_reg);
-
-    // Initialize index to 0
-    Reg index_reg = allocate_register();
-    auto int_type = std::make_shared<::Type>(::TypeTag::Int64);
-    Backend::Value zero_val = make_i64(0);
-    emit_instruction(LIR_Inst(LIR_Op::LoadConst, Type::I64, index_reg, zero_val));
-    set_register_type(index_reg, int_type);
-
-    // Jump to header
     emit_instruction(LIR_Inst(LIR_Op::Jump, 0, 0, 0, header_block->id));
     add_block_edge(get_current_block(), header_block);
 
-    set_current_block(header_block);
-    
-    Reg len_reg = allocate_register();
-    auto len_type = std::make_shared<::Type>(::TypeTag::Int64);
-    if (tuple_len > 0) {
-        Backend::Value len_val = make_i64(tuple_len);
-        emit_instruction(LIR_Inst(LIR_Op::LoadConst, Type::I64, len_reg, len_val));
-    } else {
-        // If tuple_len is 0, we can use TupleLen op if available, or assume it is known at runtime
-        emit_instruction(LIR_Inst(LIR_Op::LoadConst, Type::I64, len_reg, make_i64(0)));
-    }
-    set_register_type(len_reg, len_type);
-    
-    // Compare index with length
-    Reg cmp_reg = allocate_register();
-    emit_instruction(LIR_Inst(LIR_Op::CmpLT, cmp_reg, index_reg, len_reg));
-    set_register_type(cmp_reg, std::make_shared<::Type>(::TypeTag::Bool));
-    
-    // Jump to exit if index >= length
-    emit_instruction(LIR_Inst(LIR_Op::JumpIfFalse, 0, cmp_reg, 0, exit_block->id));
-    add_block_edge(header_block, body_block);
-    add_block_edge(header_block, exit_block);
-
-    set_current_block(body_block);
-    
-    // Get element at current index (tuples use list_index internally)
-    Reg elem_reg = allocate_register();
-    emit_instruction(LIR_Inst(LIR_Op::TupleGet, Type::Ptr, elem_reg, tuple_reg, index_reg));
-    set_register_type(elem_reg, std::make_shared<::Type>(::TypeTag::Any));
-    
-    // Move element to loop variable
-    emit_instruction(LIR_Inst(LIR_Op::Mov, loop_var_reg, elem_reg, 0));
-    set_register_type(loop_var_reg, std::make_shared<::Type>(::TypeTag::Any));
-    
-    // Execute loop body
-    if (stmt.body) {
-        emit_stmt(*stmt.body);
-    }
-    
-    // Increment index
-    Reg one_reg = allocate_register();
-    Backend::Value one_val = make_i64(1);
-    emit_instruction(LIR_Inst(LIR_Op::LoadConst, Type::I64, one_reg, one_val));
-    set_register_type(one_reg, int_type);
-    
-    Reg new_index_reg = allocate_register();
-    emit_instruction(LIR_Inst(LIR_Op::Add, new_index_reg, index_reg, one_reg));
-    emit_instruction(LIR_Inst(LIR_Op::Mov, index_reg, new_index_reg, 0));
-    
-    // Jump back to header
-    emit_instruction(LIR_Inst(LIR_Op::Jump, 0, 0, 0, header_block->id));
-    add_block_edge(body_block, header_block);
-
     set_current_block(exit_block);
     exit_loop();
     exit_scope();
@@ -1986,7 +1555,7 @@ void Generator::emit_pattern_match(std::shared_ptr<LM::Frontend::AST::Expression
         for (const auto& field : dict_p->fields) {
             Reg key_reg = allocate_register();
             auto str_type = std::make_shared<::Type>(::TypeTag::String);
-            emit_instruction(LIR_Inst(LIR_Op::LoadConst, Type::Ptr, key_reg, BOX_PTR(lm_box_string(field.key.c_str()))));
+            emit_instruction(LIR_Inst(LIR_Op::LoadConst, Type::Ptr, key_reg, BOX_PTR(lm_string_new(field.key.data(), field.key.size()))));
             
             Reg exists = allocate_register();
             emit_instruction(LIR_Inst(LIR_Op::DictHas, LIR::Type::Bool, exists, val_reg, key_reg));
@@ -0,0 +1,107 @@
+#include "linker.hh"
+#include <algorithm>
+#include <string_view>
+
+namespace LM {
+namespace LIR {
+
+uint32_t FunctionTable::index_of(const std::string& name) const {
+    auto it = indices_.find(name);
+    return (it != indices_.end()) ? it->second : UINT32_MAX;
+}
+
+uint32_t FunctionTable::global_slot(const std::string& name) const {
+    auto it = global_slots_.find(name);
+    return (it != global_slots_.end()) ? it->second : UINT32_MAX;
+}
+
+std::shared_ptr<const FunctionTable> Linker::link() {
+    auto& func_manager = LIRFunctionManager::getInstance();
+    auto table = std::make_shared<FunctionTable>();
+
+    // Sort names so indices are stable from run to run
+    std::vector<std::string> names = func_manager.getFunctionNames();
+    std::sort(names.begin(), names.end());
+
+    for (const auto& name : names) {
+        auto func = func_manager.getFunction(name);
+        if (!func) continue;
+        table->indices_[name] = static_cast<uint32_t>(table->functions_.size());
+        LinkedFunction linked;
+        linked.owner = func;
+        table->functions_.push_back(linked);
+    }
+
+    // Every global any function touches gets a slot; a global that is read
+    // but never stored reads as nil
+    std::vector<std::string> globals;
+    collect_globals(entry_.instructions, globals);
+    for (const auto& linked : table->functions_) {
+        collect_globals(linked.owner->getInstructions(), globals);
+    }
+    // Order by (module, name) rather than by the whole qualified name, which
+    // would put "a.b.q" between "a.a" and "a.c"
+    auto split = [](const std::string& name) {
+        size_t dot = name.rfind('.');
+        if (dot == std::string::npos) return std::make_pair(std::string_view(), std::string_view(name));
+        return std::make_pair(std::string_view(name).substr(0, dot), std::string_view(name).substr(dot + 1));
+    };
+    std::sort(globals.begin(), globals.end(), [&](const std::string& a, const std::string& b) {
+        return split(a) < split(b);
+    });
+    globals.erase(std::unique(globals.begin(), globals.end()), globals.end());
+    for (const auto& name : globals) {
+        table->global_slots_[name] = static_cast<uint32_t>(table->global_names_.size());
+        table->global_names_.push_back(name);
+    }
+
+    for (auto& linked : table->functions_) {
+        std::vector<LIR_Inst> instructions = linked.owner->getInstructions();
+        resolve(instructions, *table);
+        linked.owner->setInstructions(instructions);
+
+        linked.register_count = linked.owner->getRegisterCount();
+        linked.param_count = static_cast<uint32_t>(linked.owner->getParameters().size());
+    }
+
+    resolve(entry_.instructions, *table);
+    return table;
+}
+
+void Linker::collect_globals(const std::vector<LIR_Inst>& instructions, std::vector<std::string>& names) const {
+    for (const auto& inst : instructions) {
+        if (inst.op == LIR_Op::LoadGlobal || inst.op == LIR_Op::StoreGlobal) {
+            names.push_back(inst.func_name);
+        }
+    }
+}
+
+void Linker::resolve(std::vector<LIR_Inst>& instructions, const FunctionTable& table) const {
+    for (auto& inst : instructions) {
+        if (inst.func_name.empty()) continue;
+
+        switch (inst.op) {
+            case LIR_Op::Call:
+            case LIR_Op::CallVoid:
+                inst.func_index = table.index_of(inst.func_name);
+                break;
+            case LIR_Op::LoadGlobal:
+            case LIR_Op::StoreGlobal:
+                inst.func_index = table.global_slot(inst.func_name);
+                break;
+            case LIR_Op::LoadConst: {
+                uint32_t index = table.index_of(inst.func_name);
+                if (index != UINT32_MAX) {
+                    inst.func_index = index;
+                    inst.const_val = BOX_FUNC(index);
+                }
+                break;
+            }
+            default:
+                break;
+        }
+    }
+}
+
+} // namespace LIR
+} // namespace LM
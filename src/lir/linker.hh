@@ -0,0 +1,96 @@
+#pragma once
+
+#include "lir.hh"
+#include "functions.hh"
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace LM {
+namespace LIR {
+
+/**
+ * @brief A function as seen by the VM after linking.
+ *
+ * The instruction stream stays in the owning LIRFunction, which the table
+ * keeps alive; the VM lowers it from there.
+ */
+struct LinkedFunction {
+    std::shared_ptr<LIRFunction> owner;
+    uint32_t register_count = 0;
+    uint32_t param_count = 0;
+
+    const std::string& name() const { return owner->getName(); }
+};
+
+/**
+ * @brief Immutable table of every user function in a program, indexed densely
+ */
+class FunctionTable {
+public:
+    const LinkedFunction& operator[](uint32_t index) const { return functions_[index]; }
+    size_t size() const { return functions_.size(); }
+
+    /**
+     * @brief Look up a function index by name (link time only)
+     * @return The index, or UINT32_MAX if no such function exists
+     */
+    uint32_t index_of(const std::string& name) const;
+
+    /**
+     * @brief Module-level variables, one dense slot each
+     *
+     * Slots are assigned in order of (module, name), where the module is the
+     * qualified name up to its last dot, so the variables of one module occupy
+     * a contiguous range even when modules nest. The names are kept
+     * only for debugging and export lookups; the VM addresses globals by slot.
+     */
+    size_t global_count() const { return global_names_.size(); }
+    const std::string& global_name(uint32_t slot) const { return global_names_[slot]; }
+
+    /**
+     * @brief Look up a global slot by qualified name (link time only)
+     * @return The slot, or UINT32_MAX if no instruction references the global
+     */
+    uint32_t global_slot(const std::string& name) const;
+
+private:
+    friend class Linker;
+
+    std::vector<LinkedFunction> functions_;
+    std::unordered_map<std::string, uint32_t> indices_;
+    std::vector<std::string> global_names_;
+    std::unordered_map<std::string, uint32_t> global_slots_;
+};
+
+/**
+ * @brief Resolves call sites to function-table indices
+ *
+ * Runs once after Generator::generate_program. Every function registered with
+ * the LIRFunctionManager gets a dense index, Call sites get their func_index
+ * filled in and function-name constants become function handles (BOX_FUNC).
+ * Calls naming no user function keep UINT32_MAX; the VM binds those to its
+ * builtins when it lowers the function.
+ * LoadGlobal/StoreGlobal get the slot of the global they name in func_index.
+ * Functions must not be modified after linking.
+ */
+class Linker {
+public:
+    explicit Linker(LIR_Function& entry) : entry_(entry) {}
+
+    /**
+     * @brief Link the entry function and all registered functions
+     * @return The function table the VM executes against
+     */
+    std::shared_ptr<const FunctionTable> link();
+
+private:
+    LIR_Function& entry_;
+
+    void collect_globals(const std::vector<LIR_Inst>& instructions, std::vector<std::string>& names) const;
+    void resolve(std::vector<LIR_Inst>& instructions, const FunctionTable& table) const;
+};
+
+} // namespace LIR
+} // namespace LM
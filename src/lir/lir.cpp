@@ -19,8 +19,12 @@ std::string LIR_Inst::to_string() const {
             oss << " r" << dst << ", r" << a;
             break;
         case LIR_Op::LoadConst:
-            if (IS_INT(const_val)) {
+            if (!func_name.empty()) {
+                oss << " r" << dst << ", fn " << func_name;
+            } else if (IS_INT(const_val)) {
                 oss << " r" << dst << ", " << UNBOX_INT(const_val);
+            } else if (IS_FLOAT_IMM(const_val)) {
+                oss << " r" << dst << ", " << UNBOX_FLOAT(const_val);
             } else if (IS_NIL(const_val)) {
                 oss << " r" << dst << ", nil";
             } else if (IS_BOOL(const_val)) {
@@ -118,8 +122,18 @@ std::string LIR_Inst::to_string() const {
         case LIR_Op::STR_FORMAT:
             oss << " r" << dst << ", r" << a << ", r" << b;
             break;
+        case LIR_Op::STR_BUILD:
+        case LIR_Op::STR_APPEND:
+            oss << " r" << dst << ", (";
+            for (size_t i = 0; i < call_args.size(); ++i) {
+                if (i > 0) oss << ", ";
+                oss << "r" << call_args[i];
+            }
+            oss << ")";
+            break;
         case LIR_Op::ListCreate:
             oss << " r" << dst;
+            if (imm != 0) oss << ", " << imm;
             break;
         case LIR_Op::ListAppend:
             oss << " r" << dst << ", r" << a << ", r" << b;
@@ -141,9 +155,6 @@ std::string LIR_Inst::to_string() const {
         case LIR_Op::DictLen:
             oss << " r" << dst << ", r" << a << ", r" << b;
             break;
-        case LIR_Op::DictItems:
-            oss << " r" << dst << ", r" << a;
-            break;
         case LIR_Op::TupleCreate:
             oss << " r" << dst << ", " << imm;
             break;
@@ -154,6 +165,14 @@ std::string LIR_Inst::to_string() const {
         case LIR_Op::TupleSet:
             oss << " r" << dst << ", r" << a << ", r" << b;
             break;
+        case LIR_Op::IterBegin:
+            oss << " r" << dst << ", r" << a;
+            break;
+        case LIR_Op::IterNext:
+        case LIR_Op::IterKey:
+        case LIR_Op::IterValue:
+            oss << " r" << dst << ", r" << a << ", r" << b;
+            break;
         case LIR_Op::MakeEnum:
             oss << " r" << dst << ", " << imm;
             if (a != 0) {
@@ -164,6 +183,12 @@ std::string LIR_Inst::to_string() const {
         case LIR_Op::GetPayload:
             oss << " r" << dst << ", r" << a;
             break;
+        case LIR_Op::LoadGlobal:
+            oss << " r" << dst << ", " << func_name;
+            break;
+        case LIR_Op::StoreGlobal:
+            oss << " " << func_name << ", r" << a;
+            break;
         case LIR_Op::NewFrame:
             oss << " r" << dst << ", " << func_name << ", fields=" << imm;
             break;
@@ -198,6 +223,12 @@ std::string LIR_Inst::to_string() const {
         case LIR_Op::MakeTraitObject:
             oss << " r" << dst << ", instance=r" << a << ", frame=" << func_name << ", trait=" << type_name;
             break;
+        case LIR_Op::RegionEnter:
+            oss << " r" << dst;
+            break;
+        case LIR_Op::RegionExit:
+            oss << " r" << a;
+            break;
         case LIR_Op::Nop:
             // No operands
             break;
@@ -210,6 +241,9 @@ std::string LIR_Inst::to_string() const {
             break;
     }
     
+    if (region) {
+        oss << " [region]";
+    }
     if (!comment.empty()) {
         oss << " ; " << comment;
     }
@@ -278,6 +312,8 @@ std::string lir_op_to_string(LIR_Op op) {
         case LIR_Op::ToString: return "to_string";
         case LIR_Op::STR_CONCAT: return "str_concat";
         case LIR_Op::STR_FORMAT: return "str_format";
+        case LIR_Op::STR_BUILD: return "str_build";
+        case LIR_Op::STR_APPEND: return "str_append";
         case LIR_Op::DecAdd: return "dec_add";
         case LIR_Op::DecSub: return "dec_sub";
         case LIR_Op::DecMul: return "dec_mul";
@@ -338,11 +374,14 @@ std::string lir_op_to_string(LIR_Op op) {
         case LIR_Op::DictGet: return "dict_get";
         case LIR_Op::DictHas: return "dict_has";
         case LIR_Op::DictLen: return "dict_len";
-        case LIR_Op::DictItems: return "dict_items";
         case LIR_Op::TupleCreate: return "tuple_create";
         case LIR_Op::TupleGet: return "tuple_get";
         case LIR_Op::TupleSet: return "tuple_set";
         case LIR_Op::TupleLen: return "tuple_len";
+        case LIR_Op::IterBegin: return "iter_begin";
+        case LIR_Op::IterNext: return "iter_next";
+        case LIR_Op::IterKey: return "iter_key";
+        case LIR_Op::IterValue: return "iter_value";
         case LIR_Op::NewFrame: return "new_frame";
         case LIR_Op::FrameGetField: return "frame_get_field";
         case LIR_Op::FrameSetField: return "frame_set_field";
@@ -364,6 +403,29 @@ std::string lir_op_to_string(LIR_Op op) {
         case LIR_Op::SharedCellStore: return "shared_cell_store";
         case LIR_Op::SharedCellAdd: return "shared_cell_add";
         case LIR_Op::SharedCellSub: return "shared_cell_sub";
+        case LIR_Op::RegionEnter: return "region_enter";
+        case LIR_Op::RegionExit: return "region_exit";
+        case LIR_Op::AddI64: return "add_i64";
+        case LIR_Op::SubI64: return "sub_i64";
+        case LIR_Op::MulI64: return "mul_i64";
+        case LIR_Op::DivI64: return "div_i64";
+        case LIR_Op::CmpEqI64: return "cmpeq_i64";
+        case LIR_Op::CmpNeI64: return "cmpneq_i64";
+        case LIR_Op::CmpLtI64: return "cmplt_i64";
+        case LIR_Op::CmpLeI64: return "cmple_i64";
+        case LIR_Op::CmpGtI64: return "cmpgt_i64";
+        case LIR_Op::CmpGeI64: return "cmpge_i64";
+        case LIR_Op::AddF64: return "add_f64";
+        case LIR_Op::SubF64: return "sub_f64";
+        case LIR_Op::MulF64: return "mul_f64";
+        case LIR_Op::DivF64: return "div_f64";
+        case LIR_Op::ListIndexI64: return "list_index_i64";
+        case LIR_Op::FrameGetFieldInline: return "frame_get_field_inline";
+        case LIR_Op::CmpLtI64JumpIfFalse: return "cmplt_i64_jmp_if_false";
+        case LIR_Op::CmpEqI64JumpIfFalse: return "cmpeq_i64_jmp_if_false";
+        case LIR_Op::LoadConstAddI64: return "load_const_add_i64";
+        case LIR_Op::LoadConstSubI64: return "load_const_sub_i64";
+        case LIR_Op::JumpCmpLtI64: return "jump_cmplt_i64";
     }
     return "unknown";
 }
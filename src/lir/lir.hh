@@ -114,6 +114,8 @@ enum class LIR_Op : uint8_t {
     // String operations
     STR_CONCAT, // Explicit string concatenation (+)
     STR_FORMAT, // String formatting (interpolation)
+    STR_BUILD,  // Join the call_args into one new string
+    STR_APPEND, // Append call_args[1..] to the string in call_args[0] == dst, in place when it is uniquely owned
     
     // Decimal operations
     DecAdd,     // Decimal addition
@@ -193,7 +195,6 @@ enum class LIR_Op : uint8_t {
     DictGet,
     DictHas,
     DictLen,
-    DictItems,  // Get dict items as flat array of (key, value) pairs
     
     // Tuple operations
     TupleCreate,
@@ -201,6 +202,12 @@ enum class LIR_Op : uint8_t {
     TupleSet,  // Set tuple element by index
     TupleLen,  // Get tuple size
     
+    // Iteration over lists, tuples and dicts with a cursor in a register
+    IterBegin,  // dst = cursor before the first item of a
+    IterNext,   // dst = cursor a advanced over b, false after the last item
+    IterKey,    // dst = element of a list or tuple, or key of a dict, a at cursor b
+    IterValue,  // dst = value of a dict, or element of a list or tuple, a at cursor b
+    
     
     // Frame operations (modern OOP)
     NewFrame,        // Allocate and initialize frame instance
@@ -229,7 +236,42 @@ enum class LIR_Op : uint8_t {
     SharedCellLoad,     // Load value from SharedCell (reg = shared_cells[cell_id].value)
     SharedCellStore,    // Store value to SharedCell (shared_cells[cell_id].value = reg)
     SharedCellAdd,      // Atomic add to SharedCell (shared_cells[cell_id].value += reg)
-    SharedCellSub       // Atomic sub from SharedCell (shared_cells[cell_id].value -= reg)
+    SharedCellSub,      // Atomic sub from SharedCell (shared_cells[cell_id].value -= reg)
+
+    // Region allocation, inserted by the escape analysis (escape_analysis.hh)
+    RegionEnter,        // Save the region arena top (reg = mark)
+    RegionExit,         // Release region objects allocated after a mark (mark reg)
+
+    // Type-specialized arithmetic. Never emitted by the generator; the register
+    // VM lowering selects them when type_a/type_b are statically known, or
+    // quickens a generic instruction into one at run time. Each one falls back
+    // to its generic counterpart when the operands do not match.
+    AddI64,     // Add two SMIs, generic on overflow
+    SubI64,     // Subtract two SMIs, generic on overflow
+    MulI64,     // Multiply two SMIs, generic on overflow
+    DivI64,     // Divide two SMIs, generic on zero divisor or overflow
+    CmpEqI64,   // Compare SMIs for equality
+    CmpNeI64,   // Compare SMIs for inequality
+    CmpLtI64,   // Compare SMIs less than
+    CmpLeI64,   // Compare SMIs less than or equal
+    CmpGtI64,   // Compare SMIs greater than
+    CmpGeI64,   // Compare SMIs greater than or equal
+    AddF64,     // Add two floats
+    SubF64,     // Subtract two floats
+    MulF64,     // Multiply two floats
+    DivF64,     // Divide two floats, generic on zero divisor
+
+    // Quickened accessors, installed by the register VM at run time
+    ListIndexI64,        // Index a list with an SMI
+    FrameGetFieldInline, // Load a field from a frame instance without a call
+
+    // Superinstructions, fused by the register VM lowering from the opcode
+    // pair that follows them in the stream (benchmarks/op_pairs.sh)
+    CmpLtI64JumpIfFalse, // CmpLtI64 + JumpIfFalse on its result
+    CmpEqI64JumpIfFalse, // CmpEqI64 + JumpIfFalse on its result
+    LoadConstAddI64,     // LoadConst + AddI64
+    LoadConstSubI64,     // LoadConst + SubI64
+    JumpCmpLtI64         // Loop back-edge Jump that runs the CmpLtI64JumpIfFalse it targets
 };
 
 // Source location for debugging
@@ -264,9 +306,11 @@ struct LIR_Inst {
     
     // Enhanced function call support
     std::string func_name;          // Function name (for calls and function definitions)
+    uint32_t func_index = UINT32_MAX; // Function table index (global slot for LoadGlobal/StoreGlobal), resolved by the linker
     std::string type_name;          // Type name (for trait objects and vtable generation)
     std::vector<Reg> call_args;     // Arguments for calls, parameters for declarations
     std::vector<Type> call_arg_types; // Types of call arguments
+    bool region = false;            // Allocate the result in the current region (escape analysis)
     
     // Debug information
     std::string comment;
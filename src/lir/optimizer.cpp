@@ -288,7 +288,8 @@ bool Optimizer::has_instruction_side_effects(const LIR_Inst& inst) const {
         inst.op == LIR_Op::Label || inst.op == LIR_Op::Store ||
         inst.op == LIR_Op::ChannelSend || inst.op == LIR_Op::ChannelRecv ||
         inst.op == LIR_Op::ChannelClose || inst.op == LIR_Op::Await ||
-        inst.op == LIR_Op::AsyncCall
+        inst.op == LIR_Op::AsyncCall ||
+        inst.op == LIR_Op::RegionEnter || inst.op == LIR_Op::RegionExit
     );
 }
 
@@ -4,6 +4,8 @@
 #include <sstream>
 #include <string>
 #include <vector>
+#include <charconv>
+#include <cstdint>
 
 void printUsage(const char* programName) {
     std::cout << "Limit Programming Language\n";
@@ -12,6 +14,9 @@ void printUsage(const char* programName) {
     std::cout << "    " << programName << " run [options] <source_file>\n";
     std::cout << "      Options:\n";
     std::cout << "        -debug                Enable debug output\n";
+    std::cout << "        -max-steps <n>        Stop after n loop iterations and calls\n";
+    std::cout << "        -timeout-ms <n>       Stop after n milliseconds\n";
+    std::cout << "        -gc-stats             Print garbage collector statistics\n";
     std::cout << "\n  Compilation (AOT/WASM):\n";
 #ifdef FYRA_AVAILABLE
     std::cout << "    " << programName << " build [options] <source_file>\n";
@@ -30,11 +35,23 @@ void printUsage(const char* programName) {
     std::cout << "    " << programName << " -cst <source_file>      Print the CST\n";
     std::cout << "    " << programName << " -tokens <source_file>   Print tokens\n";
     std::cout << "    " << programName << " -lir <source_file>      Print the LIR (Low-level IR)\n";
+    std::cout << "    " << programName << " -op-pairs <source_file> Run and print executed opcode-pair counts\n";
 #ifdef FYRA_AVAILABLE
     std::cout << "    " << programName << " -fyra-ir <source_file>  Print the Fyra IR\n";
 #endif
 }
 
+// Parses a non-negative count for a numeric option, reporting bad values
+static bool parseCount(const char* option, const char* text, uint64_t& out) {
+    const char* end = text + std::char_traits<char>::length(text);
+    auto [ptr, ec] = std::from_chars(text, end, out);
+    if (ec != std::errc() || ptr != end || ptr == text) {
+        std::cerr << "Error: " << option << " expects a non-negative integer, got '" << text << "'\n";
+        return false;
+    }
+    return true;
+}
+
 int main(int argc, char* argv[]) {
     if (argc < 2) {
         printUsage(argv[0]);
@@ -63,6 +80,7 @@ int main(int argc, char* argv[]) {
     if (command == "-cst" && argc >= 3) { options.print_cst = true; return LM::Compiler::executeFile(argv[2], options); }
     if (command == "-tokens" && argc >= 3) { options.print_tokens = true; return LM::Compiler::executeFile(argv[2], options); }
     if (command == "-lir" && argc >= 3) { options.print_lir = true; return LM::Compiler::executeFile(argv[2], options); }
+    if (command == "-op-pairs" && argc >= 3) { options.profile_op_pairs = true; return LM::Compiler::executeFile(argv[2], options); }
 #ifdef FYRA_AVAILABLE
     if (command == "-fyra-ir" && argc >= 3) { options.print_fyra_ir = true; return LM::Compiler::executeFile(argv[2], options); }
 #endif
@@ -71,6 +89,19 @@ int main(int argc, char* argv[]) {
         for (int i = 2; i < argc; i++) {
             std::string arg = argv[i];
             if (arg == "-debug") options.debug = true;
+            else if (arg == "-max-steps" || arg == "-timeout-ms") {
+                uint64_t& limit = arg == "-max-steps" ? options.max_steps : options.timeout_ms;
+                if (i + 1 >= argc) {
+                    std::cerr << "Error: " << arg << " expects a value\n";
+                    printUsage(argv[0]);
+                    return 1;
+                }
+                if (!parseCount(arg.c_str(), argv[++i], limit)) {
+                    printUsage(argv[0]);
+                    return 1;
+                }
+            }
+            else if (arg == "-gc-stats") options.gc_stats = true;
             else if (arg[0] != '-') source_file = arg;
         }
         if (source_file.empty()) return 1;
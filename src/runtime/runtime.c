@@ -1,6 +1,8 @@
 #define BUILDING_RUNTIME
 #define _POSIX_C_SOURCE 200809L
 #include "runtime.h"
+#include "runtime_gc.h"
+#include "runtime_value.h"
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
@@ -23,7 +25,6 @@ RUNTIME_API void lm_print_box(LmBox* box) {
         case LM_BOX_INT: printf("%ld\n", box->value.as_int); break;
         case LM_BOX_FLOAT: printf("%f\n", box->value.as_float); break;
         case LM_BOX_BOOL: printf("%s\n", box->value.as_bool ? "true" : "false"); break;
-        case LM_BOX_STRING: printf("%s\n", (char*)box->value.as_ptr); break;
         case LM_BOX_NULLPTR: printf("null\n"); break;
         default: printf("<unknown box type %d>\n", box->type);
     }
@@ -37,7 +38,7 @@ RUNTIME_API void lm_assert(int condition, const char* message) {
 }
 
 RUNTIME_API LmBox* lm_box_int(int64_t value) {
-    LmBox* box = (LmBox*)malloc(sizeof(LmBox));
+    LmBox* box = (LmBox*)lm_gc_alloc(sizeof(LmBox));
     if (!box) return NULL;
     box->header.type_id = TYPE_BOX; 
     box->header.metadata = 0;
@@ -47,7 +48,7 @@ RUNTIME_API LmBox* lm_box_int(int64_t value) {
 }
 
 RUNTIME_API LmBox* lm_box_float(double value) {
-    LmBox* box = (LmBox*)malloc(sizeof(LmBox));
+    LmBox* box = (LmBox*)lm_gc_alloc(sizeof(LmBox));
     if (!box) return NULL;
     box->header.type_id = TYPE_BOX;
     box->header.metadata = 0;
@@ -57,7 +58,7 @@ RUNTIME_API LmBox* lm_box_float(double value) {
 }
 
 RUNTIME_API LmBox* lm_box_bool(uint8_t value) {
-    LmBox* box = (LmBox*)malloc(sizeof(LmBox));
+    LmBox* box = (LmBox*)lm_gc_alloc(sizeof(LmBox));
     if (!box) return NULL;
     box->header.type_id = TYPE_BOX;
     box->header.metadata = 0;
@@ -66,18 +67,8 @@ RUNTIME_API LmBox* lm_box_bool(uint8_t value) {
     return box;
 }
 
-RUNTIME_API LmBox* lm_box_string(const char* value) {
-    LmBox* box = (LmBox*)malloc(sizeof(LmBox));
-    if (!box) return NULL;
-    box->header.type_id = TYPE_BOX;
-    box->header.metadata = 0;
-    box->type = LM_BOX_STRING;
-    box->value.as_ptr = value ? strdup(value) : NULL;
-    return box;
-}
-
 RUNTIME_API LmBox* lm_box_nullptr(void) {
-    LmBox* box = (LmBox*)malloc(sizeof(LmBox));
+    LmBox* box = (LmBox*)lm_gc_alloc(sizeof(LmBox));
     if (!box) return NULL;
     box->header.type_id = TYPE_BOX;
     box->header.metadata = 0;
@@ -101,26 +92,18 @@ RUNTIME_API uint8_t lm_unbox_bool(LmBox* box) {
     return box->value.as_bool;
 }
 
-RUNTIME_API const char* lm_unbox_string(LmBox* box) {
-    if (!box || box->type != LM_BOX_STRING) return "";
-    return (const char*)box->value.as_ptr;
-}
-
 RUNTIME_API void* lm_unbox_ptr(LmBox* box) {
     if (!box) return NULL;
     return box->value.as_ptr;
 }
 
 RUNTIME_API void lm_box_free(LmBox* box) {
-    if (!box) return;
-    if (box->type == LM_BOX_STRING && box->value.as_ptr) {
-        free(box->value.as_ptr);
-    }
-    free(box);
+    if (!box || (box->header.metadata & OBJ_IMMUTABLE)) return;
+    lm_gc_free(box);
 }
 
 RUNTIME_API LmValue lm_alloc_i64(int64_t value) {
-    ObjI64* obj = (ObjI64*)malloc(sizeof(ObjI64));
+    ObjI64* obj = (ObjI64*)lm_gc_alloc(sizeof(ObjI64));
     if (!obj) return VAL_NIL;
     obj->header.type_id = TYPE_I64;
     obj->header.metadata = 0;
@@ -129,7 +112,7 @@ RUNTIME_API LmValue lm_alloc_i64(int64_t value) {
 }
 
 RUNTIME_API LmValue lm_alloc_u64(uint64_t value) {
-    ObjU64* obj = (ObjU64*)malloc(sizeof(ObjU64));
+    ObjU64* obj = (ObjU64*)lm_gc_alloc(sizeof(ObjU64));
     if (!obj) return VAL_NIL;
     obj->header.type_id = TYPE_U64;
     obj->header.metadata = 0;
@@ -138,7 +121,7 @@ RUNTIME_API LmValue lm_alloc_u64(uint64_t value) {
 }
 
 RUNTIME_API LmValue lm_alloc_i128(__int128 value) {
-    ObjI128* obj = (ObjI128*)malloc(sizeof(ObjI128));
+    ObjI128* obj = (ObjI128*)lm_gc_alloc(sizeof(ObjI128));
     if (!obj) return VAL_NIL;
     obj->header.type_id = TYPE_I128;
     obj->header.metadata = 0;
@@ -147,7 +130,7 @@ RUNTIME_API LmValue lm_alloc_i128(__int128 value) {
 }
 
 RUNTIME_API LmValue lm_alloc_u128(unsigned __int128 value) {
-    ObjU128* obj = (ObjU128*)malloc(sizeof(ObjU128));
+    ObjU128* obj = (ObjU128*)lm_gc_alloc(sizeof(ObjU128));
     if (!obj) return VAL_NIL;
     obj->header.type_id = TYPE_U128;
     obj->header.metadata = 0;
@@ -156,7 +139,7 @@ RUNTIME_API LmValue lm_alloc_u128(unsigned __int128 value) {
 }
 
 RUNTIME_API LmValue lm_alloc_float(double value) {
-    ObjFloat* obj = (ObjFloat*)malloc(sizeof(ObjFloat));
+    ObjFloat* obj = (ObjFloat*)lm_gc_alloc(sizeof(ObjFloat));
     if (!obj) return VAL_NIL;
     obj->header.type_id = TYPE_FLOAT;
     obj->header.metadata = 0;
@@ -164,21 +147,58 @@ RUNTIME_API LmValue lm_alloc_float(double value) {
     return BOX_PTR(obj);
 }
 
-RUNTIME_API void* lm_frame_alloc(const char* name, int fields) {
-    LmFrame* frame = (LmFrame*)malloc(sizeof(LmFrame));
+// Interned frame descriptors. Lookups happen when code is loaded, not per
+// object, so a scan under a lock is enough.
+static struct {
+    LmFrameType** types;
+    size_t count;
+    size_t capacity;
+    pthread_mutex_t lock;
+} frame_types = { NULL, 0, 0, PTHREAD_MUTEX_INITIALIZER };
+
+// Frames with the same name and field count share one descriptor; it holds
+// nothing else, so frames of that name from different modules can share it
+RUNTIME_API const LmFrameType* lm_frame_type(const char* name, int field_count) {
+    if (!name || field_count < 0) return NULL;
+    pthread_mutex_lock(&frame_types.lock);
+    LmFrameType* result = NULL;
+    for (size_t i = 0; i < frame_types.count && !result; i++) {
+        LmFrameType* type = frame_types.types[i];
+        if (type->field_count == field_count && strcmp(type->name, name) == 0) result = type;
+    }
+    if (!result && frame_types.count == frame_types.capacity) {
+        size_t capacity = frame_types.capacity ? frame_types.capacity * 2 : 16;
+        LmFrameType** types = (LmFrameType**)realloc(frame_types.types, capacity * sizeof(LmFrameType*));
+        if (types) {
+            frame_types.types = types;
+            frame_types.capacity = capacity;
+        }
+    }
+    if (!result && frame_types.count < frame_types.capacity && (result = (LmFrameType*)malloc(sizeof(LmFrameType)))) {
+        result->name = strdup(name);
+        result->field_count = field_count;
+        frame_types.types[frame_types.count++] = result;
+    }
+    pthread_mutex_unlock(&frame_types.lock);
+    return result;
+}
+
+RUNTIME_API void* lm_frame_new(const LmFrameType* type) {
+    if (!type) return NULL;
+    LmFrame* frame = (LmFrame*)lm_gc_alloc(sizeof(LmFrame) + (size_t)type->field_count * sizeof(LmValue));
     if (!frame) return NULL;
     frame->header.type_id = TYPE_FRAME;
     frame->header.metadata = 0;
-    frame->name = strdup(name);
-    frame->field_count = fields;
-    frame->fields = (LmValue*)calloc(fields, sizeof(LmValue));
-    for (int i = 0; i < fields; i++) frame->fields[i] = VAL_NIL;
-    pthread_mutex_t* mutex = (pthread_mutex_t*)malloc(sizeof(pthread_mutex_t));
-    pthread_mutex_init(mutex, NULL);
-    frame->mutex = mutex;
+    frame->type = type;
+    frame->field_count = type->field_count;
+    for (int i = 0; i < type->field_count; i++) frame->fields[i] = VAL_NIL;
     return (void*)frame;
 }
 
+RUNTIME_API void lm_frame_free(void* frame_ptr) {
+    lm_gc_free(frame_ptr);
+}
+
 RUNTIME_API LmValue lm_frame_get_field(void* frame_ptr, int offset) {
     LmFrame* frame = (LmFrame*)frame_ptr;
     if (!frame || offset < 0 || offset >= frame->field_count) return VAL_NIL;
@@ -194,16 +214,32 @@ RUNTIME_API void lm_frame_set_field(void* frame_ptr, int offset, LmValue value)
 RUNTIME_API LmValue lm_frame_get_field_atomic(void* frame_ptr, int offset) {
     LmFrame* frame = (LmFrame*)frame_ptr;
     if (!frame || offset < 0 || offset >= frame->field_count) return VAL_NIL;
-    pthread_mutex_lock((pthread_mutex_t*)frame->mutex);
-    LmValue val = frame->fields[offset];
-    pthread_mutex_unlock((pthread_mutex_t*)frame->mutex);
-    return val;
+    return __atomic_load_n(&frame->fields[offset], __ATOMIC_SEQ_CST);
 }
 
 RUNTIME_API void lm_frame_set_field_atomic(void* frame_ptr, int offset, LmValue value) {
     LmFrame* frame = (LmFrame*)frame_ptr;
     if (!frame || offset < 0 || offset >= frame->field_count) return;
-    pthread_mutex_lock((pthread_mutex_t*)frame->mutex);
-    frame->fields[offset] = value;
-    pthread_mutex_unlock((pthread_mutex_t*)frame->mutex);
+    __atomic_store_n(&frame->fields[offset], value, __ATOMIC_SEQ_CST);
+}
+
+// Retries when another thread changes the field between the load and the
+// exchange; a discarded boxed result is left to the collector
+static void field_atomic_update(void* frame_ptr, int offset, LmValue value, bool subtract) {
+    LmFrame* frame = (LmFrame*)frame_ptr;
+    if (!frame || offset < 0 || offset >= frame->field_count) return;
+    LmValue* field = &frame->fields[offset];
+    LmValue current = __atomic_load_n(field, __ATOMIC_SEQ_CST);
+    LmValue updated;
+    do {
+        updated = subtract ? lm_sub_inline(current, value) : lm_add_inline(current, value);
+    } while (!__atomic_compare_exchange_n(field, &current, updated, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST));
+}
+
+RUNTIME_API void lm_frame_field_atomic_add(void* frame_ptr, int offset, LmValue value) {
+    field_atomic_update(frame_ptr, offset, value, false);
+}
+
+RUNTIME_API void lm_frame_field_atomic_sub(void* frame_ptr, int offset, LmValue value) {
+    field_atomic_update(frame_ptr, offset, value, true);
 }
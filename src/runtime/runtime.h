@@ -57,7 +57,7 @@ typedef struct {
 // Legacy LmBox (Keeping for compatibility for now, but will transition)
 typedef struct {
     ObjHeader header;
-    uint8_t type;  // 0=int, 1=float, 2=bool, 3=string, 4=nullptr
+    uint8_t type;  // 0=int, 1=float, 2=bool, 4=nullptr; strings are ObjString
     union {
         int64_t as_int;
         double as_float;
@@ -70,7 +70,6 @@ typedef struct {
 #define LM_BOX_INT    0
 #define LM_BOX_FLOAT  1
 #define LM_BOX_BOOL   2
-#define LM_BOX_STRING 3
 #define LM_BOX_NULLPTR 4
 
 // Runtime Object Allocation Helpers
@@ -84,26 +83,34 @@ RUNTIME_API LmValue lm_alloc_float(double value);
 RUNTIME_API LmBox* lm_box_int(int64_t value);
 RUNTIME_API LmBox* lm_box_float(double value);
 RUNTIME_API LmBox* lm_box_bool(uint8_t value);
-RUNTIME_API LmBox* lm_box_string(const char* value);
 RUNTIME_API LmBox* lm_box_nullptr(void);
 
 // Unboxing operations (legacy)
 RUNTIME_API int64_t lm_unbox_int(LmBox* box);
 RUNTIME_API double lm_unbox_float(LmBox* box);
 RUNTIME_API uint8_t lm_unbox_bool(LmBox* box);
-RUNTIME_API const char* lm_unbox_string(LmBox* box);
 RUNTIME_API void* lm_unbox_ptr(LmBox* box);
 
 // Memory management
 RUNTIME_API void lm_box_free(LmBox* box);
 
 // Frame runtime support
+//
+// Immutable data shared by every instance of a frame type. Descriptors are
+// interned by name and field count and live for the rest of the run.
+// Methods are resolved statically, so descriptors carry no method tables.
+typedef struct LmFrameType {
+    const char* name;
+    int field_count;
+} LmFrameType;
+
+// A frame is one block: the header, its type and the fields inline.
+// Atomic field access works on the field itself, so frames need no lock.
 typedef struct {
     ObjHeader header;
-    char* name;
-    LmValue* fields;
-    int field_count;
-    void* mutex;
+    const LmFrameType* type;
+    int field_count;  // Copy of type->field_count for the field access paths
+    LmValue fields[];
 } LmFrame;
 
 typedef struct {
@@ -113,14 +120,17 @@ typedef struct {
     uint32_t captured_count;
 } LmClosure;
 
-RUNTIME_API void* lm_frame_alloc(const char* name, int fields);
+// Interned descriptor lookup; it locks and scans, so callers resolve it once
+// and allocate with lm_frame_new
+RUNTIME_API const LmFrameType* lm_frame_type(const char* name, int field_count);
+RUNTIME_API void* lm_frame_new(const LmFrameType* type);  // Fields start as nil
+RUNTIME_API void lm_frame_free(void* frame);
 RUNTIME_API LmValue lm_frame_get_field(void* frame, int offset);
 RUNTIME_API void lm_frame_set_field(void* frame, int offset, LmValue value);
 RUNTIME_API LmValue lm_frame_get_field_atomic(void* frame, int offset);
 RUNTIME_API void lm_frame_set_field_atomic(void* frame, int offset, LmValue value);
 RUNTIME_API void lm_frame_field_atomic_add(void* frame, int offset, LmValue value);
 RUNTIME_API void lm_frame_field_atomic_sub(void* frame, int offset, LmValue value);
-RUNTIME_API void* lm_trait_dispatch(void* trait_obj, const char* trait_name, const char* method_name);
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,157 @@
+#define BUILDING_RUNTIME
+#include "runtime_alloc.h"
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <pthread.h>
+
+// Fresh memory is carved from pages of this size
+#define PAGE_SIZE (64u << 10)
+// Blocks moved between a thread cache and the central pool at once. A
+// thread cache holding twice as many returns one batch.
+#define CACHE_BATCH 64
+
+#if defined(_MSC_VER)
+    #define THREAD_LOCAL __declspec(thread)
+#else
+    #define THREAD_LOCAL __thread
+#endif
+
+// A free block. Batches in the central pool are chained through the second
+// word of their first block.
+typedef struct Block {
+    struct Block* next;
+    struct Block* next_batch;
+} Block;
+
+static const size_t class_sizes[LM_SIZE_CLASS_COUNT] = { 16, 32, 48, 64, 96, 128, 192, 256 };
+
+static struct {
+    pthread_mutex_t lock;
+    Block* batches[LM_SIZE_CLASS_COUNT];
+} central = { PTHREAD_MUTEX_INITIALIZER, { NULL } };
+
+typedef struct {
+    Block* free[LM_SIZE_CLASS_COUNT];
+    size_t count[LM_SIZE_CLASS_COUNT];
+    char* bump;
+    char* bump_end;
+    bool registered;
+} ThreadCache;
+
+static THREAD_LOCAL ThreadCache cache;
+
+static pthread_once_t exit_key_once = PTHREAD_ONCE_INIT;
+static pthread_key_t exit_key;
+
+static void flush_on_exit(void* unused) {
+    (void)unused;
+    lm_alloc_flush_thread();
+}
+
+static void create_exit_key(void) {
+    pthread_key_create(&exit_key, flush_on_exit);
+}
+
+// The key's value only needs to be non-null for the destructor to run
+static void register_thread(void) {
+    cache.registered = true;
+    pthread_once(&exit_key_once, create_exit_key);
+    pthread_setspecific(exit_key, &cache);
+}
+
+static void push_batch(LmSizeClass size_class, Block* batch) {
+    pthread_mutex_lock(&central.lock);
+    batch->next_batch = central.batches[size_class];
+    central.batches[size_class] = batch;
+    pthread_mutex_unlock(&central.lock);
+}
+
+static Block* pop_batch(LmSizeClass size_class) {
+    pthread_mutex_lock(&central.lock);
+    Block* batch = central.batches[size_class];
+    if (batch) central.batches[size_class] = batch->next_batch;
+    pthread_mutex_unlock(&central.lock);
+    return batch;
+}
+
+// Chain up to CACHE_BATCH blocks from the current page, starting a new page
+// when it cannot hold a single one
+static Block* carve_batch(LmSizeClass size_class) {
+    size_t size = class_sizes[size_class];
+    if ((size_t)(cache.bump_end - cache.bump) < size) {
+        char* page = (char*)malloc(PAGE_SIZE);
+        if (!page) return NULL;
+        cache.bump = page;
+        cache.bump_end = page + PAGE_SIZE;
+    }
+
+    size_t count = (size_t)(cache.bump_end - cache.bump) / size;
+    if (count > CACHE_BATCH) count = CACHE_BATCH;
+    Block* first = (Block*)cache.bump;
+    for (size_t i = 0; i + 1 < count; i++) {
+        ((Block*)(cache.bump + i * size))->next = (Block*)(cache.bump + (i + 1) * size);
+    }
+    ((Block*)(cache.bump + (count - 1) * size))->next = NULL;
+    cache.bump += count * size;
+    return first;
+}
+
+static void* refill(LmSizeClass size_class) {
+    if (!cache.registered) register_thread();
+
+    Block* batch = pop_batch(size_class);
+    if (!batch) batch = carve_batch(size_class);
+    if (!batch) return NULL;
+
+    size_t count = 0;
+    for (Block* block = batch->next; block; block = block->next) count++;
+    cache.free[size_class] = batch->next;
+    cache.count[size_class] = count;
+    return batch;
+}
+
+RUNTIME_API size_t lm_class_size(LmSizeClass size_class) {
+    return size_class < LM_SIZE_CLASS_COUNT ? class_sizes[size_class] : 0;
+}
+
+RUNTIME_API void* lm_alloc(LmSizeClass size_class) {
+    Block* block = cache.free[size_class];
+    if (!block) return refill(size_class);
+    cache.free[size_class] = block->next;
+    cache.count[size_class]--;
+    return block;
+}
+
+RUNTIME_API void lm_free(void* block, LmSizeClass size_class) {
+    if (!block) return;
+    Block* freed = (Block*)block;
+    freed->next = cache.free[size_class];
+    cache.free[size_class] = freed;
+    if (++cache.count[size_class] < 2 * CACHE_BATCH) return;
+
+    // Return the oldest CACHE_BATCH blocks, the newest stay warm
+    if (!cache.registered) register_thread();
+    Block* last = freed;
+    for (size_t i = 1; i < CACHE_BATCH; i++) last = last->next;
+    Block* batch = last->next;
+    last->next = NULL;
+    cache.count[size_class] = CACHE_BATCH;
+    push_batch(size_class, batch);
+}
+
+RUNTIME_API void lm_alloc_flush_thread(void) {
+    for (int size_class = 0; size_class < LM_SIZE_CLASS_COUNT; size_class++) {
+        Block* block = cache.free[size_class];
+        while (block) {
+            Block* batch = block;
+            Block* last = block;
+            for (size_t i = 1; i < CACHE_BATCH && last->next; i++) last = last->next;
+            block = last->next;
+            last->next = NULL;
+            push_batch((LmSizeClass)size_class, batch);
+        }
+        cache.free[size_class] = NULL;
+        cache.count[size_class] = 0;
+    }
+}
@@ -0,0 +1,64 @@
+#ifndef RUNTIME_ALLOC_H
+#define RUNTIME_ALLOC_H
+
+#include <stddef.h>
+
+// For static linking, define as empty
+#ifndef RUNTIME_API
+    #define RUNTIME_API
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Size-class allocator for small runtime blocks.
+//
+// Each thread keeps a free list per class and trades blocks with a central
+// pool in batches, so the lock is taken once per batch. When the pool is
+// empty, a batch is carved from the thread's current page with a bump
+// pointer. Pages are never returned to the system. The classes cover the
+// runtime objects plus their lm_gc_alloc link: 32 bytes for boxed numbers
+// and dict entries, 48 for lists, tuples and boxes, 64 for dicts and frames.
+// Larger requests use malloc.
+typedef enum {
+    LM_CLASS_16,
+    LM_CLASS_32,
+    LM_CLASS_48,
+    LM_CLASS_64,
+    LM_CLASS_96,
+    LM_CLASS_128,
+    LM_CLASS_192,
+    LM_CLASS_256,
+    LM_SIZE_CLASS_COUNT  // Returned by lm_size_class for sizes it does not cover
+} LmSizeClass;
+
+#define LM_MAX_CLASS_SIZE 256
+
+// Smallest class that fits size, a constant when size is
+static inline LmSizeClass lm_size_class(size_t size) {
+    static const unsigned char classes[LM_MAX_CLASS_SIZE / 16 + 1] = {
+        LM_CLASS_16, LM_CLASS_16, LM_CLASS_32, LM_CLASS_48, LM_CLASS_64,
+        LM_CLASS_96, LM_CLASS_96, LM_CLASS_128, LM_CLASS_128,
+        LM_CLASS_192, LM_CLASS_192, LM_CLASS_192, LM_CLASS_192,
+        LM_CLASS_256, LM_CLASS_256, LM_CLASS_256, LM_CLASS_256,
+    };
+    return size <= LM_MAX_CLASS_SIZE ? (LmSizeClass)classes[(size + 15) / 16] : LM_SIZE_CLASS_COUNT;
+}
+
+RUNTIME_API size_t lm_class_size(LmSizeClass size_class);
+
+// Blocks are 16-byte aligned and uninitialized. A block may be freed from
+// any thread, with the class it was allocated from.
+RUNTIME_API void* lm_alloc(LmSizeClass size_class);
+RUNTIME_API void lm_free(void* block, LmSizeClass size_class);
+
+// Hand the calling thread's cached blocks back to the central pool. Runs
+// automatically when a thread that used the allocator exits.
+RUNTIME_API void lm_alloc_flush_thread(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // RUNTIME_ALLOC_H
@@ -2,97 +2,268 @@
 #include "runtime_dict.h"
 #include "runtime_value.h"
 #include "runtime.h"
+#include "runtime_gc.h"
 #include <stdlib.h>
 #include <string.h>
 #include <stdint.h>
+#include <stdbool.h>
 
-#define INITIAL_BUCKET_COUNT 16
+#if defined(__SSE2__) || defined(_M_X64)
+    #include <emmintrin.h>
+    #define GROUP_SSE2
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+    #include <arm_neon.h>
+    #define GROUP_NEON
+#endif
+
+// Control bytes past the capacity of a table smaller than a group stay empty
+#define GROUP_WIDTH LM_DICT_GROUP_WIDTH
+#define MIN_CAPACITY 4
+
+// Bit i is set when byte i of the group matches
+typedef uint32_t GroupMask;
+
+#if defined(GROUP_SSE2)
+static inline GroupMask group_match(const uint8_t* group, uint8_t byte) {
+    __m128i bytes = _mm_loadu_si128((const __m128i*)group);
+    return (GroupMask)_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, _mm_set1_epi8((char)byte)));
+}
+
+// Empty and deleted slots are the ones with the high bit set
+static inline GroupMask group_match_free(const uint8_t* group) {
+    return (GroupMask)_mm_movemask_epi8(_mm_loadu_si128((const __m128i*)group));
+}
+#elif defined(GROUP_NEON)
+static inline GroupMask neon_mask(uint8x16_t matches) {
+    static const uint8_t bits[16] = { 1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128 };
+    uint8x16_t masked = vandq_u8(matches, vld1q_u8(bits));
+    return (GroupMask)vaddv_u8(vget_low_u8(masked)) | ((GroupMask)vaddv_u8(vget_high_u8(masked)) << 8);
+}
+
+static inline GroupMask group_match(const uint8_t* group, uint8_t byte) {
+    return neon_mask(vceqq_u8(vld1q_u8(group), vdupq_n_u8(byte)));
+}
+
+static inline GroupMask group_match_free(const uint8_t* group) {
+    return neon_mask(vcltq_s8(vreinterpretq_s8_u8(vld1q_u8(group)), vdupq_n_s8(0)));
+}
+#else
+static inline GroupMask group_match(const uint8_t* group, uint8_t byte) {
+    GroupMask mask = 0;
+    for (int i = 0; i < GROUP_WIDTH; i++) mask |= (GroupMask)(group[i] == byte) << i;
+    return mask;
+}
+
+static inline GroupMask group_match_free(const uint8_t* group) {
+    GroupMask mask = 0;
+    for (int i = 0; i < GROUP_WIDTH; i++) mask |= (GroupMask)(group[i] >> 7) << i;
+    return mask;
+}
+#endif
+
+static inline unsigned lowest_bit(GroupMask mask) {
+    return (unsigned)__builtin_ctz(mask);
+}
+
+// Key hashes are mixed so that both the low bits choosing the group and the
+// top seven bits kept in the control byte vary with every input bit
+static inline uint64_t mix_hash(uint64_t hash) {
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdULL;
+    hash ^= hash >> 33;
+    return hash;
+}
+
+static inline uint8_t hash_tag(uint64_t hash) {
+    return (uint8_t)(hash >> 57);
+}
+
+static inline uint64_t ctrl_bytes(uint64_t capacity) {
+    return capacity < GROUP_WIDTH ? GROUP_WIDTH : capacity;
+}
+
+static inline uint64_t group_count(uint64_t capacity) {
+    return ctrl_bytes(capacity) / GROUP_WIDTH;
+}
+
+// Entries a table holds before it grows: every slot but one in tables
+// within a single group, seven eighths of larger ones
+static inline uint64_t max_load(uint64_t capacity) {
+    return capacity <= GROUP_WIDTH / 2 ? capacity - 1 : capacity - capacity / 8;
+}
+
+static inline size_t table_bytes(uint64_t capacity) {
+    return (size_t)capacity * sizeof(LmDictSlot) + (size_t)ctrl_bytes(capacity);
+}
+
+// Groups are visited in triangular order, which reaches every group of a
+// power-of-two table
+#define FOR_EACH_GROUP(dict, hash, group)                                           \
+    for (uint64_t group##_mask = group_count((dict)->capacity) - 1,                 \
+                  group = (hash) & group##_mask, group##_step = 1;;                 \
+         group = (group + group##_step++) & group##_mask)
+
+static LmDictSlot* find_slot(LmDict* dict, LmValue key, uint64_t hash) {
+    if (dict->capacity == 0) return NULL;
+    uint8_t tag = hash_tag(hash);
+    FOR_EACH_GROUP(dict, hash, group) {
+        const uint8_t* ctrl = dict->ctrl + group * GROUP_WIDTH;
+        for (GroupMask match = group_match(ctrl, tag); match; match &= match - 1) {
+            LmDictSlot* slot = &dict->slots[group * GROUP_WIDTH + lowest_bit(match)];
+            if (slot->hash == hash && (slot->key == key || dict->cmp_fn(slot->key, key) == 0)) return slot;
+        }
+        // Inserts fill the first free slot on the way, so the key would be here
+        if (group_match(ctrl, LM_DICT_EMPTY)) return NULL;
+    }
+}
+
+// The first empty or deleted slot on the key's probe sequence
+static uint64_t find_free(const LmDict* dict, uint64_t hash) {
+    GroupMask in_table = dict->capacity < GROUP_WIDTH ? (1u << dict->capacity) - 1 : 0xFFFFu;
+    FOR_EACH_GROUP(dict, hash, group) {
+        GroupMask free = group_match_free(dict->ctrl + group * GROUP_WIDTH) & in_table;
+        if (free) return group * GROUP_WIDTH + lowest_bit(free);
+    }
+}
+
+// Move every entry into a fresh table. Deleted slots are dropped on the way.
+static bool resize(LmDict* dict, uint64_t capacity) {
+    char* table = (char*)malloc(table_bytes(capacity));
+    if (!table) return false;
+
+    LmDictSlot* old_slots = dict->slots;
+    uint8_t* old_ctrl = dict->ctrl;
+    uint64_t old_capacity = dict->capacity;
+
+    dict->slots = (LmDictSlot*)table;
+    dict->ctrl = (uint8_t*)(table + (size_t)capacity * sizeof(LmDictSlot));
+    dict->capacity = capacity;
+    dict->growth_left = max_load(capacity) - dict->size;
+    memset(dict->ctrl, LM_DICT_EMPTY, ctrl_bytes(capacity));
+
+    for (uint64_t i = 0; i < old_capacity; i++) {
+        if (old_ctrl[i] >= LM_DICT_EMPTY) continue;
+        uint64_t index = find_free(dict, old_slots[i].hash);
+        dict->ctrl[index] = old_ctrl[i];
+        dict->slots[index] = old_slots[i];
+    }
+
+    if (capacity > old_capacity) lm_gc_account(table_bytes(capacity) - (old_capacity ? table_bytes(old_capacity) : 0));
+    free(old_slots);
+    return true;
+}
 
 RUNTIME_API LmDict* lm_dict_new(uint64_t (*hash_fn)(LmValue),
                                  int (*cmp_fn)(LmValue, LmValue)) {
-    LmDict* dict = (LmDict*)malloc(sizeof(LmDict));
+    LmDict* dict = (LmDict*)lm_gc_alloc(sizeof(LmDict));
     if (!dict) return NULL;
     
+    // The table is allocated by the first insert
     dict->header.type_id = TYPE_DICT;
     dict->header.metadata = 0;
-    dict->bucket_count = INITIAL_BUCKET_COUNT;
+    dict->slots = NULL;
+    dict->ctrl = NULL;
+    dict->capacity = 0;
     dict->size = 0;
+    dict->growth_left = 0;
+    dict->version = 0;
     dict->hash_fn = hash_fn;
     dict->cmp_fn = cmp_fn;
     
-    dict->buckets = (LmDictEntry**)calloc(dict->bucket_count, 
-                                           sizeof(LmDictEntry*));
-    if (!dict->buckets) {
-        free(dict);
-        return NULL;
-    }
-    
     return dict;
 }
 
 RUNTIME_API void lm_dict_set(LmDict* dict, LmValue key, LmValue value) {
     if (!dict) return;
     
-    uint64_t hash = dict->hash_fn(key);
-    uint64_t bucket = hash % dict->bucket_count;
-    
-    // Check if key already exists
-    LmDictEntry* entry = dict->buckets[bucket];
-    while (entry) {
-        if (entry->hash == hash && dict->cmp_fn(entry->key, key) == 0) {
-            entry->value = value;
-            return;
-        }
-        entry = entry->next;
+    uint64_t hash = mix_hash(dict->hash_fn(key));
+    LmDictSlot* slot = find_slot(dict, key, hash);
+    if (slot) {
+        slot->value = value;
+        return;
     }
     
-    // Create new entry
-    LmDictEntry* new_entry = (LmDictEntry*)malloc(sizeof(LmDictEntry));
-    if (!new_entry) return;
+    // Reusing a deleted slot costs nothing. Taking an empty one from a full
+    // table first rehashes it, in place when deleted slots hold half of it.
+    uint64_t index = dict->capacity ? find_free(dict, hash) : 0;
+    if (dict->growth_left == 0 && (dict->capacity == 0 || dict->ctrl[index] == LM_DICT_EMPTY)) {
+        uint64_t capacity = dict->capacity == 0 ? MIN_CAPACITY
+                          : dict->size <= max_load(dict->capacity) / 2 ? dict->capacity
+                          : dict->capacity * 2;
+        if (!resize(dict, capacity)) return;
+        index = find_free(dict, hash);
+    }
+    if (dict->ctrl[index] == LM_DICT_EMPTY) dict->growth_left--;
     
-    new_entry->key = key;
-    new_entry->value = value;
-    new_entry->hash = hash;
-    new_entry->next = dict->buckets[bucket];
-    dict->buckets[bucket] = new_entry;
+    // String keys are interned, so looking them up with interned strings
+    // compares pointers
+    dict->ctrl[index] = hash_tag(hash);
+    dict->slots[index].key = lm_string_intern_value(key);
+    dict->slots[index].value = value;
+    dict->slots[index].hash = hash;
     dict->size++;
+    dict->version++;
 }
 
 RUNTIME_API LmValue lm_dict_get(LmDict* dict, LmValue key) {
-    if (!dict) return VAL_NIL;
-    
-    uint64_t hash = dict->hash_fn(key);
-    uint64_t bucket = hash % dict->bucket_count;
+    if (!dict || dict->size == 0) return VAL_NIL;
     
-    LmDictEntry* entry = dict->buckets[bucket];
-    while (entry) {
-        if (entry->hash == hash && dict->cmp_fn(entry->key, key) == 0) {
-            return entry->value;
-        }
-        entry = entry->next;
-    }
-    
-    return VAL_NIL;
+    LmDictSlot* slot = find_slot(dict, key, mix_hash(dict->hash_fn(key)));
+    return slot ? slot->value : VAL_NIL;
 }
 
 RUNTIME_API int lm_dict_contains(LmDict* dict, LmValue key) {
     return lm_dict_get(dict, key) != VAL_NIL;
 }
 
+// A slot whose group still has an empty byte has never been part of a full
+// group, so no probe sequence runs past it and it can become empty again.
+// Otherwise it is marked deleted until the next rehash.
+RUNTIME_API int lm_dict_remove(LmDict* dict, LmValue key) {
+    if (!dict || dict->size == 0) return 0;
+    
+    LmDictSlot* slot = find_slot(dict, key, mix_hash(dict->hash_fn(key)));
+    if (!slot) return 0;
+    
+    uint64_t index = (uint64_t)(slot - dict->slots);
+    if (group_match(dict->ctrl + (index & ~(uint64_t)(GROUP_WIDTH - 1)), LM_DICT_EMPTY)) {
+        dict->ctrl[index] = LM_DICT_EMPTY;
+        dict->growth_left++;
+    } else {
+        dict->ctrl[index] = LM_DICT_DELETED;
+    }
+    slot->key = VAL_NIL;
+    slot->value = VAL_NIL;
+    dict->size--;
+    dict->version++;
+    return 1;
+}
+
 RUNTIME_API void lm_dict_free(LmDict* dict) {
     if (!dict) return;
     
-    for (uint64_t i = 0; i < dict->bucket_count; i++) {
-        LmDictEntry* entry = dict->buckets[i];
-        while (entry) {
-            LmDictEntry* next = entry->next;
-            free(entry);
-            entry = next;
-        }
-    }
+    free(dict->slots);
+    lm_gc_free(dict);
+}
+
+RUNTIME_API LmDictIter lm_dict_iter_begin(const LmDict* dict) {
+    LmDictIter iter = { 0, dict ? dict->version : 0 };
+    return iter;
+}
+
+RUNTIME_API LmIterStep lm_dict_iter_next(const LmDict* dict, LmDictIter* iter, LmValue* key, LmValue* value) {
+    if (!dict) return LM_ITER_END;
+    if (iter->version != dict->version) return LM_ITER_MODIFIED;
     
-    free(dict->buckets);
-    free(dict);
+    for (uint64_t i = iter->index; i < dict->capacity; i++) {
+        if (!LM_DICT_SLOT_USED(dict, i)) continue;
+        if (key) *key = dict->slots[i].key;
+        if (value) *value = dict->slots[i].value;
+        iter->index = i + 1;
+        return LM_ITER_ITEM;
+    }
+    iter->index = dict->capacity;
+    return LM_ITER_END;
 }
 
 RUNTIME_API LmValue* lm_dict_items(LmDict* dict, uint64_t* out_count) {
@@ -107,16 +278,8 @@ RUNTIME_API LmValue* lm_dict_items(LmDict* dict, uint64_t* out_count) {
         return NULL;
     }
     
-    uint64_t index = 0;
-    for (uint64_t i = 0; i < dict->bucket_count; i++) {
-        LmDictEntry* entry = dict->buckets[i];
-        while (entry) {
-            items[index * 2] = entry->key;
-            items[index * 2 + 1] = entry->value;
-            index++;
-            entry = entry->next;
-        }
-    }
+    LmDictIter iter = lm_dict_iter_begin(dict);
+    for (uint64_t i = 0; lm_dict_iter_next(dict, &iter, &items[i * 2], &items[i * 2 + 1]) == LM_ITER_ITEM; i++) {}
     
     *out_count = dict->size;
     return items;
@@ -128,16 +291,7 @@ RUNTIME_API uint64_t lm_hash_int(LmValue key) {
 }
 
 RUNTIME_API uint64_t lm_hash_string(LmValue key) {
-    if (!IS_PTR(key)) return 0;
-    LmBox* box = (LmBox*)UNBOX_PTR(key);
-    if (box->header.type_id != TYPE_BOX || box->type != LM_BOX_STRING) return 0;
-    const char* str = (const char*)box->value.as_ptr;
-    uint64_t hash = 5381;
-    int c;
-    while ((c = *str++)) {
-        hash = ((hash << 5) + hash) + c;
-    }
-    return hash;
+    return lm_is_string(key) ? lm_string_hash(AS_STRING(key)) : 0;
 }
 
 RUNTIME_API int lm_cmp_int(LmValue k1, LmValue k2) {
@@ -148,11 +302,9 @@ RUNTIME_API int lm_cmp_int(LmValue k1, LmValue k2) {
 
 RUNTIME_API int lm_cmp_string(LmValue k1, LmValue k2) {
     if (!IS_PTR(k1) || !IS_PTR(k2)) return (k1 > k2) - (k1 < k2);
-    LmBox* b1 = (LmBox*)UNBOX_PTR(k1);
-    LmBox* b2 = (LmBox*)UNBOX_PTR(k2);
-    if (b1->header.type_id != TYPE_BOX || b1->type != LM_BOX_STRING) return 1;
-    if (b2->header.type_id != TYPE_BOX || b2->type != LM_BOX_STRING) return -1;
-    return strcmp((const char*)b1->value.as_ptr, (const char*)b2->value.as_ptr);
+    if (!lm_is_string(k1)) return 1;
+    if (!lm_is_string(k2)) return -1;
+    return lm_string_equals(AS_STRING(k1), AS_STRING(k2)) ? 0 : lm_string_compare(AS_STRING(k1), AS_STRING(k2));
 }
 
 RUNTIME_API uint64_t hash_boxed_value(LmValue key) {
@@ -161,7 +313,7 @@ RUNTIME_API uint64_t hash_boxed_value(LmValue key) {
     if (IS_NIL(key)) return 0;
     if (IS_PTR(key)) {
         ObjHeader* h = (ObjHeader*)UNBOX_PTR(key);
-        if (h->type_id == TYPE_BOX && ((LmBox*)h)->type == LM_BOX_STRING) return lm_hash_string(key);
+        if (h->type_id == TYPE_STRING) return lm_string_hash((ObjString*)h);
         return (uint64_t)h;
     }
     return (uint64_t)key;
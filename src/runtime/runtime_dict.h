@@ -3,6 +3,7 @@
 
 #include <stdint.h>
 #include "runtime_value_base.h"
+#include "runtime_iter.h"
 
 // For static linking, define as empty
 #ifndef RUNTIME_API
@@ -13,29 +14,54 @@
 extern "C" {
 #endif
 
-typedef struct LmDictEntry {
+// Open-addressing hash table. Each slot has a control byte: the top seven
+// bits of its hash while it is in use, or LM_DICT_EMPTY / LM_DICT_DELETED.
+// Control bytes are probed a group at a time, and the keys, values and
+// hashes live inline in one slot array allocated together with them. Tables
+// smaller than a group still have a whole group of control bytes.
+#define LM_DICT_EMPTY       0x80
+#define LM_DICT_DELETED     0xFE
+#define LM_DICT_GROUP_WIDTH 16
+
+typedef struct {
     LmValue key;
     LmValue value;
     uint64_t hash;
-    struct LmDictEntry* next;
-} LmDictEntry;
+} LmDictSlot;
 
 typedef struct {
     ObjHeader header;
-    LmDictEntry** buckets;
-    uint64_t bucket_count;
+    LmDictSlot* slots;
+    uint8_t* ctrl;            // Control bytes, in the same block after the slots
+    uint64_t capacity;        // Zero or a power of two
     uint64_t size;
+    uint64_t growth_left;     // Inserts into empty slots before the table grows
+    uint64_t version;         // Changes whenever an entry is added or removed
     uint64_t (*hash_fn)(LmValue key);
     int (*cmp_fn)(LmValue k1, LmValue k2);
 } LmDict;
 
+// True for slots holding an entry
+#define LM_DICT_SLOT_USED(dict, index) ((dict)->ctrl[index] < LM_DICT_EMPTY)
+
+// Iteration over the slots in place, in slot order. Adding or removing an
+// entry ends an iteration begun before it with LM_ITER_MODIFIED; updating
+// the value of an existing key does not.
+typedef struct {
+    uint64_t index;           // Slot after the current entry
+    uint64_t version;         // The dict's version when iteration began
+} LmDictIter;
+
 // Dict operations
 RUNTIME_API LmDict* lm_dict_new(uint64_t (*hash_fn)(LmValue),
                                  int (*cmp_fn)(LmValue, LmValue));
 RUNTIME_API void lm_dict_set(LmDict* dict, LmValue key, LmValue value);
 RUNTIME_API LmValue lm_dict_get(LmDict* dict, LmValue key);
 RUNTIME_API LmValue* lm_dict_items(LmDict* dict, uint64_t* out_count);
+RUNTIME_API LmDictIter lm_dict_iter_begin(const LmDict* dict);
+RUNTIME_API LmIterStep lm_dict_iter_next(const LmDict* dict, LmDictIter* iter, LmValue* key, LmValue* value);
 RUNTIME_API int lm_dict_contains(LmDict* dict, LmValue key);
+RUNTIME_API int lm_dict_remove(LmDict* dict, LmValue key);
 RUNTIME_API void lm_dict_free(LmDict* dict);
 
 // Built-in hash functions for common types
@@ -0,0 +1,45 @@
+#ifndef RUNTIME_FORMAT_H
+#define RUNTIME_FORMAT_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "runtime_value_base.h"
+
+// For static linking, define as empty
+#ifndef RUNTIME_API
+    #define RUNTIME_API
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Number formatting into caller buffers, without allocating.
+//
+// Each function writes the text without a terminating NUL and returns its
+// length. LM_NUMBER_CHARS bytes hold any of them. Doubles print the
+// shortest digits that read back as the same value, laid out like %g: in
+// fixed notation for decimal exponents from -4 to 14 and in scientific
+// notation otherwise, so 0.1 prints as 0.1, 2.0 as 2 and 1e20 as 1e+20.
+#define LM_NUMBER_CHARS 48
+
+RUNTIME_API size_t lm_format_u64(uint64_t value, char* out);
+RUNTIME_API size_t lm_format_i64(int64_t value, char* out);
+RUNTIME_API size_t lm_format_u128(unsigned __int128 value, char* out);
+RUNTIME_API size_t lm_format_i128(__int128 value, char* out);
+RUNTIME_API size_t lm_format_double(double value, char* out);
+
+// A fixed-scale decimal held as its scaled integer: 1025 at scale 2 prints
+// as 10.25, always with scale fractional digits
+RUNTIME_API size_t lm_format_decimal(__int128 scaled, int scale, char* out);
+
+// The text of a number, bool or nil. Returns false, writing nothing, for
+// any other value.
+RUNTIME_API bool lm_format_scalar(LmValue value, char* out, size_t* length);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // RUNTIME_FORMAT_H
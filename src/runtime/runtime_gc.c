@@ -0,0 +1,445 @@
+#define BUILDING_RUNTIME
+#define _POSIX_C_SOURCE 200809L
+#include "runtime_gc.h"
+#include "runtime_alloc.h"
+#include "runtime.h"
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// Heap size below which no collection is requested, and the factor the live
+// heap may grow by before the next one
+#define GC_MIN_THRESHOLD (4u << 20)
+#define GC_GROWTH_FACTOR 2
+
+// Region arena chunk size; larger objects fall back to the heap
+#define REGION_CHUNK_SIZE (64u << 10)
+
+// Every object allocated through lm_gc_alloc is preceded by a link. While
+// the collector is enabled, links chain the tracked objects into a circular
+// list around heap.objects; objects allocated before that have null links
+// and are never swept. Region objects chain to the previous region object
+// through prev and keep their arena offset in next, tagged with the low bit.
+// The low bits of prev keep the block's size class plus one, or zero for
+// blocks from malloc. 16 bytes keep the object 16-byte aligned.
+typedef struct GcLink {
+    struct GcLink* prev;
+    struct GcLink* next;
+} GcLink;
+
+#define LINK_OF(object) ((GcLink*)((char*)(object) - sizeof(GcLink)))
+#define OBJECT_OF(link) ((ObjHeader*)((char*)(link) + sizeof(GcLink)))
+#define REGION_TAG 1u
+#define CLASS_BITS 15u
+
+static bool is_region(const GcLink* link) { return ((uintptr_t)link->next & REGION_TAG) != 0; }
+static bool is_tracked(const GcLink* link) { return link->next && !is_region(link); }
+static uint64_t region_offset(const GcLink* link) { return (uint64_t)((uintptr_t)link->next >> 1); }
+static unsigned link_class(const GcLink* link) { return (unsigned)((uintptr_t)link->prev & CLASS_BITS); }
+static GcLink* prev_of(const GcLink* link) { return (GcLink*)((uintptr_t)link->prev & ~(uintptr_t)CLASS_BITS); }
+
+static void set_prev(GcLink* link, GcLink* prev) {
+    link->prev = (GcLink*)((uintptr_t)prev | link_class(link));
+}
+
+// Per-type behaviour, indexed by ObjHeader.type_id. size covers the object
+// and every buffer it owns.
+typedef struct {
+    void (*trace)(ObjHeader* object);
+    size_t (*size)(ObjHeader* object);
+    void (*destroy)(ObjHeader* object);
+} GcTypeInfo;
+
+static void trace_none(ObjHeader* object) { (void)object; }
+static void destroy_plain(ObjHeader* object) { lm_gc_free(object); }
+
+static void trace_list(ObjHeader* object) {
+    LmList* list = (LmList*)object;
+    if (list->kind == LM_LIST_VALUES) lm_gc_mark_values(list->values, list->size);
+}
+
+static void trace_dict(ObjHeader* object) {
+    LmDict* dict = (LmDict*)object;
+    for (uint64_t i = 0; i < dict->capacity; i++) {
+        if (!LM_DICT_SLOT_USED(dict, i)) continue;
+        lm_gc_mark_value(dict->slots[i].key);
+        lm_gc_mark_value(dict->slots[i].value);
+    }
+}
+
+static void trace_tuple(ObjHeader* object) {
+    LmTuple* tuple = (LmTuple*)object;
+    lm_gc_mark_values(tuple->elements, tuple->size);
+}
+
+static void trace_frame(ObjHeader* object) {
+    LmFrame* frame = (LmFrame*)object;
+    lm_gc_mark_values(frame->fields, (size_t)frame->field_count);
+}
+
+static void trace_closure(ObjHeader* object) {
+    LmClosure* closure = (LmClosure*)object;
+    lm_gc_mark_value(closure->function);
+    lm_gc_mark_value(closure->captured_env);
+}
+
+static size_t size_list(ObjHeader* object) {
+    LmList* list = (LmList*)object;
+    return sizeof(LmList) + list->capacity * lm_list_element_size(list->kind);
+}
+
+static size_t size_dict(ObjHeader* object) {
+    LmDict* dict = (LmDict*)object;
+    if (dict->capacity == 0) return sizeof(LmDict);
+    uint64_t ctrl = dict->capacity < LM_DICT_GROUP_WIDTH ? LM_DICT_GROUP_WIDTH : dict->capacity;
+    return sizeof(LmDict) + dict->capacity * sizeof(LmDictSlot) + ctrl;
+}
+
+static size_t size_tuple(ObjHeader* object) {
+    return sizeof(LmTuple) + ((LmTuple*)object)->size * sizeof(LmValue);
+}
+
+static size_t size_frame(ObjHeader* object) {
+    return sizeof(LmFrame) + (size_t)((LmFrame*)object)->field_count * sizeof(LmValue);
+}
+
+static size_t size_string(ObjHeader* object) {
+    ObjString* string = (ObjString*)object;
+    uint32_t reserved = (string->header.metadata & OBJ_APPENDABLE) ? (string->header.metadata & STRING_CAPACITY_MASK)
+                                                                   : string->length;
+    return sizeof(ObjString) + reserved + 1;
+}
+
+#define SIZE_OF(type) static size_t size_##type(ObjHeader* object) { (void)object; return sizeof(type); }
+SIZE_OF(LmBox)
+SIZE_OF(ObjI64)
+SIZE_OF(ObjU64)
+SIZE_OF(ObjI128)
+SIZE_OF(ObjU128)
+SIZE_OF(ObjFloat)
+SIZE_OF(ObjDecimal)
+SIZE_OF(LmClosure)
+#undef SIZE_OF
+
+static void destroy_box(ObjHeader* object) { lm_box_free((LmBox*)object); }
+static void destroy_list(ObjHeader* object) { lm_list_free((LmList*)object); }
+static void destroy_dict(ObjHeader* object) { lm_dict_free((LmDict*)object); }
+static void destroy_tuple(ObjHeader* object) { lm_tuple_free((LmTuple*)object); }
+static void destroy_frame(ObjHeader* object) { lm_frame_free(object); }
+
+static void destroy_string(ObjHeader* object) {
+    lm_string_unintern((ObjString*)object);
+    lm_gc_free(object);
+}
+
+static const GcTypeInfo gc_types[] = {
+    [TYPE_BOX]     = { trace_none,    size_LmBox,      destroy_box },
+    [TYPE_LIST]    = { trace_list,    size_list,       destroy_list },
+    [TYPE_DICT]    = { trace_dict,    size_dict,       destroy_dict },
+    [TYPE_TUPLE]   = { trace_tuple,   size_tuple,      destroy_tuple },
+    [TYPE_FRAME]   = { trace_frame,   size_frame,      destroy_frame },
+    [TYPE_I64]     = { trace_none,    size_ObjI64,     destroy_plain },
+    [TYPE_U64]     = { trace_none,    size_ObjU64,     destroy_plain },
+    [TYPE_I128]    = { trace_none,    size_ObjI128,    destroy_plain },
+    [TYPE_U128]    = { trace_none,    size_ObjU128,    destroy_plain },
+    [TYPE_FLOAT]   = { trace_none,    size_ObjFloat,   destroy_plain },
+    [TYPE_DECIMAL] = { trace_none,    size_ObjDecimal, destroy_plain },
+    [TYPE_STRING]  = { trace_none,    size_string,     destroy_string },
+    [TYPE_CLOSURE] = { trace_closure, size_LmClosure,  destroy_plain },
+    [TYPE_CHANNEL] = { trace_none,    NULL,            NULL },
+};
+#define GC_TYPE_COUNT (sizeof(gc_types) / sizeof(gc_types[0]))
+
+static const GcTypeInfo* type_info(const ObjHeader* object) {
+    return object->type_id < GC_TYPE_COUNT ? &gc_types[object->type_id] : NULL;
+}
+
+typedef struct {
+    LmGcRootScanner scan_roots;
+    LmGcRequestHook request;
+    void* context;
+} GcHost;
+
+// Collector state. The collector is single-threaded, like the VMs driving it.
+static struct {
+    bool enabled;
+    bool pending;
+    GcHost* hosts;     // Every host that enabled the collector and has not left
+    size_t host_count;
+    _Alignas(16) GcLink objects;  // Sentinel of the tracked object list, tagged like any link
+    ObjHeader** gray;  // Marked objects whose children are not traced yet
+    size_t gray_count;
+    size_t gray_capacity;
+    ObjHeader** untracked;  // Untracked objects marked this cycle; the sweep never sees them
+    size_t untracked_count;
+    size_t untracked_capacity;
+    uint64_t threshold;
+    LmGcStats stats;
+} heap;
+
+// Region arena. Offsets are linear across chunks, which are kept for reuse
+// once allocated.
+static struct {
+    bool allocating;
+    char** chunks;
+    size_t chunk_count;
+    uint64_t top;
+    GcLink* newest;
+} region;
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static void charge(size_t bytes) {
+    heap.stats.heap_bytes += bytes;
+    if (heap.stats.heap_bytes > heap.stats.peak_heap_bytes) heap.stats.peak_heap_bytes = heap.stats.heap_bytes;
+    if (!heap.pending && heap.stats.heap_bytes >= heap.threshold) {
+        heap.pending = true;
+        for (size_t i = 0; i < heap.host_count; i++) {
+            if (heap.hosts[i].request) heap.hosts[i].request(heap.hosts[i].context);
+        }
+    }
+}
+
+static void discharge(size_t bytes) {
+    heap.stats.heap_bytes = bytes < heap.stats.heap_bytes ? heap.stats.heap_bytes - bytes : 0;
+}
+
+static void unlink_object(GcLink* link) {
+    GcLink* prev = prev_of(link);
+    prev->next = link->next;
+    set_prev(link->next, prev);
+    set_prev(link, NULL);
+    link->next = NULL;
+}
+
+static void* region_alloc(size_t size) {
+    uint64_t total = (sizeof(GcLink) + size + 15) & ~(uint64_t)15;
+    if (total > REGION_CHUNK_SIZE) return NULL;
+    if (region.top % REGION_CHUNK_SIZE + total > REGION_CHUNK_SIZE) {
+        region.top += REGION_CHUNK_SIZE - region.top % REGION_CHUNK_SIZE;
+    }
+
+    size_t chunk = (size_t)(region.top / REGION_CHUNK_SIZE);
+    if (chunk == region.chunk_count) {
+        char** chunks = (char**)realloc(region.chunks, (chunk + 1) * sizeof(char*));
+        if (!chunks) return NULL;
+        region.chunks = chunks;
+        if (!(region.chunks[chunk] = (char*)malloc(REGION_CHUNK_SIZE))) return NULL;
+        region.chunk_count++;
+    }
+
+    GcLink* link = (GcLink*)(region.chunks[chunk] + region.top % REGION_CHUNK_SIZE);
+    link->prev = region.newest;
+    link->next = (GcLink*)(uintptr_t)((region.top << 1) | REGION_TAG);
+    region.newest = link;
+    region.top += total;
+    return OBJECT_OF(link);
+}
+
+RUNTIME_API void* lm_gc_alloc(size_t size) {
+    if (region.allocating) {
+        void* object = region_alloc(size);
+        if (object) return object;
+    }
+
+    LmSizeClass size_class = lm_size_class(sizeof(GcLink) + size);
+    GcLink* link = size_class < LM_SIZE_CLASS_COUNT ? (GcLink*)lm_alloc(size_class)
+                                                    : (GcLink*)malloc(sizeof(GcLink) + size);
+    if (!link) return NULL;
+    link->prev = (GcLink*)(uintptr_t)(size_class < LM_SIZE_CLASS_COUNT ? size_class + 1 : 0);
+    link->next = NULL;
+    if (heap.enabled) {
+        set_prev(link, &heap.objects);
+        link->next = heap.objects.next;
+        set_prev(heap.objects.next, link);
+        heap.objects.next = link;
+        charge(size);
+    }
+    return OBJECT_OF(link);
+}
+
+RUNTIME_API void lm_gc_account(size_t bytes) {
+    if (heap.enabled && !region.allocating) charge(bytes);
+}
+
+// Region blocks go back to the arena when their region is released
+RUNTIME_API void lm_gc_free(void* object) {
+    if (!object) return;
+    GcLink* link = LINK_OF(object);
+    if (is_region(link)) return;
+    if (link->next) {
+        const GcTypeInfo* info = type_info((ObjHeader*)object);
+        if (info && info->size) discharge(info->size((ObjHeader*)object));
+        unlink_object(link);
+    }
+    unsigned tag = link_class(link);
+    if (tag) lm_free(link, (LmSizeClass)(tag - 1));
+    else free(link);
+}
+
+RUNTIME_API void lm_region_allocate(bool enabled) {
+    region.allocating = enabled;
+}
+
+RUNTIME_API uint64_t lm_region_mark(void) {
+    return region.top;
+}
+
+RUNTIME_API void lm_region_release(uint64_t mark) {
+    if (mark >= region.top) return;
+    while (region.newest && region_offset(region.newest) >= mark) {
+        ObjHeader* object = OBJECT_OF(region.newest);
+        region.newest = region.newest->prev;
+        const GcTypeInfo* info = type_info(object);
+        if (info && info->destroy) info->destroy(object);
+        heap.stats.region_objects++;
+    }
+    region.top = mark;
+}
+
+// The first host starts tracking; later hosts share the heap and add their roots
+RUNTIME_API bool lm_gc_enable(LmGcRootScanner scan_roots, LmGcRequestHook request, void* context) {
+    GcHost* hosts = (GcHost*)realloc(heap.hosts, (heap.host_count + 1) * sizeof(GcHost));
+    if (!hosts) return false;
+    heap.hosts = hosts;
+    heap.hosts[heap.host_count++] = (GcHost){ scan_roots, request, context };
+    if (heap.enabled) return true;
+
+    heap.enabled = true;
+    heap.objects.prev = heap.objects.next = &heap.objects;
+    heap.threshold = GC_MIN_THRESHOLD;
+    memset(&heap.stats, 0, sizeof(heap.stats));
+    return true;
+}
+
+static void destroy_object(ObjHeader* object) {
+    // The type's free function unlinks the object itself
+    const GcTypeInfo* info = type_info(object);
+    if (info && info->destroy) info->destroy(object);
+    else lm_gc_free(object);
+}
+
+// Tracking stops when the last host leaves. With no host left there are no
+// roots, so every object still tracked is freed, as a collection would.
+RUNTIME_API void lm_gc_disable(void* context) {
+    size_t i = 0;
+    while (i < heap.host_count && heap.hosts[i].context != context) i++;
+    if (i == heap.host_count) return;
+    memmove(&heap.hosts[i], &heap.hosts[i + 1], (heap.host_count - i - 1) * sizeof(GcHost));
+    if (--heap.host_count > 0) return;
+
+    free(heap.hosts);
+    heap.hosts = NULL;
+    if (heap.enabled) {
+        while (heap.objects.next != &heap.objects) destroy_object(OBJECT_OF(heap.objects.next));
+    }
+    free(heap.gray);
+    heap.gray = NULL;
+    heap.gray_count = heap.gray_capacity = 0;
+    free(heap.untracked);
+    heap.untracked = NULL;
+    heap.untracked_count = heap.untracked_capacity = 0;
+    heap.enabled = false;
+    heap.pending = false;
+}
+
+RUNTIME_API bool lm_gc_pending(void) {
+    return heap.pending;
+}
+
+RUNTIME_API LmGcStats lm_gc_stats(void) {
+    return heap.stats;
+}
+
+static bool push_object(ObjHeader*** stack, size_t* count, size_t* capacity, ObjHeader* object) {
+    if (*count == *capacity) {
+        size_t grown = *capacity ? *capacity * 2 : 256;
+        ObjHeader** objects = (ObjHeader**)realloc(*stack, grown * sizeof(ObjHeader*));
+        if (!objects) return false;
+        *stack = objects;
+        *capacity = grown;
+    }
+    (*stack)[(*count)++] = object;
+    return true;
+}
+
+// Channels are scanned by the host. Untracked objects (literals and region
+// objects) are marked and traced like tracked ones, so each is traced once
+// per collection; lm_gc_collect clears their marks afterwards.
+RUNTIME_API void lm_gc_mark_value(LmValue value) {
+    if (!IS_PTR(value)) return;
+    ObjHeader* object = (ObjHeader*)UNBOX_PTR(value);
+    if (object->type_id == TYPE_CHANNEL) return;
+    if (object->metadata & OBJ_MARKED) return;
+    if (!is_tracked(LINK_OF(object)) &&
+        !push_object(&heap.untracked, &heap.untracked_count, &heap.untracked_capacity, object)) {
+        // A mark nothing would clear hides the object's children from the
+        // next collection, so trace it unmarked instead
+        const GcTypeInfo* info = type_info(object);
+        if (info) info->trace(object);
+        return;
+    }
+    object->metadata |= OBJ_MARKED;
+
+    if (!push_object(&heap.gray, &heap.gray_count, &heap.gray_capacity, object)) {
+        // No room to defer it, trace the object right away
+        const GcTypeInfo* info = type_info(object);
+        if (info) info->trace(object);
+    }
+}
+
+RUNTIME_API void lm_gc_mark_values(const LmValue* values, size_t count) {
+    if (!values) return;
+    for (size_t i = 0; i < count; i++) lm_gc_mark_value(values[i]);
+}
+
+static void sweep(void) {
+    uint64_t live_bytes = 0;
+    GcLink* link = heap.objects.next;
+    while (link != &heap.objects) {
+        GcLink* next = link->next;
+        ObjHeader* object = OBJECT_OF(link);
+        const GcTypeInfo* info = type_info(object);
+        size_t size = info && info->size ? info->size(object) : 0;
+        if (object->metadata & (OBJ_MARKED | OBJ_IMMUTABLE)) {
+            object->metadata &= ~OBJ_MARKED;
+            live_bytes += size;
+        } else {
+            destroy_object(object);
+            heap.stats.objects_freed++;
+            heap.stats.bytes_freed += size;
+        }
+        link = next;
+    }
+
+    heap.stats.heap_bytes = live_bytes;
+    heap.threshold = live_bytes * GC_GROWTH_FACTOR;
+    if (heap.threshold < GC_MIN_THRESHOLD) heap.threshold = GC_MIN_THRESHOLD;
+}
+
+RUNTIME_API void lm_gc_collect(void) {
+    if (!heap.enabled) return;
+    uint64_t start = now_ns();
+    heap.pending = false;
+
+    for (size_t i = 0; i < heap.host_count; i++) {
+        if (heap.hosts[i].scan_roots) heap.hosts[i].scan_roots(heap.hosts[i].context);
+    }
+    while (heap.gray_count > 0) {
+        ObjHeader* object = heap.gray[--heap.gray_count];
+        const GcTypeInfo* info = type_info(object);
+        if (info) info->trace(object);
+    }
+    sweep();
+    for (size_t i = 0; i < heap.untracked_count; i++) heap.untracked[i]->metadata &= ~OBJ_MARKED;
+    heap.untracked_count = 0;
+
+    uint64_t pause = now_ns() - start;
+    heap.stats.collections++;
+    heap.stats.total_pause_ns += pause;
+    if (pause > heap.stats.max_pause_ns) heap.stats.max_pause_ns = pause;
+}
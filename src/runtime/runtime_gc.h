@@ -0,0 +1,81 @@
+#ifndef RUNTIME_GC_H
+#define RUNTIME_GC_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "runtime_value_base.h"
+
+// For static linking, define as empty
+#ifndef RUNTIME_API
+    #define RUNTIME_API
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Mark-sweep collector for runtime heap objects.
+//
+// Every runtime constructor allocates through lm_gc_alloc. While a host has
+// the collector enabled, those objects are tracked; objects allocated before
+// that (literals built by the compiler) and host objects stored in values
+// (channels, TYPE_CHANNEL) are never freed. The host owns the roots: scan_roots
+// is called at the start of each collection and reports every live value
+// through lm_gc_mark_value. Collection never starts inside an allocation.
+// Crossing the threshold only marks a collection as pending and calls
+// request, and the host runs lm_gc_collect at a point where all of its live
+// values are reachable from its roots.
+
+// metadata bit set on reachable objects during marking
+#define OBJ_MARKED 0x40000000u
+
+typedef void (*LmGcRootScanner)(void* context);
+typedef void (*LmGcRequestHook)(void* context);
+
+typedef struct {
+    uint64_t collections;
+    uint64_t objects_freed;
+    uint64_t bytes_freed;
+    uint64_t heap_bytes;        // Tracked bytes, exact after each collection
+    uint64_t peak_heap_bytes;
+    uint64_t total_pause_ns;
+    uint64_t max_pause_ns;
+    uint64_t region_objects;    // Objects destroyed by lm_region_release
+} LmGcStats;
+
+// Allocation. lm_gc_account charges memory an object acquires after it is
+// created (list growth, dict entries, string payloads) towards the threshold.
+RUNTIME_API void* lm_gc_alloc(size_t size);
+RUNTIME_API void lm_gc_account(size_t bytes);
+RUNTIME_API void lm_gc_free(void* object);  // Release an lm_gc_alloc block, tracked or not
+
+// Region arena for objects the compiler proved dead once a scope exits.
+// While lm_region_allocate(true) is in effect, lm_gc_alloc bump-allocates
+// from the arena and the objects are never tracked. lm_region_release
+// destroys every object allocated after mark, newest first, and rewinds
+// the arena to it.
+RUNTIME_API void lm_region_allocate(bool enabled);
+RUNTIME_API uint64_t lm_region_mark(void);
+RUNTIME_API void lm_region_release(uint64_t mark);
+
+// Host interface
+// Several hosts may enable the collector at once: each one's roots are
+// scanned and each is asked to collect. lm_gc_disable removes the host
+// registered with context, and the last one to leave turns tracking off and
+// frees every object still tracked.
+RUNTIME_API bool lm_gc_enable(LmGcRootScanner scan_roots, LmGcRequestHook request, void* context);
+RUNTIME_API void lm_gc_disable(void* context);
+RUNTIME_API bool lm_gc_pending(void);
+RUNTIME_API void lm_gc_collect(void);
+RUNTIME_API LmGcStats lm_gc_stats(void);
+
+// Root marking, for use from scan_roots
+RUNTIME_API void lm_gc_mark_value(LmValue value);
+RUNTIME_API void lm_gc_mark_values(const LmValue* values, size_t count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // RUNTIME_GC_H
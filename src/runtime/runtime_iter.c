@@ -0,0 +1,89 @@
+#define BUILDING_RUNTIME
+#include "runtime_iter.h"
+#include "runtime_dict.h"
+#include "runtime_list.h"
+#include "runtime_tuple.h"
+
+// Cursors stay within the SMI range: 40 bits of position below 20 bits of
+// dict version. The cursor before the first item has position zero.
+#define POSITION_BITS 40
+#define POSITION_MASK ((1ULL << POSITION_BITS) - 1)
+#define VERSION_MASK  ((1ULL << 20) - 1)
+
+static inline LmValue make_cursor(uint64_t position, uint64_t version) {
+    return BOX_INT((int64_t)(((version & VERSION_MASK) << POSITION_BITS) | position));
+}
+
+static inline uint64_t cursor_position(LmValue cursor) {
+    return (uint64_t)UNBOX_INT(cursor) & POSITION_MASK;
+}
+
+static inline uint64_t cursor_version(LmValue cursor) {
+    return (uint64_t)UNBOX_INT(cursor) >> POSITION_BITS;
+}
+
+static inline ObjHeader* object_of(LmValue value) {
+    return IS_PTR(value) ? (ObjHeader*)UNBOX_PTR(value) : NULL;
+}
+
+RUNTIME_API LmValue lm_iter_begin(LmValue iterable) {
+    ObjHeader* object = object_of(iterable);
+    uint64_t version = object && object->type_id == TYPE_DICT ? ((LmDict*)object)->version : 0;
+    return make_cursor(0, version);
+}
+
+RUNTIME_API LmIterStep lm_iter_next(LmValue iterable, LmValue* cursor) {
+    ObjHeader* object = object_of(iterable);
+    if (!object || !IS_INT(*cursor)) return LM_ITER_END;
+
+    uint64_t position = cursor_position(*cursor);
+    switch (object->type_id) {
+        case TYPE_LIST:
+            if (position >= ((LmList*)object)->size) return LM_ITER_END;
+            *cursor = make_cursor(position + 1, 0);
+            return LM_ITER_ITEM;
+        case TYPE_TUPLE:
+            if (position >= ((LmTuple*)object)->size) return LM_ITER_END;
+            *cursor = make_cursor(position + 1, 0);
+            return LM_ITER_ITEM;
+        case TYPE_DICT: {
+            LmDict* dict = (LmDict*)object;
+            if (cursor_version(*cursor) != (dict->version & VERSION_MASK)) return LM_ITER_MODIFIED;
+            LmDictIter iter = { position, dict->version };
+            LmIterStep step = lm_dict_iter_next(dict, &iter, NULL, NULL);
+            if (step == LM_ITER_ITEM) *cursor = make_cursor(iter.index, dict->version);
+            return step;
+        }
+        default:
+            return LM_ITER_END;
+    }
+}
+
+static LmValue current(LmValue iterable, LmValue cursor, bool dict_value) {
+    ObjHeader* object = object_of(iterable);
+    if (!object || !IS_INT(cursor)) return VAL_NIL;
+
+    uint64_t position = cursor_position(cursor);
+    if (position == 0) return VAL_NIL;
+    switch (object->type_id) {
+        case TYPE_LIST:
+            return lm_list_get((LmList*)object, position - 1);
+        case TYPE_TUPLE:
+            return lm_tuple_get((LmTuple*)object, position - 1);
+        case TYPE_DICT: {
+            LmDict* dict = (LmDict*)object;
+            if (position > dict->capacity || !LM_DICT_SLOT_USED(dict, position - 1)) return VAL_NIL;
+            return dict_value ? dict->slots[position - 1].value : dict->slots[position - 1].key;
+        }
+        default:
+            return VAL_NIL;
+    }
+}
+
+RUNTIME_API LmValue lm_iter_key(LmValue iterable, LmValue cursor) {
+    return current(iterable, cursor, false);
+}
+
+RUNTIME_API LmValue lm_iter_value(LmValue iterable, LmValue cursor) {
+    return current(iterable, cursor, true);
+}
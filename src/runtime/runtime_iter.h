@@ -0,0 +1,40 @@
+#ifndef RUNTIME_ITER_H
+#define RUNTIME_ITER_H
+
+#include <stdint.h>
+#include "runtime_value_base.h"
+
+// For static linking, define as empty
+#ifndef RUNTIME_API
+    #define RUNTIME_API
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+    LM_ITER_END,
+    LM_ITER_ITEM,
+    LM_ITER_MODIFIED          // A dict gained or lost entries since iteration began
+} LmIterStep;
+
+// Iteration over lists, tuples and dicts in place, driven by a cursor the
+// caller keeps in an ordinary value. A cursor is a non-zero integer that
+// packs the position after the current item and, for dicts, the low bits
+// of the dict's version when iteration began. Lists and tuples are read
+// at their current size on every step, so appending during iteration is
+// seen by the loop. Any other value iterates as empty.
+RUNTIME_API LmValue lm_iter_begin(LmValue iterable);
+RUNTIME_API LmIterStep lm_iter_next(LmValue iterable, LmValue* cursor);
+
+// The current element of a list or tuple, or key of a dict
+RUNTIME_API LmValue lm_iter_key(LmValue iterable, LmValue cursor);
+// The current value of a dict, or element of a list or tuple
+RUNTIME_API LmValue lm_iter_value(LmValue iterable, LmValue cursor);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // RUNTIME_ITER_H
@@ -0,0 +1,815 @@
+#define BUILDING_RUNTIME
+#include "runtime_kernels.h"
+#include "runtime_value.h"
+#include <string.h>
+
+// x86 builds always have SSE2 kernels. AVX2 kernels are compiled alongside
+// them for GCC and Clang and chosen per call, since the runtime itself is
+// built for the baseline instruction set. Other targets use scalar loops.
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define LM_SIMD_SSE2 1
+#if defined(__GNUC__) || defined(__clang__)
+#include <immintrin.h>
+#define LM_SIMD_AVX2 1
+#define AVX2_TARGET __attribute__((target("avx2")))
+#endif
+#endif
+
+#ifdef LM_SIMD_AVX2
+#define DISPATCH(kernel, ...) (__builtin_cpu_supports("avx2") ? kernel##_avx2(__VA_ARGS__) : kernel##_base(__VA_ARGS__))
+#else
+#define DISPATCH(kernel, ...) kernel##_base(__VA_ARGS__)
+#endif
+
+// =============================================================================
+// Raw kernels. Each has a _base version (SSE2 where available, otherwise
+// scalar) and, on x86, an _avx2 version.
+// =============================================================================
+
+// --- Sums --------------------------------------------------------------------
+
+static double sum_f64_base(const double* x, uint64_t n) {
+    uint64_t i = 0;
+    double sum = 0.0;
+#ifdef LM_SIMD_SSE2
+    __m128d acc0 = _mm_setzero_pd(), acc1 = _mm_setzero_pd();
+    for (; i + 4 <= n; i += 4) {
+        acc0 = _mm_add_pd(acc0, _mm_loadu_pd(x + i));
+        acc1 = _mm_add_pd(acc1, _mm_loadu_pd(x + i + 2));
+    }
+    double lanes[2];
+    _mm_storeu_pd(lanes, _mm_add_pd(acc0, acc1));
+    sum = lanes[0] + lanes[1];
+#endif
+    for (; i < n; i++) sum += x[i];
+    return sum;
+}
+
+// An int64 is high * 2^32 + low - sign * 2^64, with high and low its 32-bit
+// halves read as unsigned. Summing the three parts in 64-bit lanes cannot
+// overflow within a block of 2^31 elements, and they recombine exactly.
+#define SUM_BLOCK ((uint64_t)1 << 31)
+
+static __int128 combine_parts(const uint64_t* high, const uint64_t* low, const uint64_t* sign, int lanes) {
+    __int128 total = 0;
+    for (int k = 0; k < lanes; k++) {
+        total += ((__int128)high[k] << 32) + (__int128)low[k] - ((__int128)sign[k] << 64);
+    }
+    return total;
+}
+
+static __int128 sum_i64_base(const int64_t* x, uint64_t n) {
+    __int128 total = 0;
+    uint64_t i = 0;
+#ifdef LM_SIMD_SSE2
+    const __m128i low_mask = _mm_set1_epi64x(0xFFFFFFFF);
+    while (i + 2 <= n) {
+        uint64_t end = n - i > SUM_BLOCK ? i + SUM_BLOCK : n;
+        __m128i high = _mm_setzero_si128(), low = _mm_setzero_si128(), sign = _mm_setzero_si128();
+        for (; i + 2 <= end; i += 2) {
+            __m128i v = _mm_loadu_si128((const __m128i*)(x + i));
+            high = _mm_add_epi64(high, _mm_srli_epi64(v, 32));
+            low = _mm_add_epi64(low, _mm_and_si128(v, low_mask));
+            sign = _mm_add_epi64(sign, _mm_srli_epi64(v, 63));
+        }
+        uint64_t h[2], l[2], s[2];
+        _mm_storeu_si128((__m128i*)h, high);
+        _mm_storeu_si128((__m128i*)l, low);
+        _mm_storeu_si128((__m128i*)s, sign);
+        total += combine_parts(h, l, s, 2);
+    }
+#endif
+    for (; i < n; i++) total += x[i];
+    return total;
+}
+
+static double dot_f64_base(const double* a, const double* b, uint64_t n) {
+    uint64_t i = 0;
+    double sum = 0.0;
+#ifdef LM_SIMD_SSE2
+    __m128d acc0 = _mm_setzero_pd(), acc1 = _mm_setzero_pd();
+    for (; i + 4 <= n; i += 4) {
+        acc0 = _mm_add_pd(acc0, _mm_mul_pd(_mm_loadu_pd(a + i), _mm_loadu_pd(b + i)));
+        acc1 = _mm_add_pd(acc1, _mm_mul_pd(_mm_loadu_pd(a + i + 2), _mm_loadu_pd(b + i + 2)));
+    }
+    double lanes[2];
+    _mm_storeu_pd(lanes, _mm_add_pd(acc0, acc1));
+    sum = lanes[0] + lanes[1];
+#endif
+    for (; i < n; i++) sum += a[i] * b[i];
+    return sum;
+}
+
+// --- Minimum and maximum -------------------------------------------------------
+// The list is never empty. New values are the first operand of min/max, so a
+// NaN element is skipped the way `if (x < best)` skips it.
+
+static double extreme_f64_base(const double* x, uint64_t n, bool is_max) {
+    uint64_t i = 1;
+    double best = x[0];
+#ifdef LM_SIMD_SSE2
+    if (n >= 4) {
+        __m128d acc0 = _mm_loadu_pd(x), acc1 = _mm_loadu_pd(x + 2);
+        for (i = 4; i + 4 <= n; i += 4) {
+            __m128d v0 = _mm_loadu_pd(x + i), v1 = _mm_loadu_pd(x + i + 2);
+            acc0 = is_max ? _mm_max_pd(v0, acc0) : _mm_min_pd(v0, acc0);
+            acc1 = is_max ? _mm_max_pd(v1, acc1) : _mm_min_pd(v1, acc1);
+        }
+        double lanes[4];
+        _mm_storeu_pd(lanes, acc0);
+        _mm_storeu_pd(lanes + 2, acc1);
+        best = lanes[0];
+        for (int k = 1; k < 4; k++) {
+            if (is_max ? lanes[k] > best : lanes[k] < best) best = lanes[k];
+        }
+    }
+#endif
+    for (; i < n; i++) {
+        if (is_max ? x[i] > best : x[i] < best) best = x[i];
+    }
+    return best;
+}
+
+// SSE2 has no 64-bit integer compare
+static int64_t extreme_i64_base(const int64_t* x, uint64_t n, bool is_max) {
+    int64_t best = x[0];
+    for (uint64_t i = 1; i < n; i++) {
+        if (is_max ? x[i] > best : x[i] < best) best = x[i];
+    }
+    return best;
+}
+
+// --- Search ------------------------------------------------------------------
+
+static int64_t index_of_i64_base(const int64_t* x, uint64_t n, int64_t target) {
+    uint64_t i = 0;
+#ifdef LM_SIMD_SSE2
+    // A 64-bit lane matches when both of its 32-bit halves do
+    __m128i needle = _mm_set1_epi64x(target);
+    for (; i + 2 <= n; i += 2) {
+        __m128i eq = _mm_cmpeq_epi32(_mm_loadu_si128((const __m128i*)(x + i)), needle);
+        eq = _mm_and_si128(eq, _mm_shuffle_epi32(eq, _MM_SHUFFLE(2, 3, 0, 1)));
+        int mask = _mm_movemask_pd(_mm_castsi128_pd(eq));
+        if (mask) return (int64_t)(i + __builtin_ctz(mask));
+    }
+#endif
+    for (; i < n; i++) {
+        if (x[i] == target) return (int64_t)i;
+    }
+    return -1;
+}
+
+static int64_t index_of_f64_base(const double* x, uint64_t n, double target) {
+    uint64_t i = 0;
+#ifdef LM_SIMD_SSE2
+    __m128d needle = _mm_set1_pd(target);
+    for (; i + 2 <= n; i += 2) {
+        int mask = _mm_movemask_pd(_mm_cmpeq_pd(_mm_loadu_pd(x + i), needle));
+        if (mask) return (int64_t)(i + __builtin_ctz(mask));
+    }
+#endif
+    for (; i < n; i++) {
+        if (x[i] == target) return (int64_t)i;
+    }
+    return -1;
+}
+
+static int64_t index_of_u8_base(const uint8_t* x, uint64_t n, uint8_t target) {
+    uint64_t i = 0;
+#ifdef LM_SIMD_SSE2
+    __m128i needle = _mm_set1_epi8((char)target);
+    for (; i + 16 <= n; i += 16) {
+        int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(x + i)), needle));
+        if (mask) return (int64_t)(i + __builtin_ctz(mask));
+    }
+#endif
+    for (; i < n; i++) {
+        if (x[i] == target) return (int64_t)i;
+    }
+    return -1;
+}
+
+static int64_t count_i64_base(const int64_t* x, uint64_t n, int64_t target) {
+    uint64_t i = 0;
+    int64_t count = 0;
+#ifdef LM_SIMD_SSE2
+    __m128i needle = _mm_set1_epi64x(target);
+    for (; i + 2 <= n; i += 2) {
+        __m128i eq = _mm_cmpeq_epi32(_mm_loadu_si128((const __m128i*)(x + i)), needle);
+        eq = _mm_and_si128(eq, _mm_shuffle_epi32(eq, _MM_SHUFFLE(2, 3, 0, 1)));
+        count += __builtin_popcount(_mm_movemask_pd(_mm_castsi128_pd(eq)));
+    }
+#endif
+    for (; i < n; i++) count += x[i] == target;
+    return count;
+}
+
+static int64_t count_f64_base(const double* x, uint64_t n, double target) {
+    uint64_t i = 0;
+    int64_t count = 0;
+#ifdef LM_SIMD_SSE2
+    __m128d needle = _mm_set1_pd(target);
+    for (; i + 2 <= n; i += 2) {
+        count += __builtin_popcount(_mm_movemask_pd(_mm_cmpeq_pd(_mm_loadu_pd(x + i), needle)));
+    }
+#endif
+    for (; i < n; i++) count += x[i] == target;
+    return count;
+}
+
+static int64_t count_u8_base(const uint8_t* x, uint64_t n, uint8_t target) {
+    uint64_t i = 0;
+    int64_t count = 0;
+#ifdef LM_SIMD_SSE2
+    __m128i needle = _mm_set1_epi8((char)target);
+    for (; i + 16 <= n; i += 16) {
+        count += __builtin_popcount(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(x + i)), needle)));
+    }
+#endif
+    for (; i < n; i++) count += x[i] == target;
+    return count;
+}
+
+// --- Elementwise ---------------------------------------------------------------
+
+static void add_f64_base(double* out, const double* a, const double* b, uint64_t n) {
+    uint64_t i = 0;
+#ifdef LM_SIMD_SSE2
+    for (; i + 2 <= n; i += 2) _mm_storeu_pd(out + i, _mm_add_pd(_mm_loadu_pd(a + i), _mm_loadu_pd(b + i)));
+#endif
+    for (; i < n; i++) out[i] = a[i] + b[i];
+}
+
+static void mul_f64_base(double* out, const double* a, const double* b, uint64_t n) {
+    uint64_t i = 0;
+#ifdef LM_SIMD_SSE2
+    for (; i + 2 <= n; i += 2) _mm_storeu_pd(out + i, _mm_mul_pd(_mm_loadu_pd(a + i), _mm_loadu_pd(b + i)));
+#endif
+    for (; i < n; i++) out[i] = a[i] * b[i];
+}
+
+static void scale_f64_base(double* out, const double* x, double factor, uint64_t n) {
+    uint64_t i = 0;
+#ifdef LM_SIMD_SSE2
+    __m128d f = _mm_set1_pd(factor);
+    for (; i + 2 <= n; i += 2) _mm_storeu_pd(out + i, _mm_mul_pd(_mm_loadu_pd(x + i), f));
+#endif
+    for (; i < n; i++) out[i] = x[i] * factor;
+}
+
+// Returns false if any sum overflowed. A lane overflowed when its result
+// differs in sign from both operands.
+static bool add_i64_base(int64_t* out, const int64_t* a, const int64_t* b, uint64_t n) {
+    uint64_t i = 0;
+    bool overflow = false;
+#ifdef LM_SIMD_SSE2
+    __m128i flags = _mm_setzero_si128();
+    for (; i + 2 <= n; i += 2) {
+        __m128i va = _mm_loadu_si128((const __m128i*)(a + i));
+        __m128i vb = _mm_loadu_si128((const __m128i*)(b + i));
+        __m128i r = _mm_add_epi64(va, vb);
+        flags = _mm_or_si128(flags, _mm_and_si128(_mm_xor_si128(va, r), _mm_xor_si128(vb, r)));
+        _mm_storeu_si128((__m128i*)(out + i), r);
+    }
+    overflow = _mm_movemask_pd(_mm_castsi128_pd(flags)) != 0;
+#endif
+    for (; i < n; i++) overflow |= __builtin_add_overflow(a[i], b[i], &out[i]);
+    return !overflow;
+}
+
+// Neither SSE2 nor AVX2 has a 64-bit multiply, so these stay scalar
+static bool mul_i64(int64_t* out, const int64_t* a, const int64_t* b, uint64_t n) {
+    bool overflow = false;
+    for (uint64_t i = 0; i < n; i++) overflow |= __builtin_mul_overflow(a[i], b[i], &out[i]);
+    return !overflow;
+}
+
+static bool scale_i64(int64_t* out, const int64_t* x, int64_t factor, uint64_t n) {
+    bool overflow = false;
+    for (uint64_t i = 0; i < n; i++) overflow |= __builtin_mul_overflow(x[i], factor, &out[i]);
+    return !overflow;
+}
+
+static bool dot_i64(const int64_t* a, const int64_t* b, uint64_t n, __int128* out) {
+    __int128 sum = 0;
+    for (uint64_t i = 0; i < n; i++) {
+        if (__builtin_add_overflow(sum, (__int128)a[i] * b[i], &sum)) return false;
+    }
+    *out = sum;
+    return true;
+}
+
+// Each prefix depends on the previous one, so the scans are scalar loops
+// over the unboxed storage
+static bool prefix_sum_i64(int64_t* out, const int64_t* x, uint64_t n) {
+    int64_t sum = 0;
+    for (uint64_t i = 0; i < n; i++) {
+        if (__builtin_add_overflow(sum, x[i], &sum)) return false;
+        out[i] = sum;
+    }
+    return true;
+}
+
+static void prefix_sum_f64(double* out, const double* x, uint64_t n) {
+    double sum = 0.0;
+    for (uint64_t i = 0; i < n; i++) {
+        sum += x[i];
+        out[i] = sum;
+    }
+}
+
+// --- AVX2 --------------------------------------------------------------------
+
+#ifdef LM_SIMD_AVX2
+
+AVX2_TARGET static double sum_f64_avx2(const double* x, uint64_t n) {
+    uint64_t i = 0;
+    __m256d acc0 = _mm256_setzero_pd(), acc1 = _mm256_setzero_pd();
+    for (; i + 8 <= n; i += 8) {
+        acc0 = _mm256_add_pd(acc0, _mm256_loadu_pd(x + i));
+        acc1 = _mm256_add_pd(acc1, _mm256_loadu_pd(x + i + 4));
+    }
+    double lanes[4];
+    _mm256_storeu_pd(lanes, _mm256_add_pd(acc0, acc1));
+    double sum = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+    for (; i < n; i++) sum += x[i];
+    return sum;
+}
+
+AVX2_TARGET static __int128 sum_i64_avx2(const int64_t* x, uint64_t n) {
+    __int128 total = 0;
+    uint64_t i = 0;
+    const __m256i low_mask = _mm256_set1_epi64x(0xFFFFFFFF);
+    while (i + 4 <= n) {
+        uint64_t end = n - i > SUM_BLOCK ? i + SUM_BLOCK : n;
+        __m256i high = _mm256_setzero_si256(), low = _mm256_setzero_si256(), sign = _mm256_setzero_si256();
+        for (; i + 4 <= end; i += 4) {
+            __m256i v = _mm256_loadu_si256((const __m256i*)(x + i));
+            high = _mm256_add_epi64(high, _mm256_srli_epi64(v, 32));
+            low = _mm256_add_epi64(low, _mm256_and_si256(v, low_mask));
+            sign = _mm256_add_epi64(sign, _mm256_srli_epi64(v, 63));
+        }
+        uint64_t h[4], l[4], s[4];
+        _mm256_storeu_si256((__m256i*)h, high);
+        _mm256_storeu_si256((__m256i*)l, low);
+        _mm256_storeu_si256((__m256i*)s, sign);
+        total += combine_parts(h, l, s, 4);
+    }
+    for (; i < n; i++) total += x[i];
+    return total;
+}
+
+AVX2_TARGET static double dot_f64_avx2(const double* a, const double* b, uint64_t n) {
+    uint64_t i = 0;
+    __m256d acc0 = _mm256_setzero_pd(), acc1 = _mm256_setzero_pd();
+    for (; i + 8 <= n; i += 8) {
+        acc0 = _mm256_add_pd(acc0, _mm256_mul_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i)));
+        acc1 = _mm256_add_pd(acc1, _mm256_mul_pd(_mm256_loadu_pd(a + i + 4), _mm256_loadu_pd(b + i + 4)));
+    }
+    double lanes[4];
+    _mm256_storeu_pd(lanes, _mm256_add_pd(acc0, acc1));
+    double sum = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+    for (; i < n; i++) sum += a[i] * b[i];
+    return sum;
+}
+
+AVX2_TARGET static double extreme_f64_avx2(const double* x, uint64_t n, bool is_max) {
+    uint64_t i = 1;
+    double best = x[0];
+    if (n >= 4) {
+        __m256d acc = _mm256_loadu_pd(x);
+        for (i = 4; i + 4 <= n; i += 4) {
+            __m256d v = _mm256_loadu_pd(x + i);
+            acc = is_max ? _mm256_max_pd(v, acc) : _mm256_min_pd(v, acc);
+        }
+        double lanes[4];
+        _mm256_storeu_pd(lanes, acc);
+        best = lanes[0];
+        for (int k = 1; k < 4; k++) {
+            if (is_max ? lanes[k] > best : lanes[k] < best) best = lanes[k];
+        }
+    }
+    for (; i < n; i++) {
+        if (is_max ? x[i] > best : x[i] < best) best = x[i];
+    }
+    return best;
+}
+
+AVX2_TARGET static int64_t extreme_i64_avx2(const int64_t* x, uint64_t n, bool is_max) {
+    uint64_t i = 1;
+    int64_t best = x[0];
+    if (n >= 4) {
+        __m256i acc = _mm256_loadu_si256((const __m256i*)x);
+        for (i = 4; i + 4 <= n; i += 4) {
+            __m256i v = _mm256_loadu_si256((const __m256i*)(x + i));
+            __m256i take = is_max ? _mm256_cmpgt_epi64(v, acc) : _mm256_cmpgt_epi64(acc, v);
+            acc = _mm256_blendv_epi8(acc, v, take);
+        }
+        int64_t lanes[4];
+        _mm256_storeu_si256((__m256i*)lanes, acc);
+        best = lanes[0];
+        for (int k = 1; k < 4; k++) {
+            if (is_max ? lanes[k] > best : lanes[k] < best) best = lanes[k];
+        }
+    }
+    for (; i < n; i++) {
+        if (is_max ? x[i] > best : x[i] < best) best = x[i];
+    }
+    return best;
+}
+
+AVX2_TARGET static int64_t index_of_i64_avx2(const int64_t* x, uint64_t n, int64_t target) {
+    uint64_t i = 0;
+    __m256i needle = _mm256_set1_epi64x(target);
+    for (; i + 4 <= n; i += 4) {
+        __m256i eq = _mm256_cmpeq_epi64(_mm256_loadu_si256((const __m256i*)(x + i)), needle);
+        int mask = _mm256_movemask_pd(_mm256_castsi256_pd(eq));
+        if (mask) return (int64_t)(i + __builtin_ctz(mask));
+    }
+    for (; i < n; i++) {
+        if (x[i] == target) return (int64_t)i;
+    }
+    return -1;
+}
+
+AVX2_TARGET static int64_t index_of_f64_avx2(const double* x, uint64_t n, double target) {
+    uint64_t i = 0;
+    __m256d needle = _mm256_set1_pd(target);
+    for (; i + 4 <= n; i += 4) {
+        int mask = _mm256_movemask_pd(_mm256_cmp_pd(_mm256_loadu_pd(x + i), needle, _CMP_EQ_OQ));
+        if (mask) return (int64_t)(i + __builtin_ctz(mask));
+    }
+    for (; i < n; i++) {
+        if (x[i] == target) return (int64_t)i;
+    }
+    return -1;
+}
+
+AVX2_TARGET static int64_t index_of_u8_avx2(const uint8_t* x, uint64_t n, uint8_t target) {
+    uint64_t i = 0;
+    __m256i needle = _mm256_set1_epi8((char)target);
+    for (; i + 32 <= n; i += 32) {
+        unsigned mask = (unsigned)_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*)(x + i)), needle));
+        if (mask) return (int64_t)(i + __builtin_ctz(mask));
+    }
+    for (; i < n; i++) {
+        if (x[i] == target) return (int64_t)i;
+    }
+    return -1;
+}
+
+AVX2_TARGET static int64_t count_i64_avx2(const int64_t* x, uint64_t n, int64_t target) {
+    uint64_t i = 0;
+    int64_t count = 0;
+    __m256i needle = _mm256_set1_epi64x(target);
+    for (; i + 4 <= n; i += 4) {
+        __m256i eq = _mm256_cmpeq_epi64(_mm256_loadu_si256((const __m256i*)(x + i)), needle);
+        count += __builtin_popcount(_mm256_movemask_pd(_mm256_castsi256_pd(eq)));
+    }
+    for (; i < n; i++) count += x[i] == target;
+    return count;
+}
+
+AVX2_TARGET static int64_t count_f64_avx2(const double* x, uint64_t n, double target) {
+    uint64_t i = 0;
+    int64_t count = 0;
+    __m256d needle = _mm256_set1_pd(target);
+    for (; i + 4 <= n; i += 4) {
+        count += __builtin_popcount(_mm256_movemask_pd(_mm256_cmp_pd(_mm256_loadu_pd(x + i), needle, _CMP_EQ_OQ)));
+    }
+    for (; i < n; i++) count += x[i] == target;
+    return count;
+}
+
+AVX2_TARGET static int64_t count_u8_avx2(const uint8_t* x, uint64_t n, uint8_t target) {
+    uint64_t i = 0;
+    int64_t count = 0;
+    __m256i needle = _mm256_set1_epi8((char)target);
+    for (; i + 32 <= n; i += 32) {
+        count += __builtin_popcount((unsigned)_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*)(x + i)), needle)));
+    }
+    for (; i < n; i++) count += x[i] == target;
+    return count;
+}
+
+AVX2_TARGET static void add_f64_avx2(double* out, const double* a, const double* b, uint64_t n) {
+    uint64_t i = 0;
+    for (; i + 4 <= n; i += 4) _mm256_storeu_pd(out + i, _mm256_add_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i)));
+    for (; i < n; i++) out[i] = a[i] + b[i];
+}
+
+AVX2_TARGET static void mul_f64_avx2(double* out, const double* a, const double* b, uint64_t n) {
+    uint64_t i = 0;
+    for (; i + 4 <= n; i += 4) _mm256_storeu_pd(out + i, _mm256_mul_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i)));
+    for (; i < n; i++) out[i] = a[i] * b[i];
+}
+
+AVX2_TARGET static void scale_f64_avx2(double* out, const double* x, double factor, uint64_t n) {
+    uint64_t i = 0;
+    __m256d f = _mm256_set1_pd(factor);
+    for (; i + 4 <= n; i += 4) _mm256_storeu_pd(out + i, _mm256_mul_pd(_mm256_loadu_pd(x + i), f));
+    for (; i < n; i++) out[i] = x[i] * factor;
+}
+
+AVX2_TARGET static bool add_i64_avx2(int64_t* out, const int64_t* a, const int64_t* b, uint64_t n) {
+    uint64_t i = 0;
+    __m256i flags = _mm256_setzero_si256();
+    for (; i + 4 <= n; i += 4) {
+        __m256i va = _mm256_loadu_si256((const __m256i*)(a + i));
+        __m256i vb = _mm256_loadu_si256((const __m256i*)(b + i));
+        __m256i r = _mm256_add_epi64(va, vb);
+        flags = _mm256_or_si256(flags, _mm256_and_si256(_mm256_xor_si256(va, r), _mm256_xor_si256(vb, r)));
+        _mm256_storeu_si256((__m256i*)(out + i), r);
+    }
+    bool overflow = _mm256_movemask_pd(_mm256_castsi256_pd(flags)) != 0;
+    for (; i < n; i++) overflow |= __builtin_add_overflow(a[i], b[i], &out[i]);
+    return !overflow;
+}
+
+#endif // LM_SIMD_AVX2
+
+// =============================================================================
+// List entry points
+// =============================================================================
+
+// An integer value that fits the storage of an int list
+static bool exact_i64(LmValue value, int64_t* out) {
+    if (!is_integer(value)) return false;
+    __int128 wide = as_i128(value);
+    if (wide < INT64_MIN || wide > INT64_MAX) return false;
+    *out = (int64_t)wide;
+    return true;
+}
+
+RUNTIME_API LmValue lm_list_sum(LmList* list) {
+    if (!list) return VAL_NIL;
+    if (list->kind == LM_LIST_I64) return make_i128(DISPATCH(sum_i64, list->ints, list->size));
+    if (list->kind == LM_LIST_F64) return make_float(DISPATCH(sum_f64, list->floats, list->size));
+
+    LmValue sum = BOX_INT(0);
+    for (uint64_t i = 0; i < list->size; i++) sum = lm_add_inline(sum, lm_list_get(list, i));
+    return sum;
+}
+
+static LmValue extreme(LmList* list, bool is_max) {
+    if (!list || list->size == 0) return VAL_NIL;
+    if (list->kind == LM_LIST_I64) return make_i64(DISPATCH(extreme_i64, list->ints, list->size, is_max));
+    if (list->kind == LM_LIST_F64) return make_float(DISPATCH(extreme_f64, list->floats, list->size, is_max));
+
+    LmValue best = lm_list_get(list, 0);
+    for (uint64_t i = 1; i < list->size; i++) {
+        LmValue value = lm_list_get(list, i);
+        int order = numeric_compare(value, best);
+        if (is_max ? order > 0 : order < 0) best = value;
+    }
+    return best;
+}
+
+RUNTIME_API LmValue lm_list_min(LmList* list) {
+    return extreme(list, false);
+}
+
+RUNTIME_API LmValue lm_list_max(LmList* list) {
+    return extreme(list, true);
+}
+
+RUNTIME_API LmValue lm_list_mean(LmList* list) {
+    if (!list || list->size == 0) return VAL_NIL;
+    LmValue sum = lm_list_sum(list);
+    return is_numeric(sum) ? make_float(as_float(sum) / (double)list->size) : VAL_NIL;
+}
+
+RUNTIME_API LmValue lm_list_dot(LmList* a, LmList* b) {
+    if (!a || !b || a->size != b->size) return VAL_NIL;
+    if (a->kind == LM_LIST_F64 && b->kind == LM_LIST_F64) {
+        return make_float(DISPATCH(dot_f64, a->floats, b->floats, a->size));
+    }
+    if (a->kind == LM_LIST_I64 && b->kind == LM_LIST_I64) {
+        __int128 sum;
+        return dot_i64(a->ints, b->ints, a->size, &sum) ? make_i128(sum) : VAL_NIL;
+    }
+
+    LmValue sum = BOX_INT(0);
+    for (uint64_t i = 0; i < a->size; i++) {
+        sum = lm_add_inline(sum, lm_mul_inline(lm_list_get(a, i), lm_list_get(b, i)));
+    }
+    return sum;
+}
+
+// Typed lists answer from their storage when the value can be compared
+// there. An int list can only hold a float-equal value through
+// lm_value_eq's conversion, so float needles take the generic path.
+RUNTIME_API int64_t lm_list_index_of(LmList* list, LmValue value) {
+    if (!list) return -1;
+    int64_t target;
+    switch (list->kind) {
+        case LM_LIST_I64:
+            if (exact_i64(value, &target)) return DISPATCH(index_of_i64, list->ints, list->size, target);
+            if (!is_float(value)) return -1;
+            break;
+        case LM_LIST_F64:
+            if (!is_numeric(value)) return -1;
+            return DISPATCH(index_of_f64, list->floats, list->size, as_float(value));
+        case LM_LIST_BOOL:
+            if (!IS_BOOL(value)) return -1;
+            return DISPATCH(index_of_u8, list->bools, list->size, value == VAL_TRUE);
+        default:
+            break;
+    }
+
+    for (uint64_t i = 0; i < list->size; i++) {
+        if (lm_value_eq(lm_list_get(list, i), value)) return (int64_t)i;
+    }
+    return -1;
+}
+
+RUNTIME_API bool lm_list_contains(LmList* list, LmValue value) {
+    return lm_list_index_of(list, value) >= 0;
+}
+
+RUNTIME_API int64_t lm_list_count(LmList* list, LmValue value) {
+    if (!list) return 0;
+    int64_t target;
+    switch (list->kind) {
+        case LM_LIST_I64:
+            if (exact_i64(value, &target)) return DISPATCH(count_i64, list->ints, list->size, target);
+            if (!is_float(value)) return 0;
+            break;
+        case LM_LIST_F64:
+            if (!is_numeric(value)) return 0;
+            return DISPATCH(count_f64, list->floats, list->size, as_float(value));
+        case LM_LIST_BOOL:
+            if (!IS_BOOL(value)) return 0;
+            return DISPATCH(count_u8, list->bools, list->size, value == VAL_TRUE);
+        default:
+            break;
+    }
+
+    int64_t count = 0;
+    for (uint64_t i = 0; i < list->size; i++) count += lm_value_eq(lm_list_get(list, i), value) != 0;
+    return count;
+}
+
+// Int results that overflow 64 bits are recomputed through the generic path,
+// which promotes them
+static LmValue elementwise(LmList* a, LmList* b, bool multiply) {
+    if (!a || !b || a->size != b->size) return VAL_NIL;
+    uint64_t n = a->size;
+    if (a->kind == LM_LIST_F64 && b->kind == LM_LIST_F64) {
+        LmList* out = lm_list_new_sized(LM_LIST_F64, n);
+        if (!out) return VAL_NIL;
+        if (multiply) DISPATCH(mul_f64, out->floats, a->floats, b->floats, n);
+        else DISPATCH(add_f64, out->floats, a->floats, b->floats, n);
+        return BOX_PTR(out);
+    }
+    if (a->kind == LM_LIST_I64 && b->kind == LM_LIST_I64) {
+        LmList* out = lm_list_new_sized(LM_LIST_I64, n);
+        if (!out) return VAL_NIL;
+        bool exact = multiply ? mul_i64(out->ints, a->ints, b->ints, n)
+                              : DISPATCH(add_i64, out->ints, a->ints, b->ints, n);
+        if (exact) return BOX_PTR(out);
+        lm_list_free(out);
+    }
+
+    LmList* out = lm_list_new();
+    if (!out) return VAL_NIL;
+    for (uint64_t i = 0; i < n; i++) {
+        LmValue x = lm_list_get(a, i), y = lm_list_get(b, i);
+        lm_list_append(out, multiply ? lm_mul_inline(x, y) : lm_add_inline(x, y));
+    }
+    return BOX_PTR(out);
+}
+
+RUNTIME_API LmValue lm_list_add(LmList* a, LmList* b) {
+    return elementwise(a, b, false);
+}
+
+RUNTIME_API LmValue lm_list_mul(LmList* a, LmList* b) {
+    return elementwise(a, b, true);
+}
+
+RUNTIME_API LmValue lm_list_scale(LmList* list, LmValue factor) {
+    if (!list) return VAL_NIL;
+    uint64_t n = list->size;
+    int64_t int_factor;
+    if (list->kind == LM_LIST_F64 && is_numeric(factor)) {
+        LmList* out = lm_list_new_sized(LM_LIST_F64, n);
+        if (!out) return VAL_NIL;
+        DISPATCH(scale_f64, out->floats, list->floats, as_float(factor), n);
+        return BOX_PTR(out);
+    }
+    if (list->kind == LM_LIST_I64 && is_float(factor)) {
+        // Int times float is a float, as for the * operator
+        LmList* out = lm_list_new_sized(LM_LIST_F64, n);
+        if (!out) return VAL_NIL;
+        double f = as_float(factor);
+        for (uint64_t i = 0; i < n; i++) out->floats[i] = (double)list->ints[i] * f;
+        return BOX_PTR(out);
+    }
+    if (list->kind == LM_LIST_I64 && exact_i64(factor, &int_factor)) {
+        LmList* out = lm_list_new_sized(LM_LIST_I64, n);
+        if (!out) return VAL_NIL;
+        if (scale_i64(out->ints, list->ints, int_factor, n)) return BOX_PTR(out);
+        lm_list_free(out);
+    }
+
+    LmList* out = lm_list_new();
+    if (!out) return VAL_NIL;
+    for (uint64_t i = 0; i < n; i++) lm_list_append(out, lm_mul_inline(lm_list_get(list, i), factor));
+    return BOX_PTR(out);
+}
+
+RUNTIME_API LmValue lm_list_prefix_sum(LmList* list) {
+    if (!list) return VAL_NIL;
+    uint64_t n = list->size;
+    if (list->kind == LM_LIST_F64) {
+        LmList* out = lm_list_new_sized(LM_LIST_F64, n);
+        if (!out) return VAL_NIL;
+        prefix_sum_f64(out->floats, list->floats, n);
+        return BOX_PTR(out);
+    }
+    if (list->kind == LM_LIST_I64) {
+        LmList* out = lm_list_new_sized(LM_LIST_I64, n);
+        if (!out) return VAL_NIL;
+        if (prefix_sum_i64(out->ints, list->ints, n)) return BOX_PTR(out);
+        lm_list_free(out);
+    }
+
+    LmList* out = lm_list_new();
+    if (!out) return VAL_NIL;
+    LmValue sum = BOX_INT(0);
+    for (uint64_t i = 0; i < n; i++) {
+        sum = lm_add_inline(sum, lm_list_get(list, i));
+        lm_list_append(out, sum);
+    }
+    return BOX_PTR(out);
+}
+
+RUNTIME_API LmValue lm_list_contains_value(LmList* list, LmValue value) {
+    return lm_list_contains(list, value) ? VAL_TRUE : VAL_FALSE;
+}
+
+RUNTIME_API LmValue lm_list_index_of_value(LmList* list, LmValue value) {
+    return make_i64(lm_list_index_of(list, value));
+}
+
+RUNTIME_API LmValue lm_list_count_value(LmList* list, LmValue value) {
+    return make_i64(lm_list_count(list, value));
+}
+
+// =============================================================================
+// Builtin table
+// =============================================================================
+
+static LmList* list_arg(LmValue v) {
+    return IS_PTR(v) && ((ObjHeader*)UNBOX_PTR(v))->type_id == TYPE_LIST ? (LmList*)UNBOX_PTR(v) : NULL;
+}
+
+static LmValue call_sum(LmList* list, LmValue arg) { (void)arg; return lm_list_sum(list); }
+static LmValue call_min(LmList* list, LmValue arg) { (void)arg; return lm_list_min(list); }
+static LmValue call_max(LmList* list, LmValue arg) { (void)arg; return lm_list_max(list); }
+static LmValue call_mean(LmList* list, LmValue arg) { (void)arg; return lm_list_mean(list); }
+static LmValue call_prefix_sum(LmList* list, LmValue arg) { (void)arg; return lm_list_prefix_sum(list); }
+static LmValue call_scale(LmList* list, LmValue factor) { return lm_list_scale(list, factor); }
+
+static LmValue call_dot(LmList* list, LmValue other) {
+    LmList* b = list_arg(other);
+    return b ? lm_list_dot(list, b) : VAL_NIL;
+}
+
+static LmValue call_add(LmList* list, LmValue other) {
+    LmList* b = list_arg(other);
+    return b ? lm_list_add(list, b) : VAL_NIL;
+}
+
+static LmValue call_mul(LmList* list, LmValue other) {
+    LmList* b = list_arg(other);
+    return b ? lm_list_mul(list, b) : VAL_NIL;
+}
+
+static const struct {
+    const char* name;
+    LmListKernel kernel;
+} list_kernels[] = {
+    {"list_sum", call_sum},
+    {"list_min", call_min},
+    {"list_max", call_max},
+    {"list_mean", call_mean},
+    {"list_dot", call_dot},
+    {"list_contains", lm_list_contains_value},
+    {"list_index_of", lm_list_index_of_value},
+    {"list_count", lm_list_count_value},
+    {"list_add", call_add},
+    {"list_mul", call_mul},
+    {"list_scale", call_scale},
+    {"list_prefix_sum", call_prefix_sum},
+};
+
+RUNTIME_API LmListKernel lm_list_kernel(const char* name) {
+    if (!name || strncmp(name, "list_", 5) != 0) return NULL;
+    for (size_t i = 0; i < sizeof(list_kernels) / sizeof(list_kernels[0]); i++) {
+        if (strcmp(list_kernels[i].name, name) == 0) return list_kernels[i].kernel;
+    }
+    return NULL;
+}
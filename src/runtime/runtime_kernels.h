@@ -0,0 +1,58 @@
+#ifndef RUNTIME_KERNELS_H
+#define RUNTIME_KERNELS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "runtime_value_base.h"
+#include "runtime_list.h"
+
+// For static linking, define as empty
+#ifndef RUNTIME_API
+    #define RUNTIME_API
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Whole-list kernels behind the list_* builtins. Int, float and bool lists
+// are processed in their unboxed storage with SSE2 or, when the CPU has it,
+// AVX2; other lists, and argument combinations without a typed kernel, fall
+// back to boxed arithmetic and lm_value_eq with the same results.
+//
+// Float sums and dot products add in lane order, so they can differ from a
+// left-to-right loop in the last bits. Int results are exact and promote
+// past 64 bits like the + operator.
+
+RUNTIME_API LmValue lm_list_sum(LmList* list);                 // 0 for an empty list
+RUNTIME_API LmValue lm_list_min(LmList* list);                 // nil for an empty list
+RUNTIME_API LmValue lm_list_max(LmList* list);                 // nil for an empty list
+RUNTIME_API LmValue lm_list_mean(LmList* list);                // Float, nil for an empty list
+RUNTIME_API LmValue lm_list_dot(LmList* a, LmList* b);         // nil unless the lengths match
+
+RUNTIME_API int64_t lm_list_index_of(LmList* list, LmValue value);  // -1 when absent
+RUNTIME_API bool lm_list_contains(LmList* list, LmValue value);
+RUNTIME_API int64_t lm_list_count(LmList* list, LmValue value);
+
+// The searches with boxed results, for callers that only pass LmValues
+RUNTIME_API LmValue lm_list_contains_value(LmList* list, LmValue value);  // Bool
+RUNTIME_API LmValue lm_list_index_of_value(LmList* list, LmValue value);  // Int
+RUNTIME_API LmValue lm_list_count_value(LmList* list, LmValue value);     // Int
+
+// Elementwise operations return a new list, or nil unless the lengths match
+RUNTIME_API LmValue lm_list_add(LmList* a, LmList* b);
+RUNTIME_API LmValue lm_list_mul(LmList* a, LmList* b);
+RUNTIME_API LmValue lm_list_scale(LmList* list, LmValue factor);
+RUNTIME_API LmValue lm_list_prefix_sum(LmList* list);
+
+// The kernels under their builtin names (list_sum, list_dot, ...), as calls
+// taking a list and one more argument that single-list kernels ignore.
+// Returns NULL for any other name.
+typedef LmValue (*LmListKernel)(LmList* list, LmValue arg);
+RUNTIME_API LmListKernel lm_list_kernel(const char* name);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // RUNTIME_KERNELS_H
@@ -1,46 +1,123 @@
 #define BUILDING_RUNTIME
 #include "runtime_list.h"
+#include "runtime_gc.h"
+#include "runtime_value.h"
 #include <string.h>
 
-RUNTIME_API LmList* lm_list_new(void) {
-    LmList* list = (LmList*)malloc(sizeof(LmList));
+#define INITIAL_CAPACITY 8
+
+RUNTIME_API size_t lm_list_element_size(LmListKind kind) {
+    return kind == LM_LIST_BOOL ? sizeof(uint8_t) : sizeof(LmValue);
+}
+
+static LmList* allocate(LmListKind kind, uint64_t capacity) {
+    LmList* list = (LmList*)lm_gc_alloc(sizeof(LmList));
     if (!list) return NULL;
     
     list->header.type_id = TYPE_LIST;
     list->header.metadata = 0;
-    list->capacity = 8;
+    list->kind = kind;
+    list->capacity = capacity;
     list->size = 0;
-    list->data = (LmValue*)malloc(sizeof(LmValue) * list->capacity);
-    if (!list->data) {
-        free(list);
+    list->values = (LmValue*)malloc(lm_list_element_size(kind) * list->capacity);
+    if (!list->values) {
+        lm_gc_free(list);
         return NULL;
     }
+    lm_gc_account(lm_list_element_size(kind) * list->capacity);
     
     return list;
 }
 
+RUNTIME_API LmList* lm_list_new_typed(LmListKind kind) {
+    return allocate(kind, INITIAL_CAPACITY);
+}
+
+RUNTIME_API LmList* lm_list_new_sized(LmListKind kind, uint64_t size) {
+    LmList* list = allocate(kind, size > INITIAL_CAPACITY ? size : INITIAL_CAPACITY);
+    if (!list) return NULL;
+    memset(list->values, 0, lm_list_element_size(kind) * size);
+    list->size = size;
+    return list;
+}
+
+RUNTIME_API LmList* lm_list_new(void) {
+    return lm_list_new_typed(LM_LIST_VALUES);
+}
+
+static LmValue element_at(const LmList* list, uint64_t index) {
+    switch (list->kind) {
+        case LM_LIST_I64: return make_i64(list->ints[index]);
+        case LM_LIST_F64: return make_float(list->floats[index]);
+        case LM_LIST_BOOL: return list->bools[index] ? VAL_TRUE : VAL_FALSE;
+        default: return list->values[index];
+    }
+}
+
+// The element must already have the list's representation
+static void store_at(LmList* list, uint64_t index, LmValue element) {
+    switch (list->kind) {
+        case LM_LIST_I64: list->ints[index] = as_i64(element); break;
+        case LM_LIST_F64: list->floats[index] = as_float(element); break;
+        case LM_LIST_BOOL: list->bools[index] = element == VAL_TRUE; break;
+        default: list->values[index] = element; break;
+    }
+}
+
+// An empty list reuses its buffer for the new representation
+static void retype_empty(LmList* list, LmListKind kind) {
+    list->capacity = list->capacity * lm_list_element_size(list->kind) / lm_list_element_size(kind);
+    list->kind = kind;
+}
+
+// Boxes the elements of a typed list. Allocating the boxes cannot start a
+// collection, so they are safe until the list holds them.
+static bool generalize(LmList* list) {
+    LmValue* values = (LmValue*)malloc(sizeof(LmValue) * list->capacity);
+    if (!values) return false;
+    for (uint64_t i = 0; i < list->size; i++) values[i] = element_at(list, i);
+    lm_gc_account((sizeof(LmValue) - lm_list_element_size(list->kind)) * list->capacity);
+    free(list->values);
+    list->values = values;
+    list->kind = LM_LIST_VALUES;
+    return true;
+}
+
+// Makes the list able to hold the element, changing its representation
+// if needed
+static bool accept(LmList* list, LmValue element) {
+    LmListKind kind = lm_list_kind_of(element);
+    if (kind == list->kind || (list->kind == LM_LIST_VALUES && list->size > 0)) return true;
+    if (list->size == 0) {
+        retype_empty(list, kind);
+        return true;
+    }
+    return generalize(list);
+}
+
 RUNTIME_API void lm_list_append(LmList* list, LmValue element) {
-    if (!list) return;
+    if (!list || !accept(list, element)) return;
     
     if (list->size >= list->capacity) {
-        list->capacity *= 2;
-        LmValue* new_data = (LmValue*)realloc(list->data,
-                                          sizeof(LmValue) * list->capacity);
+        size_t element_size = lm_list_element_size(list->kind);
+        LmValue* new_data = (LmValue*)realloc(list->values, element_size * list->capacity * 2);
         if (!new_data) return;
-        list->data = new_data;
+        list->values = new_data;
+        lm_gc_account(element_size * list->capacity);
+        list->capacity *= 2;
     }
     
-    list->data[list->size++] = element;
+    store_at(list, list->size++, element);
 }
 
 RUNTIME_API LmValue lm_list_get(LmList* list, uint64_t index) {
     if (!list || index >= list->size) return VAL_NIL;
-    return list->data[index];
+    return element_at(list, index);
 }
 
 RUNTIME_API void lm_list_set(LmList* list, uint64_t index, LmValue element) {
-    if (!list || index >= list->size) return;
-    list->data[index] = element;
+    if (!list || index >= list->size || !accept(list, element)) return;
+    store_at(list, index, element);
 }
 
 RUNTIME_API uint64_t lm_list_len(LmList* list) {
@@ -49,6 +126,6 @@ RUNTIME_API uint64_t lm_list_len(LmList* list) {
 
 RUNTIME_API void lm_list_free(LmList* list) {
     if (!list) return;
-    if (list->data) free(list->data);
-    free(list);
+    if (list->values) free(list->values);
+    lm_gc_free(list);
 }
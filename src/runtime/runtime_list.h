@@ -14,20 +14,53 @@
 extern "C" {
 #endif
 
-// Generic list structure (stores Values)
+// Element representations. Lists of ints, floats or bools store raw
+// int64_t, double or uint8_t elements instead of boxed values. An empty list
+// takes the representation of its first element, and a typed list falls back
+// to LM_LIST_VALUES, boxing its elements, the first time it is given an
+// element of another kind. Readers get boxed values either way.
+typedef enum {
+    LM_LIST_VALUES,
+    LM_LIST_I64,
+    LM_LIST_F64,
+    LM_LIST_BOOL
+} LmListKind;
+
 typedef struct {
     ObjHeader header;
-    LmValue* data;
+    union {
+        LmValue* values;
+        int64_t* ints;
+        double* floats;
+        uint8_t* bools;
+    };
     uint64_t size;
     uint64_t capacity;
+    LmListKind kind;
 } LmList;
 
+// The representation a value is stored in
+static inline LmListKind lm_list_kind_of(LmValue value) {
+    if (IS_INT(value)) return LM_LIST_I64;
+    if (IS_FLOAT_IMM(value)) return LM_LIST_F64;
+    if (IS_BOOL(value)) return LM_LIST_BOOL;
+    if (IS_PTR(value)) {
+        uint32_t type_id = ((ObjHeader*)UNBOX_PTR(value))->type_id;
+        if (type_id == TYPE_I64) return LM_LIST_I64;
+        if (type_id == TYPE_FLOAT) return LM_LIST_F64;
+    }
+    return LM_LIST_VALUES;
+}
+
 // List operations
 RUNTIME_API LmList* lm_list_new(void);
+RUNTIME_API LmList* lm_list_new_typed(LmListKind kind);  // For a statically known element type
+RUNTIME_API LmList* lm_list_new_sized(LmListKind kind, uint64_t size);  // size zeroed elements of a typed kind
 RUNTIME_API void lm_list_append(LmList* list, LmValue element);
 RUNTIME_API LmValue lm_list_get(LmList* list, uint64_t index);
 RUNTIME_API void lm_list_set(LmList* list, uint64_t index, LmValue element);
 RUNTIME_API uint64_t lm_list_len(LmList* list);
+RUNTIME_API size_t lm_list_element_size(LmListKind kind);
 RUNTIME_API void lm_list_free(LmList* list);
 
 #ifdef __cplusplus
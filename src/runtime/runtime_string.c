@@ -2,8 +2,316 @@
 #include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
-#include <stdio.h>
+#include <pthread.h>
 #include "runtime_string.h"
+#include "runtime_value.h"
+#include "runtime_gc.h"
+#include "runtime_format.h"
+
+static ObjString* string_alloc(uint64_t length) {
+    ObjString* string = (ObjString*)lm_gc_alloc(sizeof(ObjString) + length + 1);
+    if (!string) return NULL;
+    string->header.type_id = TYPE_STRING;
+    string->header.metadata = 0;
+    string->length = (uint32_t)length;
+    string->hash = 0;
+    string->data[length] = '\0';
+    return string;
+}
+
+RUNTIME_API ObjString* lm_string_new(const char* data, uint64_t length) {
+    ObjString* string = string_alloc(length);
+    if (string && length) memcpy(string->data, data, length);
+    return string;
+}
+
+RUNTIME_API ObjString* lm_string_new_cstr(const char* cstr) {
+    return lm_string_new(cstr ? cstr : "", cstr ? strlen(cstr) : 0);
+}
+
+// djb2, folded to 32 bits; 0 is reserved for "not computed yet"
+RUNTIME_API uint64_t lm_string_hash(ObjString* string) {
+    if (string->hash) return string->hash;
+    uint64_t hash = 5381;
+    for (uint32_t i = 0; i < string->length; i++) {
+        hash = ((hash << 5) + hash) + (unsigned char)string->data[i];
+    }
+    uint32_t folded = (uint32_t)(hash ^ (hash >> 32));
+    string->hash = folded ? folded : 1;
+    return string->hash;
+}
+
+RUNTIME_API bool lm_string_equals(ObjString* a, ObjString* b) {
+    if (a == b) return true;
+    if (a->header.metadata & b->header.metadata & OBJ_INTERNED) return false;
+    if (a->length != b->length) return false;
+    if (a->hash && b->hash && a->hash != b->hash) return false;
+    return memcmp(a->data, b->data, a->length) == 0;
+}
+
+RUNTIME_API int lm_string_compare(const ObjString* a, const ObjString* b) {
+    if (a == b) return 0;
+    uint32_t common = a->length < b->length ? a->length : b->length;
+    int result = memcmp(a->data, b->data, common);
+    if (result) return result < 0 ? -1 : 1;
+    return (a->length > b->length) - (a->length < b->length);
+}
+
+// Open-addressing set of interned strings, probed linearly from the
+// string's hash. Removed slots become tombstones until the next resize.
+#define INTERN_MIN_CAPACITY 256
+#define TOMBSTONE ((ObjString*)1)
+
+static struct {
+    pthread_mutex_t lock;
+    ObjString** slots;
+    size_t capacity;  // Power of two
+    size_t count;
+    size_t tombstones;
+} interned = { PTHREAD_MUTEX_INITIALIZER, NULL, 0, 0, 0 };
+
+// Slot holding a string equal to string, or the slot to insert it into
+static ObjString** intern_slot(ObjString* string, uint32_t hash) {
+    size_t mask = interned.capacity - 1;
+    ObjString** insert_at = NULL;
+    for (size_t i = hash & mask;; i = (i + 1) & mask) {
+        ObjString* slot = interned.slots[i];
+        if (!slot) return insert_at ? insert_at : &interned.slots[i];
+        if (slot == TOMBSTONE) {
+            if (!insert_at) insert_at = &interned.slots[i];
+        } else if (slot->hash == hash && slot->length == string->length &&
+                   memcmp(slot->data, string->data, string->length) == 0) {
+            return &interned.slots[i];
+        }
+    }
+}
+
+static bool intern_resize(size_t capacity) {
+    ObjString** slots = (ObjString**)calloc(capacity, sizeof(ObjString*));
+    if (!slots) return false;
+    ObjString** old = interned.slots;
+    size_t old_capacity = interned.capacity;
+    interned.slots = slots;
+    interned.capacity = capacity;
+    interned.tombstones = 0;
+    for (size_t i = 0; i < old_capacity; i++) {
+        ObjString* string = old[i];
+        if (string && string != TOMBSTONE) *intern_slot(string, string->hash) = string;
+    }
+    free(old);
+    return true;
+}
+
+RUNTIME_API ObjString* lm_string_intern(ObjString* string) {
+    if (!string || (string->header.metadata & OBJ_INTERNED)) return string;
+    uint32_t hash = (uint32_t)lm_string_hash(string);
+
+    pthread_mutex_lock(&interned.lock);
+    // Keep at most three quarters of the slots in use, tombstones included
+    if ((interned.count + interned.tombstones + 1) * 4 > interned.capacity * 3) {
+        size_t capacity = interned.capacity ? interned.capacity : INTERN_MIN_CAPACITY;
+        while ((interned.count + 1) * 2 > capacity) capacity *= 2;
+        if (!intern_resize(capacity)) {
+            pthread_mutex_unlock(&interned.lock);
+            return string;
+        }
+    }
+
+    ObjString** slot = intern_slot(string, hash);
+    if (*slot && *slot != TOMBSTONE) {
+        string = *slot;
+    } else {
+        if (*slot == TOMBSTONE) interned.tombstones--;
+        *slot = string;
+        interned.count++;
+        string->header.metadata |= OBJ_INTERNED;
+    }
+    pthread_mutex_unlock(&interned.lock);
+    return string;
+}
+
+RUNTIME_API LmValue lm_string_intern_value(LmValue value) {
+    return lm_is_string(value) ? BOX_PTR(lm_string_intern(AS_STRING(value))) : value;
+}
+
+RUNTIME_API void lm_string_unintern(ObjString* string) {
+    if (!(string->header.metadata & OBJ_INTERNED)) return;
+    pthread_mutex_lock(&interned.lock);
+    ObjString** slot = intern_slot(string, string->hash);
+    if (*slot == string) {
+        *slot = TOMBSTONE;
+        interned.count--;
+        interned.tombstones++;
+    }
+    pthread_mutex_unlock(&interned.lock);
+    string->header.metadata &= ~OBJ_INTERNED;
+}
+
+// The characters of a value: a string's own, a number or other scalar
+// formatted into scratch, or an owned formatted copy of anything else.
+// data may point into the Text itself, so Texts are filled in place.
+typedef struct {
+    const char* data;
+    uint64_t len;
+    LmString owned;
+    char scratch[LM_NUMBER_CHARS];
+} Text;
+
+static void text_init(Text* text, LmValue value) {
+    text->owned = (LmString){ NULL, 0 };
+    if (lm_is_string(value)) {
+        ObjString* string = AS_STRING(value);
+        text->data = string->data;
+        text->len = string->length;
+        return;
+    }
+    size_t length;
+    if (lm_format_scalar(value, text->scratch, &length)) {
+        text->data = text->scratch;
+        text->len = length;
+        return;
+    }
+    text->owned = lm_value_to_string(value);
+    text->data = text->owned.data ? text->owned.data : "";
+    text->len = text->owned.len;
+}
+
+RUNTIME_API LmValue lm_value_to_string_object(LmValue value) {
+    if (lm_is_string(value)) return value;
+    Text text;
+    text_init(&text, value);
+    ObjString* string = lm_string_new(text.data, text.len);
+    lm_string_free(text.owned);
+    return string ? BOX_PTR(string) : VAL_NIL;
+}
+
+// Decimals are integers scaled by 10^scale; anything else formats as usual
+RUNTIME_API LmValue lm_decimal_to_string_object(LmValue scaled, int scale) {
+    if (!is_integer(scaled)) return lm_value_to_string_object(scaled);
+    char text[LM_NUMBER_CHARS];
+    size_t length = lm_format_decimal(as_i128(scaled), scale, text);
+    ObjString* string = lm_string_new(text, length);
+    return string ? BOX_PTR(string) : VAL_NIL;
+}
+
+RUNTIME_API LmValue lm_string_concat_values(LmValue a, LmValue b) {
+    LmValue parts[2] = { a, b };
+    return lm_string_build(parts, 2);
+}
+
+// Replaces the first %s in format with arg, or appends arg when there is none
+RUNTIME_API LmValue lm_string_format_values(LmValue format, LmValue arg) {
+    Text fmt, text;
+    text_init(&fmt, format);
+    text_init(&text, arg);
+
+    uint64_t split = fmt.len, resume = fmt.len;
+    for (uint64_t i = 0; i + 1 < fmt.len; i++) {
+        if (fmt.data[i] == '%' && fmt.data[i + 1] == 's') {
+            split = i;
+            resume = i + 2;
+            break;
+        }
+    }
+
+    uint64_t tail = fmt.len - resume;
+    ObjString* string = string_alloc(split + text.len + tail);
+    if (string) {
+        memcpy(string->data, fmt.data, split);
+        memcpy(string->data + split, text.data, text.len);
+        memcpy(string->data + split + text.len, fmt.data + resume, tail);
+    }
+    lm_string_free(fmt.owned);
+    lm_string_free(text.owned);
+    return string ? BOX_PTR(string) : VAL_NIL;
+}
+
+// The texts of several values and their total length. Up to LOCAL_PARTS
+// texts are kept without allocating.
+#define LOCAL_PARTS 8
+#define MIN_APPEND_CAPACITY 32
+
+typedef struct {
+    Text* texts;
+    Text local[LOCAL_PARTS];
+    uint64_t count;
+    uint64_t length;
+} Parts;
+
+static bool parts_init(Parts* parts, const LmValue* values, uint64_t count) {
+    parts->texts = count <= LOCAL_PARTS ? parts->local : (Text*)malloc(count * sizeof(Text));
+    if (!parts->texts) return false;
+    parts->count = count;
+    parts->length = 0;
+    for (uint64_t i = 0; i < count; i++) {
+        text_init(&parts->texts[i], values[i]);
+        parts->length += parts->texts[i].len;
+    }
+    return true;
+}
+
+static void parts_copy(const Parts* parts, char* dest) {
+    for (uint64_t i = 0; i < parts->count; i++) {
+        memcpy(dest, parts->texts[i].data, parts->texts[i].len);
+        dest += parts->texts[i].len;
+    }
+}
+
+static void parts_free(Parts* parts) {
+    for (uint64_t i = 0; i < parts->count; i++) lm_string_free(parts->texts[i].owned);
+    if (parts->texts != parts->local) free(parts->texts);
+}
+
+RUNTIME_API LmValue lm_string_build(const LmValue* values, uint64_t count) {
+    Parts parts;
+    if (!parts_init(&parts, values, count)) return VAL_NIL;
+    ObjString* string = string_alloc(parts.length);
+    if (string) parts_copy(&parts, string->data);
+    parts_free(&parts);
+    return string ? BOX_PTR(string) : VAL_NIL;
+}
+
+// Parts that refer to target itself were formatted before anything is
+// written, and only past its old length, so s + s appends safely
+RUNTIME_API LmValue lm_string_append(LmValue target, const LmValue* values, uint64_t count) {
+    Parts parts;
+    if (!parts_init(&parts, values, count)) return VAL_NIL;
+
+    ObjString* string = lm_is_string(target) ? AS_STRING(target) : NULL;
+    const uint32_t flags = OBJ_APPENDABLE | OBJ_INTERNED | OBJ_IMMUTABLE;
+    if (string && (string->header.metadata & flags) == OBJ_APPENDABLE &&
+        string->length + parts.length <= (string->header.metadata & STRING_CAPACITY_MASK)) {
+        parts_copy(&parts, string->data + string->length);
+        string->length += (uint32_t)parts.length;
+        string->data[string->length] = '\0';
+        string->hash = 0;
+        parts_free(&parts);
+        return target;
+    }
+
+    // Double the room so that a run of appends copies each byte a constant
+    // number of times on average
+    Text base;
+    text_init(&base, target);
+    uint64_t length = base.len + parts.length;
+    uint64_t capacity = length < MIN_APPEND_CAPACITY / 2 ? MIN_APPEND_CAPACITY : length * 2;
+    if (capacity > STRING_CAPACITY_MASK) capacity = length;
+
+    ObjString* grown = (ObjString*)lm_gc_alloc(sizeof(ObjString) + capacity + 1);
+    if (grown) {
+        grown->header.type_id = TYPE_STRING;
+        grown->header.metadata = capacity <= STRING_CAPACITY_MASK ? OBJ_APPENDABLE | (uint32_t)capacity : 0;
+        grown->length = (uint32_t)length;
+        grown->hash = 0;
+        memcpy(grown->data, base.data, base.len);
+        parts_copy(&parts, grown->data + base.len);
+        grown->data[length] = '\0';
+    }
+    lm_string_free(base.owned);
+    parts_free(&parts);
+    if (grown && string && (string->header.metadata & flags) == OBJ_APPENDABLE) lm_gc_free(string);
+    return grown ? BOX_PTR(grown) : VAL_NIL;
+}
 
 // String concatenation function
 RUNTIME_API LmString lm_string_concat(LmString a, LmString b) {
@@ -27,60 +335,30 @@ RUNTIME_API LmString lm_string_concat(LmString a, LmString b) {
     return (LmString){ buf, a.len + b.len };
 }
 
+// Owned copy of formatted text
+static LmString owned_copy(const char* data, size_t length) {
+    char* buf = (char*)malloc(length + 1);
+    if (!buf) return (LmString){ NULL, 0 };
+    memcpy(buf, data, length);
+    buf[length] = 0;
+    return (LmString){ buf, length };
+}
+
 // Convert integer to string
 RUNTIME_API LmString lm_int_to_string(int64_t value) {
-    // Buffer large enough for 64-bit integer
-    char temp[32];
-    int len = snprintf(temp, sizeof(temp), "%lld", (long long)value);
-    if (len <= 0) {
-        return (LmString){ NULL, 0 };
-    }
-    
-    char* buf = (char*)malloc(len + 1);
-    if (!buf) {
-        return (LmString){ NULL, 0 };
-    }
-    
-    memcpy(buf, temp, len);
-    buf[len] = 0;
-    
-    return (LmString){ buf, (uint64_t)len };
+    char temp[LM_NUMBER_CHARS];
+    return owned_copy(temp, lm_format_i64(value, temp));
 }
 
 // Convert double to string
 RUNTIME_API LmString lm_double_to_string(double value) {
-    // Buffer large enough for 64-bit double
-    char temp[64];
-    int len = snprintf(temp, sizeof(temp), "%.15g", value);
-    if (len <= 0) {
-        return (LmString){ NULL, 0 };
-    }
-    
-    char* buf = (char*)malloc(len + 1);
-    if (!buf) {
-        return (LmString){ NULL, 0 };
-    }
-    
-    memcpy(buf, temp, len);
-    buf[len] = 0;
-    
-    return (LmString){ buf, (uint64_t)len };
+    char temp[LM_NUMBER_CHARS];
+    return owned_copy(temp, lm_format_double(value, temp));
 }
 
 // Convert boolean to string
 RUNTIME_API LmString lm_bool_to_string(uint8_t value) {
-    const char* str = value ? "true" : "false";
-    uint64_t len = strlen(str);
-    
-    char* buf = (char*)malloc(len + 1);
-    if (!buf) {
-        return (LmString){ NULL, 0 };
-    }
-    
-    memcpy(buf, str, len);
-    buf[len] = 0;
-    
-    return (LmString){ buf, len };
+    return value ? owned_copy("true", 4) : owned_copy("false", 5);
 }
 
 // Get data pointer from LmString
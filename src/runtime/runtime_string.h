@@ -19,13 +19,64 @@ typedef struct {
     uint64_t len;
 } LmString;
 
-// Header-only string structure for heap objects
+// Immutable string object (TYPE_STRING). The characters follow the fixed
+// fields in the same block, NUL-terminated for C callers, so a string of up
+// to 15 bytes is a single 48-byte allocation from the small size classes.
+// hash is 0 until lm_string_hash first computes it.
 typedef struct {
     ObjHeader header;
-    char data[0];
-} LmStringObj;
+    uint32_t length;
+    uint32_t hash;
+    char data[];
+} ObjString;
 
-// String management functions
+static inline bool lm_is_string(LmValue value) {
+    return IS_PTR(value) && ((ObjHeader*)UNBOX_PTR(value))->type_id == TYPE_STRING;
+}
+
+#define AS_STRING(value) ((ObjString*)UNBOX_PTR(value))
+
+// metadata flag for the canonical string of its contents. Two interned
+// strings are equal exactly when they are the same object.
+#define OBJ_INTERNED 0x20000000u
+
+// metadata flag for a string whose only reference may extend it in place
+// with lm_string_append. The low metadata bits keep the bytes reserved for
+// its characters.
+#define OBJ_APPENDABLE 0x10000000u
+#define STRING_CAPACITY_MASK 0x0FFFFFFFu
+
+// String objects
+RUNTIME_API ObjString* lm_string_new(const char* data, uint64_t length);
+RUNTIME_API ObjString* lm_string_new_cstr(const char* cstr);
+RUNTIME_API uint64_t lm_string_hash(ObjString* string);
+RUNTIME_API bool lm_string_equals(ObjString* a, ObjString* b);
+RUNTIME_API int lm_string_compare(const ObjString* a, const ObjString* b);
+
+// Intern table. lm_string_intern returns the canonical string equal to
+// string, adopting string itself when there is none yet. The table does not
+// keep its strings alive: the collector calls lm_string_unintern when it
+// destroys one.
+RUNTIME_API ObjString* lm_string_intern(ObjString* string);
+RUNTIME_API LmValue lm_string_intern_value(LmValue value);  // Non-strings come back unchanged
+RUNTIME_API void lm_string_unintern(ObjString* string);
+
+// Value-level string operations. Strings are used in place; other values
+// are formatted first.
+RUNTIME_API LmValue lm_value_to_string_object(LmValue value);
+RUNTIME_API LmValue lm_decimal_to_string_object(LmValue scaled, int scale);
+RUNTIME_API LmValue lm_string_concat_values(LmValue a, LmValue b);
+RUNTIME_API LmValue lm_string_format_values(LmValue format, LmValue arg);
+
+// The parts formatted and joined into one new string of exactly their length
+RUNTIME_API LmValue lm_string_build(const LmValue* parts, uint64_t count);
+// The parts appended to target. An appendable target with enough room is
+// extended in place; otherwise the result is a new appendable string with
+// spare room for later appends, and an appendable target is freed. Only the
+// holder of the sole reference to target may call this.
+RUNTIME_API LmValue lm_string_append(LmValue target, const LmValue* parts, uint64_t count);
+
+// Owned character buffers, used while formatting
 RUNTIME_API LmString lm_string_concat(LmString a, LmString b);
 RUNTIME_API LmString lm_int_to_string(int64_t value);
 RUNTIME_API LmString lm_double_to_string(double value);
@@ -1,21 +1,16 @@
 #include "runtime_tuple.h"
+#include "runtime_gc.h"
+#include "runtime_alloc.h"
 #include <stdlib.h>
 #include <string.h>
 
 RUNTIME_API LmTuple* lm_tuple_new(uint64_t size) {
-    LmTuple* tuple = (LmTuple*)malloc(sizeof(LmTuple));
+    LmTuple* tuple = (LmTuple*)lm_gc_alloc(sizeof(LmTuple) + sizeof(LmValue) * size);
     if (!tuple) return NULL;
     
-    tuple->elements = (LmValue*)malloc(sizeof(LmValue) * size);
-    if (!tuple->elements) {
-        free(tuple);
-        return NULL;
-    }
-    
     tuple->header.type_id = TYPE_TUPLE;
     tuple->header.metadata = 0;
     tuple->size = size;
-    tuple->capacity = size;
     
     for (uint64_t i = 0; i < size; i++) tuple->elements[i] = VAL_NIL;
     
@@ -26,27 +21,21 @@ RUNTIME_API LmTuple* lm_tuple_new_with_values(uint64_t size, LmValue* values) {
     LmTuple* tuple = lm_tuple_new(size);
     if (!tuple) return NULL;
     
-    for (uint64_t i = 0; i < size; i++) {
-        tuple->elements[i] = values[i];
-    }
-    tuple->size = size;
+    memcpy(tuple->elements, values, sizeof(LmValue) * size);
     
     return tuple;
 }
 
 RUNTIME_API void lm_tuple_set(LmTuple* tuple, uint64_t index, LmValue value) {
-    if (!tuple || !tuple->elements || index >= tuple->capacity) {
+    if (!tuple || index >= tuple->size) {
         return;
     }
     
     tuple->elements[index] = value;
-    if (index >= tuple->size) {
-        tuple->size = index + 1;
-    }
 }
 
 RUNTIME_API LmValue lm_tuple_get(LmTuple* tuple, uint64_t index) {
-    if (!tuple || !tuple->elements || index >= tuple->size) {
+    if (!tuple || index >= tuple->size) {
         return VAL_NIL;
     }
     return tuple->elements[index];
@@ -56,54 +45,14 @@ RUNTIME_API uint64_t lm_tuple_size(LmTuple* tuple) {
     return tuple ? tuple->size : 0;
 }
 
-RUNTIME_API uint64_t lm_tuple_capacity(LmTuple* tuple) {
-    return tuple ? tuple->capacity : 0;
-}
-
-RUNTIME_API void lm_tuple_resize(LmTuple* tuple, uint64_t new_size) {
-    if (!tuple) return;
-    
-    if (new_size > tuple->capacity) {
-        LmValue* new_elements = (LmValue*)realloc(tuple->elements, sizeof(LmValue) * new_size);
-        if (new_elements) {
-            for (uint64_t i = tuple->capacity; i < new_size; i++) new_elements[i] = VAL_NIL;
-            tuple->elements = new_elements;
-            tuple->capacity = new_size;
-        }
-    }
-    
-    if (new_size < tuple->size) {
-        tuple->size = new_size;
-    }
-}
-
-RUNTIME_API void lm_tuple_append(LmTuple* tuple, LmValue value) {
-    if (!tuple) return;
-    if (tuple->size >= tuple->capacity) {
-        lm_tuple_resize(tuple, tuple->capacity == 0 ? 8 : tuple->capacity * 2);
-    }
-    tuple->elements[tuple->size++] = value;
-}
-
-RUNTIME_API void lm_tuple_clear(LmTuple* tuple) {
-    if (!tuple) return;
-    for (uint64_t i = 0; i < tuple->size; i++) tuple->elements[i] = VAL_NIL;
-    tuple->size = 0;
-}
-
 RUNTIME_API void lm_tuple_free(LmTuple* tuple) {
-    if (tuple) {
-        if (tuple->elements) {
-            free(tuple->elements);
-        }
-        free(tuple);
-    }
+    lm_gc_free(tuple);
 }
 
 // Iterator implementation
 RUNTIME_API LmTupleIterator* lm_tuple_iterator_new(LmTuple* tuple) {
     if (!tuple) return NULL;
-    LmTupleIterator* iterator = (LmTupleIterator*)malloc(sizeof(LmTupleIterator));
+    LmTupleIterator* iterator = (LmTupleIterator*)lm_alloc(lm_size_class(sizeof(LmTupleIterator)));
     if (!iterator) return NULL;
     iterator->tuple = tuple;
     iterator->current_index = 0;
@@ -122,5 +71,5 @@ RUNTIME_API uint8_t lm_tuple_iterator_has_next(LmTupleIterator* iterator) {
 }
 
 RUNTIME_API void lm_tuple_iterator_free(LmTupleIterator* iterator) {
-    if (iterator) free(iterator);
+    lm_free(iterator, lm_size_class(sizeof(LmTupleIterator)));
 }
@@ -13,24 +13,20 @@
 extern "C" {
 #endif
 
-// Complete tuple structure - fixed size array of Values
+// A tuple's arity is fixed by its type, so the elements live inline after
+// the header and a tuple is a single allocation
 typedef struct {
     ObjHeader header;
-    LmValue* elements;
     uint64_t size;
-    uint64_t capacity;
+    LmValue elements[];
 } LmTuple;
 
 // Complete tuple operations
-RUNTIME_API LmTuple* lm_tuple_new(uint64_t size);
+RUNTIME_API LmTuple* lm_tuple_new(uint64_t size);  // Elements start as nil
 RUNTIME_API LmTuple* lm_tuple_new_with_values(uint64_t size, LmValue* values);  // Create with initial values
 RUNTIME_API void lm_tuple_set(LmTuple* tuple, uint64_t index, LmValue value);
 RUNTIME_API LmValue lm_tuple_get(LmTuple* tuple, uint64_t index);
-RUNTIME_API uint64_t lm_tuple_size(LmTuple* tuple);  // Get current size
-RUNTIME_API uint64_t lm_tuple_capacity(LmTuple* tuple);  // Get capacity
-RUNTIME_API void lm_tuple_resize(LmTuple* tuple, uint64_t new_size);  // Resize tuple
-RUNTIME_API void lm_tuple_append(LmTuple* tuple, LmValue value);  // Append value
-RUNTIME_API void lm_tuple_clear(LmTuple* tuple);  // Clear all elements
+RUNTIME_API uint64_t lm_tuple_size(LmTuple* tuple);
 RUNTIME_API void lm_tuple_free(LmTuple* tuple);
 
 // Tuple iteration support
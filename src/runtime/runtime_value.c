@@ -1,5 +1,4 @@
 #define BUILDING_RUNTIME
-#define _POSIX_C_SOURCE 200809L
 #include "runtime_value.h"
 #include "runtime_value_base.h"
 #include "runtime_list.h"
@@ -7,10 +6,10 @@
 #include "runtime_tuple.h"
 #include "runtime_string.h"
 #include "runtime.h"
+#include "runtime_format.h"
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
-#include <inttypes.h>
 
 // Phase 6: Centralized Runtime Constructors
 RUNTIME_API LmValue make_i64(int64_t v) {
@@ -36,6 +35,8 @@ RUNTIME_API LmValue make_u128(unsigned __int128 v) {
 }
 
 RUNTIME_API LmValue make_float(double v) {
+    LmValue imm;
+    if (try_box_float(v, &imm)) return imm;
     return lm_alloc_float(v);
 }
 
@@ -55,6 +56,7 @@ RUNTIME_API bool is_integer(LmValue v) {
 }
 
 RUNTIME_API bool is_float(LmValue v) {
+    if (IS_FLOAT_IMM(v)) return true;
     if (IS_PTR(v)) {
         ObjHeader* h = (ObjHeader*)UNBOX_PTR(v);
         if (h->type_id == TYPE_FLOAT) return true;
@@ -137,6 +139,7 @@ RUNTIME_API unsigned __int128 as_u128(LmValue v) {
 }
 
 RUNTIME_API double as_float(LmValue v) {
+    if (IS_FLOAT_IMM(v)) return UNBOX_FLOAT(v);
     if (IS_PTR(v)) {
         ObjHeader* h = (ObjHeader*)UNBOX_PTR(v);
         if (h->type_id == TYPE_FLOAT) return ((ObjFloat*)h)->value;
@@ -168,11 +171,13 @@ RUNTIME_API int numeric_compare(LmValue a, LmValue b) {
             return 0;
         }
     }
+    if (lm_is_string(a) && lm_is_string(b)) return lm_string_compare(AS_STRING(a), AS_STRING(b));
     return (a < b) ? -1 : 1;
 }
 
 RUNTIME_API int lm_value_eq(LmValue v1, LmValue v2) {
-    if (v1 == v2) return 1; if (IS_PTR(v1) && IS_PTR(v2)) { ObjHeader* h1 = (ObjHeader*)UNBOX_PTR(v1); ObjHeader* h2 = (ObjHeader*)UNBOX_PTR(v2); if (h1->type_id == h2->type_id && h1->type_id == TYPE_BOX) { LmBox* b1 = (LmBox*)h1; LmBox* b2 = (LmBox*)h2; if (b1->type == b2->type && b1->type == LM_BOX_STRING) return strcmp((char*)b1->value.as_ptr, (char*)b2->value.as_ptr) == 0; } }
+    if (v1 == v2) return 1;
+    if (lm_is_string(v1) && lm_is_string(v2)) return lm_string_equals(AS_STRING(v1), AS_STRING(v2));
     if (is_numeric_internal(v1) && is_numeric_internal(v2)) {
         if (is_float(v1) || is_float(v2)) {
             return as_float(v1) == as_float(v2);
@@ -184,9 +189,7 @@ RUNTIME_API int lm_value_eq(LmValue v1, LmValue v2) {
 }
 
 // Stringification
-static void append_to_buffer(char** buf, uint64_t* pos, uint64_t* capacity, const char* str) {
-    if (!str) return;
-    uint64_t str_len = strlen(str);
+static void append_chars(char** buf, uint64_t* pos, uint64_t* capacity, const char* str, uint64_t str_len) {
     while (*pos + str_len >= *capacity) {
         *capacity *= 2;
         char* new_buf = (char*)realloc(*buf, *capacity);
@@ -197,39 +200,29 @@ static void append_to_buffer(char** buf, uint64_t* pos, uint64_t* capacity, cons
     *pos += str_len;
 }
 
-static char* int128_to_str(__int128 n) {
-    char* buf = (char*)malloc(64);
-    if (n == 0) { strcpy(buf, "0"); return buf; }
-    int sign = 0;
-    if (n < 0) { sign = 1; n = -n; }
-    int i = 62;
-    buf[63] = '\0';
-    while (n > 0) {
-        buf[i--] = (char)((n % 10) + '0');
-        n /= 10;
-    }
-    if (sign) buf[i--] = '-';
-    char* res = strdup(&buf[i+1]);
-    free(buf);
-    return res;
+static void append_to_buffer(char** buf, uint64_t* pos, uint64_t* capacity, const char* str) {
+    if (str) append_chars(buf, pos, capacity, str, strlen(str));
 }
 
-static char* uint128_to_str(unsigned __int128 n) {
-    char* buf = (char*)malloc(64);
-    if (n == 0) { strcpy(buf, "0"); return buf; }
-    int i = 62;
-    buf[63] = '\0';
-    while (n > 0) {
-        buf[i--] = (char)((n % 10) + '0');
-        n /= 10;
+static LmString format_value(LmValue value);
+
+// Strings and scalars are copied straight in; only nested containers allocate
+static void append_value(char** buf, uint64_t* pos, uint64_t* capacity, LmValue value) {
+    char scratch[LM_NUMBER_CHARS];
+    size_t length;
+    if (lm_is_string(value)) {
+        append_chars(buf, pos, capacity, AS_STRING(value)->data, AS_STRING(value)->length);
+        return;
     }
-    char* res = strdup(&buf[i+1]);
-    free(buf);
-    return res;
+    if (lm_format_scalar(value, scratch, &length)) {
+        append_chars(buf, pos, capacity, scratch, length);
+        return;
+    }
+    LmString s = format_value(value);
+    append_to_buffer(buf, pos, capacity, s.data ? s.data : "nil");
+    lm_string_free(s);
 }
 
-static LmString format_value(LmValue value);
-
 static LmString format_list(LmList* list) {
     uint64_t capacity = 256;
     char* buf = (char*)malloc(capacity);
@@ -238,54 +231,59 @@ static LmString format_list(LmList* list) {
     append_to_buffer(&buf, &pos, &capacity, "[");
     for (uint64_t i = 0; i < list->size; i++) {
         if (i > 0) append_to_buffer(&buf, &pos, &capacity, ", ");
-        LmString s = format_value(list->data[i]);
-        append_to_buffer(&buf, &pos, &capacity, s.data ? s.data : "nil");
-        lm_string_free(s);
+        append_value(&buf, &pos, &capacity, lm_list_get(list, i));
     }
     append_to_buffer(&buf, &pos, &capacity, "]");
     buf[pos] = 0;
     return (LmString){ buf, pos };
 }
 
+static LmString format_dict(LmDict* dict) {
+    uint64_t capacity = 256;
+    char* buf = (char*)malloc(capacity);
+    uint64_t pos = 0;
+    buf[0] = 0;
+    append_to_buffer(&buf, &pos, &capacity, "{");
+    bool first = true;
+    LmDictIter iter = lm_dict_iter_begin(dict);
+    LmValue key, value;
+    while (lm_dict_iter_next(dict, &iter, &key, &value) == LM_ITER_ITEM) {
+        if (!first) append_to_buffer(&buf, &pos, &capacity, ", ");
+        first = false;
+        append_value(&buf, &pos, &capacity, key);
+        append_to_buffer(&buf, &pos, &capacity, ": ");
+        append_value(&buf, &pos, &capacity, value);
+    }
+    append_to_buffer(&buf, &pos, &capacity, "}");
+    buf[pos] = 0;
+    return (LmString){ buf, pos };
+}
+
 static LmString format_value(LmValue value) {
-    if (IS_INT(value)) return lm_int_to_string(UNBOX_INT(value));
-    if (IS_NIL(value)) return lm_string_from_cstr("nil");
-    if (IS_BOOL(value)) return lm_bool_to_string(UNBOX_BOOL(value) ? 1 : 0);
+    char scratch[LM_NUMBER_CHARS + 1];
+    size_t length;
+    if (lm_format_scalar(value, scratch, &length)) {
+        scratch[length] = 0;
+        return lm_string_from_cstr(scratch);
+    }
+    if (IS_FUNC(value)) {
+        char b[32];
+        snprintf(b, sizeof(b), "<fn #%u>", UNBOX_FUNC(value));
+        return lm_string_from_cstr(b);
+    }
     if (IS_PTR(value)) {
         ObjHeader* h = (ObjHeader*)UNBOX_PTR(value);
         switch (h->type_id) {
-            case TYPE_BOX: {
-                LmBox* box = (LmBox*)h;
-                switch (box->type) {
-                    case LM_BOX_INT: return lm_int_to_string(box->value.as_int);
-                    case LM_BOX_FLOAT: return lm_double_to_string(box->value.as_float);
-                    case LM_BOX_BOOL: return lm_bool_to_string(box->value.as_bool);
-                    case LM_BOX_STRING: return lm_string_from_cstr((char*)box->value.as_ptr);
-                    case LM_BOX_NULLPTR: return lm_string_from_cstr("nil");
-                }
-                break;
-            }
-            case TYPE_I64: return lm_int_to_string(((ObjI64*)h)->value);
-            case TYPE_U64: {
-                char b[64];
-                snprintf(b, sizeof(b), "%" PRIu64, ((ObjU64*)h)->value);
-                return lm_string_from_cstr(b);
-            }
-            case TYPE_I128: {
-                char* s = int128_to_str(((ObjI128*)h)->value);
-                LmString res = lm_string_from_cstr(s);
-                free(s);
-                return res;
+            case TYPE_STRING: {
+                ObjString* string = (ObjString*)h;
+                char* copy = (char*)malloc((size_t)string->length + 1);
+                if (!copy) return (LmString){ NULL, 0 };
+                memcpy(copy, string->data, (size_t)string->length + 1);
+                return (LmString){ copy, string->length };
             }
-            case TYPE_U128: {
-                char* s = uint128_to_str(((ObjU128*)h)->value);
-                LmString res = lm_string_from_cstr(s);
-                free(s);
-                return res;
-            }
-            case TYPE_FLOAT: return lm_double_to_string(((ObjFloat*)h)->value);
             case TYPE_LIST: return format_list((LmList*)h);
-            case TYPE_FRAME: return lm_string_from_cstr(((LmFrame*)h)->name);
+            case TYPE_DICT: return format_dict((LmDict*)h);
+            case TYPE_FRAME: return lm_string_from_cstr(((LmFrame*)h)->type->name);
             default: break;
         }
     }
@@ -296,8 +294,16 @@ RUNTIME_API LmString lm_value_to_string(LmValue value) {
     return format_value(value);
 }
 
-// Phase 12: Overflow-aware Arithmetic
-RUNTIME_API LmValue lm_add(LmValue a, LmValue b) {
+// Phase 12: Overflow-aware Arithmetic. The exported entry points take the
+// SMI fast path from runtime_value.h and only widen to 128 bits in the slow
+// paths below.
+RUNTIME_API LmValue lm_add(LmValue a, LmValue b) { return lm_add_inline(a, b); }
+RUNTIME_API LmValue lm_sub(LmValue a, LmValue b) { return lm_sub_inline(a, b); }
+RUNTIME_API LmValue lm_mul(LmValue a, LmValue b) { return lm_mul_inline(a, b); }
+RUNTIME_API LmValue lm_div(LmValue a, LmValue b) { return lm_div_inline(a, b); }
+RUNTIME_API LmValue lm_mod(LmValue a, LmValue b) { return lm_mod_inline(a, b); }
+
+RUNTIME_API LmValue lm_add_slow(LmValue a, LmValue b) {
     if (is_integer(a) && is_integer(b)) {
         __int128 i1 = as_i128(a);
         __int128 i2 = as_i128(b);
@@ -311,7 +317,7 @@ RUNTIME_API LmValue lm_add(LmValue a, LmValue b) {
     return VAL_NIL;
 }
 
-RUNTIME_API LmValue lm_sub(LmValue a, LmValue b) {
+RUNTIME_API LmValue lm_sub_slow(LmValue a, LmValue b) {
     if (is_integer(a) && is_integer(b)) {
         __int128 i1 = as_i128(a);
         __int128 i2 = as_i128(b);
@@ -325,7 +331,7 @@ RUNTIME_API LmValue lm_sub(LmValue a, LmValue b) {
     return VAL_NIL;
 }
 
-RUNTIME_API LmValue lm_mul(LmValue a, LmValue b) {
+RUNTIME_API LmValue lm_mul_slow(LmValue a, LmValue b) {
     if (is_integer(a) && is_integer(b)) {
         __int128 i1 = as_i128(a);
         __int128 i2 = as_i128(b);
@@ -339,7 +345,7 @@ RUNTIME_API LmValue lm_mul(LmValue a, LmValue b) {
     return VAL_NIL;
 }
 
-RUNTIME_API LmValue lm_div(LmValue a, LmValue b) {
+RUNTIME_API LmValue lm_div_slow(LmValue a, LmValue b) {
     if (is_integer(a) && is_integer(b)) {
         __int128 i1 = as_i128(a);
         __int128 i2 = as_i128(b);
@@ -353,3 +359,25 @@ RUNTIME_API LmValue lm_div(LmValue a, LmValue b) {
     }
     return VAL_NIL;
 }
+
+// Remainders truncate toward zero like C's %. The float case avoids libm so
+// compiled programs link without -lm; quotients beyond 2^63 are integral
+// doubles already and leave no remainder.
+RUNTIME_API LmValue lm_mod_slow(LmValue a, LmValue b) {
+    if (is_integer(a) && is_integer(b)) {
+        __int128 i1 = as_i128(a);
+        __int128 i2 = as_i128(b);
+        if (i2 == 0) return VAL_NIL;
+        if (i2 == -1) return make_i128(0);
+        return make_i128(i1 % i2);
+    }
+    if (is_numeric_internal(a) && is_numeric_internal(b)) {
+        double f1 = as_float(a);
+        double f2 = as_float(b);
+        if (f2 == 0.0) return VAL_NIL;
+        double q = f1 / f2;
+        if (q >= 9223372036854775808.0 || q <= -9223372036854775808.0) return make_float(0.0);
+        return make_float(f1 - (double)(int64_t)q * f2);
+    }
+    return VAL_NIL;
+}
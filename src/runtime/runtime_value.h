@@ -38,6 +38,79 @@ RUNTIME_API LmValue lm_add(LmValue a, LmValue b);
 RUNTIME_API LmValue lm_sub(LmValue a, LmValue b);
 RUNTIME_API LmValue lm_mul(LmValue a, LmValue b);
 RUNTIME_API LmValue lm_div(LmValue a, LmValue b);
+RUNTIME_API LmValue lm_mod(LmValue a, LmValue b);
+
+// Out-of-line paths for boxed, 128-bit and float operands
+RUNTIME_API LmValue lm_add_slow(LmValue a, LmValue b);
+RUNTIME_API LmValue lm_sub_slow(LmValue a, LmValue b);
+RUNTIME_API LmValue lm_mul_slow(LmValue a, LmValue b);
+RUNTIME_API LmValue lm_div_slow(LmValue a, LmValue b);
+RUNTIME_API LmValue lm_mod_slow(LmValue a, LmValue b);
+
+// SMI fast paths. They work on the tagged words: with x = (a << 3) | 1 and
+// y = (b << 3) | 1, x + (y - 1) is the boxed sum and a 64-bit overflow means
+// exactly that the result left the SMI range. They return false, leaving
+// *out untouched, when either operand is not an SMI or the result does not
+// fit one.
+static inline bool lm_smi_add(LmValue a, LmValue b, LmValue* out) {
+    int64_t r;
+    if (!IS_INT(a) || !IS_INT(b) || __builtin_add_overflow((int64_t)a, (int64_t)(b - 1), &r)) return false;
+    *out = (LmValue)r;
+    return true;
+}
+
+static inline bool lm_smi_sub(LmValue a, LmValue b, LmValue* out) {
+    int64_t r;
+    if (!IS_INT(a) || !IS_INT(b) || __builtin_sub_overflow((int64_t)a, (int64_t)(b - 1), &r)) return false;
+    *out = (LmValue)r;
+    return true;
+}
+
+static inline bool lm_smi_mul(LmValue a, LmValue b, LmValue* out) {
+    int64_t r;
+    if (!IS_INT(a) || !IS_INT(b) || __builtin_mul_overflow(UNBOX_INT(a), (int64_t)(b - 1), &r)) return false;
+    *out = (LmValue)r | TAG_INT;
+    return true;
+}
+
+static inline bool lm_smi_div(LmValue a, LmValue b, LmValue* out) {
+    if (!IS_INT(a) || !IS_INT(b) || b == BOX_INT(0) || (a == BOX_INT(MIN_SMI) && b == BOX_INT(-1))) return false;
+    *out = BOX_INT(UNBOX_INT(a) / UNBOX_INT(b));
+    return true;
+}
+
+static inline bool lm_smi_mod(LmValue a, LmValue b, LmValue* out) {
+    if (!IS_INT(a) || !IS_INT(b) || b == BOX_INT(0) || (a == BOX_INT(MIN_SMI) && b == BOX_INT(-1))) return false;
+    *out = BOX_INT(UNBOX_INT(a) % UNBOX_INT(b));
+    return true;
+}
+
+// Inline entry points: the SMI case costs a tag check and one checked
+// 64-bit operation, everything else calls the slow path
+static inline LmValue lm_add_inline(LmValue a, LmValue b) {
+    LmValue r;
+    return lm_smi_add(a, b, &r) ? r : lm_add_slow(a, b);
+}
+
+static inline LmValue lm_sub_inline(LmValue a, LmValue b) {
+    LmValue r;
+    return lm_smi_sub(a, b, &r) ? r : lm_sub_slow(a, b);
+}
+
+static inline LmValue lm_mul_inline(LmValue a, LmValue b) {
+    LmValue r;
+    return lm_smi_mul(a, b, &r) ? r : lm_mul_slow(a, b);
+}
+
+static inline LmValue lm_div_inline(LmValue a, LmValue b) {
+    LmValue r;
+    return lm_smi_div(a, b, &r) ? r : lm_div_slow(a, b);
+}
+
+static inline LmValue lm_mod_inline(LmValue a, LmValue b) {
+    LmValue r;
+    return lm_smi_mod(a, b, &r) ? r : lm_mod_slow(a, b);
+}
 
 // Unified equality comparison for any two tagged values
 RUNTIME_API int lm_value_eq(LmValue v1, LmValue v2);
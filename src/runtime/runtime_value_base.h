@@ -3,6 +3,7 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include <string.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -20,6 +21,7 @@ typedef uint64_t LmValue;
 #define TAG_PTR       0x0  // 000
 #define TAG_INT       0x1  // 001
 #define TAG_IMMEDIATE 0x2  // 010
+#define TAG_FLOAT     0x4  // 100
 #define TAG_MASK      0x7
 
 // Immediate values
@@ -27,12 +29,21 @@ typedef uint64_t LmValue;
 #define VAL_FALSE     ((LmValue)(1 << 3) | TAG_IMMEDIATE)
 #define VAL_TRUE      ((LmValue)(2 << 3) | TAG_IMMEDIATE)
 
+// Function handles are immediates carrying a dense function-table index
+#define IMM_FUNC      0x40
+#define BOX_FUNC(i)   ((LmValue)(((uint64_t)(i)) << 8) | IMM_FUNC | TAG_IMMEDIATE)
+#define UNBOX_FUNC(v) ((uint32_t)((v) >> 8))
+#define IS_FUNC(v)    (((v) & 0xFF) == (IMM_FUNC | TAG_IMMEDIATE))
+
 // Header for all heap-allocated objects
 typedef struct {
     uint32_t type_id;
     uint32_t metadata;  // Length, GC marks, flags, etc.
 } ObjHeader;
 
+// metadata flag for literals shared through a constant pool: never mutated or freed
+#define OBJ_IMMUTABLE 0x80000000u
+
 #define TYPE_BOX      0
 #define TYPE_LIST     1
 #define TYPE_DICT     2
@@ -46,6 +57,7 @@ typedef struct {
 #define TYPE_DECIMAL  10
 #define TYPE_STRING   11
 #define TYPE_CLOSURE  12
+#define TYPE_CHANNEL  13  // Owned by the VM, never collected
 
 // SMI (Small Integer) Constants - 61-bit signed
 #define MAX_SMI ((int64_t)((1ULL << 60) - 1))
@@ -68,6 +80,42 @@ static inline bool fits_smi_u64(uint64_t v) {
 #define UNBOX_PTR(v) ((void*)((uintptr_t)(v) & ~TAG_MASK))
 #define IS_PTR(v)    (((v) & TAG_MASK) == TAG_PTR && (v) != 0)
 
+// Immediate doubles. A double whose exponent starts with 0111 or 1000
+// (magnitude in [2^-127, 2^129)) keeps its sign and its low 60 bits above the
+// tag; the dropped exponent bits follow from bit 59. +0.0 takes the encoding
+// of 2^-127, which is boxed instead. Every other double (-0.0, subnormals,
+// huge values, inf, NaN) is an ObjFloat on the heap.
+#define FLOAT_SIGN_BIT  0x8000000000000000ULL
+#define FLOAT_LOW_BITS  0x0FFFFFFFFFFFFFFFULL
+#define FLOAT_ZERO_BITS 0x3800000000000000ULL
+#define VAL_FLOAT_ZERO  ((LmValue)((FLOAT_ZERO_BITS & FLOAT_LOW_BITS) << 3) | TAG_FLOAT)
+#define IS_FLOAT_IMM(v) (((v) & TAG_MASK) == TAG_FLOAT)
+
+static inline bool try_box_float(double d, LmValue* out) {
+    uint64_t bits;
+    memcpy(&bits, &d, sizeof(bits));
+    uint64_t exponent_top = (bits >> 59) & 0xF;
+    if ((exponent_top == 0x7 || exponent_top == 0x8) && bits != FLOAT_ZERO_BITS) {
+        *out = (bits & FLOAT_SIGN_BIT) | ((bits & FLOAT_LOW_BITS) << 3) | TAG_FLOAT;
+        return true;
+    }
+    if (bits == 0) {
+        *out = VAL_FLOAT_ZERO;
+        return true;
+    }
+    return false;
+}
+
+static inline double UNBOX_FLOAT(LmValue v) {
+    if (v == VAL_FLOAT_ZERO) return 0.0;
+    uint64_t low = (v >> 3) & FLOAT_LOW_BITS;
+    uint64_t high = (low >> 59) ? 0x3000000000000000ULL : 0x4000000000000000ULL;
+    uint64_t bits = (v & FLOAT_SIGN_BIT) | high | low;
+    double d;
+    memcpy(&d, &bits, sizeof(d));
+    return d;
+}
+
 #define IS_NIL(v)    ((v) == VAL_NIL)
 #define IS_BOOL(v)   (((v) == VAL_FALSE) || ((v) == VAL_TRUE))
 #define UNBOX_BOOL(v) ((v) == VAL_TRUE)
@@ -27,22 +27,103 @@ run_test() {
   rm -f "$tmp"
 }
 
+# Halt tests end in a fatal runtime error; they pass when limitly exits 1
+# with the expected message and prints nothing after it
+run_halt_test() {
+  local f="$1" expected="$2"
+  ((TOTAL+=1))
+  echo "Running $f..."
+  local tmp status=0
+  tmp=$(mktemp)
+  "$LIMITLY" "$f" >"$tmp" 2>&1 || status=$?
+  if [[ $status -ne 1 ]]; then
+    echo "  FAIL: $f (exit status $status, expected 1)"
+    ((FAILED+=1))
+  elif ! grep -q "$expected" "$tmp"; then
+    echo "  FAIL: $f (missing \"$expected\")"
+    ((FAILED+=1))
+  elif grep -q "after" "$tmp"; then
+    echo "  FAIL: $f (kept running after the error)"
+    ((FAILED+=1))
+  else
+    echo "  PASS: $f"
+    ((PASSED+=1))
+  fi
+  rm -f "$tmp"
+}
+
+# Region tests pass when the collector statistics report every region
+# object as released
+run_region_test() {
+  local f="$1" expected="$2"
+  ((TOTAL+=1))
+  echo "Running $f..."
+  local tmp
+  tmp=$(mktemp)
+  "$LIMITLY" run -gc-stats "$f" >"$tmp" 2>&1 || true
+  if grep -qE "error\[E|Error:|RuntimeError|❌ FAIL|Assertion.*failed" "$tmp"; then
+    echo "  FAIL: $f"
+    ((FAILED+=1))
+  elif ! grep -q "regions: $expected objects released" "$tmp"; then
+    echo "  FAIL: $f ($(grep "regions:" "$tmp" || echo "no statistics"), expected $expected)"
+    ((FAILED+=1))
+  else
+    echo "  PASS: $f"
+    ((PASSED+=1))
+  fi
+  rm -f "$tmp"
+}
+
+# Runtime tests are C programs linked against the built runtime library;
+# they fail by exiting non-zero
+RUNTIME_LIB="build/obj/release/limitly_runtime.a"
+
+run_c_test() {
+  local f="$1"
+  ((TOTAL+=1))
+  echo "Running $f..."
+  local exe
+  exe=$(mktemp)
+  if ! cc -std=gnu99 -O1 -Isrc/runtime "$f" "$RUNTIME_LIB" -lpthread -o "$exe"; then
+    echo "  FAIL: $f (does not compile)"
+    ((FAILED+=1))
+  elif ! "$exe"; then
+    echo "  FAIL: $f"
+    ((FAILED+=1))
+  else
+    echo "  PASS: $f"
+    ((PASSED+=1))
+  fi
+  rm -f "$exe"
+}
+
 echo "Building compiler..."
 make -j4
 
 TESTS=(
 "tests/basic/variables.lm"
 "tests/basic/literals.lm"
+"tests/basic/literal_pool.lm"
+"tests/basic/decimal_arithmetic.lm"
 "tests/basic/control_flow.lm"
 "tests/basic/print_statements.lm"
 "tests/basic/list_dict_tuple.lm"
+"tests/basic/iteration.lm"
+"tests/basic/typed_lists.lm"
+"tests/basic/list_kernels.lm"
 "tests/expressions/arithmetic.lm"
 "tests/expressions/logical.lm"
 "tests/expressions/ranges.lm"
 "tests/expressions/scientific_notation.lm"
 "tests/expressions/large_literals.lm"
+"tests/expressions/smi_overflow.lm"
+"tests/expressions/float_immediates.lm"
+"tests/expressions/number_formatting.lm"
 "tests/strings/interpolation.lm"
 "tests/strings/operations.lm"
+"tests/strings/interning.lm"
+"tests/strings/building.lm"
+"tests/strings/equality.lm"
 "tests/loops/for_loops.lm"
 "tests/loops/iter_loops.lm"
 "tests/loops/while_loops.lm"
@@ -52,6 +133,8 @@ TESTS=(
 "tests/functions/advanced.lm"
 "tests/functions/closures.lm"
 "tests/functions/first_class.lm"
+"tests/functions/dynamic_types.lm"
+"tests/functions/deep_recursion.lm"
 "tests/types/basic.lm"
 "tests/types/unions.lm"
 "tests/types/options.lm"
@@ -67,18 +150,36 @@ TESTS=(
 "tests/modules/function_params_test.lm"
 "tests/modules/alias_import_test.lm"
 "tests/modules/multiple_imports_test.lm"
+"tests/modules/global_slots_test.lm"
 "tests/oop/frame_declaration.lm"
+"tests/oop/frame_layout.lm"
 "tests/oop/traits_dynamic.lm"
 "tests/oop/traits_inheritance.lm"
 "tests/oop/visibility_test.lm"
 "tests/oop/composition_test.lm"
+"tests/memory/gc_collection.lm"
+"tests/memory/region_allocation.lm"
+"tests/memory/tuple_scalars.lm"
 "tests/concurrency/parallel_blocks.lm"
 "tests/concurrency/concurrent_blocks.lm"
 )
 
+C_TESTS=(
+"tests/runtime/alloc_classes.c"
+"tests/runtime/dict_table.c"
+"tests/runtime/gc_marking.c"
+)
+
 for t in "${TESTS[@]}"; do
   run_test "$t"
 done
 
+run_halt_test "tests/functions/stack_overflow.lm" "Call stack overflow"
+run_region_test "tests/memory/region_exits.lm" 28
+
+for t in "${C_TESTS[@]}"; do
+  run_c_test "$t"
+done
+
 echo "PASSED=$PASSED FAILED=$FAILED TOTAL=$TOTAL"
 if [[ $FAILED -gt 0 ]]; then exit 1; fi
@@ -0,0 +1,135 @@
+// tests/runtime/alloc_classes.c
+// Size-class allocator: every class hands out distinct 16-byte aligned
+// blocks across batches and pages, reuses freed ones, accepts blocks freed
+// from another thread, and lm_gc_alloc falls back to malloc past the
+// largest class. Run by tests/run_tests.sh against the built runtime.
+
+#include "runtime_alloc.h"
+#include "runtime_gc.h"
+#include "runtime_tuple.h"
+#include "runtime_value.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+// More than a page of the largest class, so batches and pages are crossed
+#define BLOCKS_PER_CLASS 1024
+
+static int failures = 0;
+
+#define CHECK(condition, message)                                         \
+    do {                                                                  \
+        if (!(condition)) {                                               \
+            printf("Assertion failed: %s (line %d)\n", message, __LINE__); \
+            failures++;                                                   \
+        }                                                                 \
+    } while (0)
+
+static void* blocks[BLOCKS_PER_CLASS];
+
+static int compare_blocks(const void* a, const void* b) {
+    uintptr_t x = (uintptr_t)*(void* const*)a, y = (uintptr_t)*(void* const*)b;
+    return (x > y) - (x < y);
+}
+
+static void test_class_mapping(void) {
+    for (size_t size = 1; size <= LM_MAX_CLASS_SIZE; size++) {
+        LmSizeClass size_class = lm_size_class(size);
+        CHECK(size_class < LM_SIZE_CLASS_COUNT, "sizes up to the largest class map to a class");
+        CHECK(lm_class_size(size_class) >= size, "the class fits the size");
+        CHECK(size_class == LM_CLASS_16 || lm_class_size(size_class - 1) < size, "the class is the smallest that fits");
+    }
+    CHECK(lm_size_class(LM_MAX_CLASS_SIZE + 1) == LM_SIZE_CLASS_COUNT, "larger sizes have no class");
+}
+
+static void test_class_blocks(LmSizeClass size_class) {
+    size_t size = lm_class_size(size_class);
+    for (size_t i = 0; i < BLOCKS_PER_CLASS; i++) {
+        blocks[i] = lm_alloc(size_class);
+        CHECK(blocks[i] != NULL, "lm_alloc returns a block");
+        CHECK(((uintptr_t)blocks[i] & 15) == 0, "blocks are 16-byte aligned");
+        memset(blocks[i], (int)(i & 0xFF), size);
+    }
+
+    // Overlapping blocks would have overwritten each other's pattern
+    for (size_t i = 0; i < BLOCKS_PER_CLASS; i++) {
+        const unsigned char* bytes = (const unsigned char*)blocks[i];
+        CHECK(bytes[0] == (i & 0xFF) && bytes[size - 1] == (i & 0xFF), "blocks do not overlap");
+    }
+
+    for (size_t i = 0; i < BLOCKS_PER_CLASS; i++) lm_free(blocks[i], size_class);
+
+    // Nothing else uses the class, so the freed blocks are all handed out again
+    void* freed[BLOCKS_PER_CLASS];
+    memcpy(freed, blocks, sizeof(freed));
+    qsort(freed, BLOCKS_PER_CLASS, sizeof(void*), compare_blocks);
+    for (size_t i = 0; i < BLOCKS_PER_CLASS; i++) {
+        blocks[i] = lm_alloc(size_class);
+        CHECK(bsearch(&blocks[i], freed, BLOCKS_PER_CLASS, sizeof(void*), compare_blocks) != NULL,
+              "freed blocks are reused");
+    }
+    for (size_t i = 0; i < BLOCKS_PER_CLASS; i++) lm_free(blocks[i], size_class);
+}
+
+static void* free_blocks(void* size_class) {
+    for (size_t i = 0; i < BLOCKS_PER_CLASS; i++) lm_free(blocks[i], (LmSizeClass)(uintptr_t)size_class);
+    return NULL;
+}
+
+static void test_cross_thread_free(void) {
+    for (size_t i = 0; i < BLOCKS_PER_CLASS; i++) blocks[i] = lm_alloc(LM_CLASS_48);
+
+    // The thread's cache goes back to the central pool when it exits
+    pthread_t thread;
+    CHECK(pthread_create(&thread, NULL, free_blocks, (void*)(uintptr_t)LM_CLASS_48) == 0, "thread starts");
+    pthread_join(thread, NULL);
+
+    for (size_t i = 0; i < BLOCKS_PER_CLASS; i++) {
+        blocks[i] = lm_alloc(LM_CLASS_48);
+        CHECK(blocks[i] != NULL, "blocks freed by another thread can be allocated again");
+    }
+    for (size_t i = 0; i < BLOCKS_PER_CLASS; i++) lm_free(blocks[i], LM_CLASS_48);
+}
+
+// Tuples of growing size walk lm_gc_alloc through every class and into the
+// malloc fallback. Freeing them gives their bytes back to the heap.
+static void test_gc_alloc_sizes(void) {
+    static int host;
+    CHECK(lm_gc_enable(NULL, NULL, &host), "collector enables");
+
+    enum { TUPLES = 64 };
+    LmTuple* tuples[TUPLES];
+    for (uint64_t n = 0; n < TUPLES; n++) {
+        tuples[n] = lm_tuple_new(n);
+        CHECK(tuples[n] != NULL, "lm_tuple_new returns a tuple");
+        CHECK(((uintptr_t)tuples[n] & 15) == 0, "objects are 16-byte aligned");
+        for (uint64_t i = 0; i < n; i++) lm_tuple_set(tuples[n], i, make_i64((int64_t)(n * 100 + i)));
+    }
+    CHECK(sizeof(LmTuple) + (TUPLES - 1) * sizeof(LmValue) > LM_MAX_CLASS_SIZE, "the largest tuple needs malloc");
+
+    for (uint64_t n = 0; n < TUPLES; n++) {
+        for (uint64_t i = 0; i < n; i++) {
+            CHECK(as_i64(lm_tuple_get(tuples[n], i)) == (int64_t)(n * 100 + i), "elements survive other allocations");
+        }
+    }
+    CHECK(lm_gc_stats().heap_bytes > 0, "allocations are charged to the heap");
+
+    for (uint64_t n = 0; n < TUPLES; n++) lm_tuple_free(tuples[n]);
+    CHECK(lm_gc_stats().heap_bytes == 0, "explicit frees are taken off the heap");
+    lm_gc_disable(&host);
+}
+
+int main(void) {
+    test_class_mapping();
+    for (int size_class = 0; size_class < LM_SIZE_CLASS_COUNT; size_class++) {
+        test_class_blocks((LmSizeClass)size_class);
+    }
+    test_cross_thread_free();
+    test_gc_alloc_sizes();
+
+    if (failures) return 1;
+    printf("Allocator size class test passed\n");
+    return 0;
+}
@@ -0,0 +1,117 @@
+// tests/runtime/dict_table.c
+// Open-addressing dict: growth through several resizes, removal with and
+// without tombstones, in-place rehashing under insert/remove churn, and
+// keys that share a hash. Run by tests/run_tests.sh against the built
+// runtime.
+
+#include "runtime_dict.h"
+#include "runtime_value.h"
+#include <stdio.h>
+#include <stdint.h>
+
+#define KEYS 20000
+
+static int failures = 0;
+
+#define CHECK(condition, message)                                         \
+    do {                                                                  \
+        if (!(condition)) {                                               \
+            printf("Assertion failed: %s (line %d)\n", message, __LINE__); \
+            failures++;                                                   \
+        }                                                                 \
+    } while (0)
+
+// Eight distinct hashes for every key, so probe sequences are shared and
+// lookups have to compare keys
+static uint64_t colliding_hash(LmValue key) {
+    return (uint64_t)as_i64(key) & 7;
+}
+
+static bool has(LmDict* dict, int64_t key, int64_t value) {
+    return lm_dict_contains(dict, make_i64(key)) && as_i64(lm_dict_get(dict, make_i64(key))) == value;
+}
+
+static void test_growth(uint64_t (*hash)(LmValue), int64_t keys) {
+    LmDict* dict = lm_dict_new(hash, lm_cmp_int);
+    uint64_t resizes = 0, capacity = 0;
+    for (int64_t i = 0; i < keys; i++) {
+        lm_dict_set(dict, make_i64(i), make_i64(i * 3));
+        if (dict->capacity != capacity) {
+            resizes++;
+            capacity = dict->capacity;
+        }
+        CHECK(dict->size <= dict->capacity - dict->capacity / 8, "the table stays within 7/8 load");
+    }
+    CHECK(resizes >= 5, "inserts cross several resizes");
+    CHECK(dict->size == (uint64_t)keys, "every key is counted once");
+
+    int missing = 0;
+    for (int64_t i = 0; i < keys; i++) missing += !has(dict, i, i * 3);
+    CHECK(missing == 0, "every key survives the resizes");
+    CHECK(!lm_dict_contains(dict, make_i64(keys)), "absent keys are not found");
+
+    // Overwriting keeps the size
+    for (int64_t i = 0; i < keys; i += 7) lm_dict_set(dict, make_i64(i), make_i64(-i));
+    CHECK(dict->size == (uint64_t)keys, "updates do not add entries");
+    CHECK(has(dict, 14, -14), "updates replace the value");
+    lm_dict_free(dict);
+}
+
+static void test_remove_reinsert(uint64_t (*hash)(LmValue), int64_t keys) {
+    LmDict* dict = lm_dict_new(hash, lm_cmp_int);
+    for (int64_t i = 0; i < keys; i++) lm_dict_set(dict, make_i64(i), make_i64(i));
+
+    // Removing every other key leaves both tombstones and emptied slots behind
+    for (int64_t i = 0; i < keys; i += 2) CHECK(lm_dict_remove(dict, make_i64(i)), "present keys are removed");
+    CHECK(!lm_dict_remove(dict, make_i64(0)), "removed keys are gone");
+    CHECK(dict->size == (uint64_t)(keys / 2), "removes are counted");
+
+    int wrong = 0;
+    for (int64_t i = 0; i < keys; i++) wrong += (i % 2 == 0) ? lm_dict_contains(dict, make_i64(i)) : !has(dict, i, i);
+    CHECK(wrong == 0, "keys probing past removed slots are still found");
+
+    for (int64_t i = 0; i < keys; i += 2) lm_dict_set(dict, make_i64(i), make_i64(i + 1));
+    CHECK(dict->size == (uint64_t)keys, "removed keys are inserted again");
+    wrong = 0;
+    for (int64_t i = 0; i < keys; i++) wrong += !has(dict, i, (i % 2 == 0) ? i + 1 : i);
+    CHECK(wrong == 0, "reinserted and untouched keys are found");
+
+    for (int64_t i = 0; i < keys; i++) lm_dict_remove(dict, make_i64(i));
+    CHECK(dict->size == 0, "the dict empties");
+    CHECK(!lm_dict_contains(dict, make_i64(1)), "an emptied dict finds nothing");
+    lm_dict_free(dict);
+}
+
+// A sliding window of live keys: deleted slots have to be reclaimed by
+// rehashing in place, or the table would keep growing
+static void test_churn(void) {
+    LmDict* dict = lm_dict_new(lm_hash_int, lm_cmp_int);
+    const int64_t window = 1000;
+    for (int64_t i = 0; i < window; i++) lm_dict_set(dict, make_i64(i), make_i64(i));
+    uint64_t capacity = dict->capacity;
+
+    for (int64_t i = window; i < 50 * window; i++) {
+        lm_dict_set(dict, make_i64(i), make_i64(i));
+        lm_dict_remove(dict, make_i64(i - window));
+    }
+    CHECK(dict->size == (uint64_t)window, "the window keeps its size");
+    CHECK(dict->capacity <= capacity * 2, "churn does not grow the table");
+
+    int missing = 0;
+    for (int64_t i = 49 * window; i < 50 * window; i++) missing += !has(dict, i, i);
+    CHECK(missing == 0, "the live window is intact");
+    CHECK(!lm_dict_contains(dict, make_i64(49 * window - 1)), "keys that left the window are gone");
+    lm_dict_free(dict);
+}
+
+int main(void) {
+    test_growth(lm_hash_int, KEYS);
+    test_growth(colliding_hash, KEYS / 10);
+    test_remove_reinsert(lm_hash_int, KEYS);
+    test_remove_reinsert(colliding_hash, KEYS / 10);
+    test_churn();
+
+    if (failures) return 1;
+    printf("Dict table test passed\n");
+    return 0;
+}